@@ -1,5 +1,6 @@
 #include <map>
 
+#include "checkpoint.h"
 #include "msl/fwcounter.h"
 #include "ooo_cpu.h"
 
@@ -12,7 +13,7 @@ constexpr std::size_t COUNTER_BITS = 2;
 std::map<O3_CPU*, std::array<champsim::msl::fwcounter<COUNTER_BITS>, BIMODAL_TABLE_SIZE>> bimodal_table;
 } // namespace
 
-void O3_CPU::initialize_branch_predictor() {}
+void O3_CPU::initialize_branch_predictor() { ::bimodal_table[this] = {}; }
 
 uint8_t O3_CPU::predict_branch(uint64_t ip)
 {
@@ -27,3 +28,7 @@ void O3_CPU::last_branch_result(uint64_t ip, uint64_t branch_target, uint8_t tak
   auto hash = ip % ::BIMODAL_PRIME;
   ::bimodal_table[this][hash] += taken ? 1 : -1;
 }
+
+void O3_CPU::branch_predictor_save_state(std::ostream& os) { champsim::checkpoint::write(os, ::bimodal_table[this]); }
+
+void O3_CPU::branch_predictor_restore_state(std::istream& is) { champsim::checkpoint::read(is, ::bimodal_table[this]); }
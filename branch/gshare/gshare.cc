@@ -3,6 +3,7 @@
 #include <bitset>
 #include <map>
 
+#include "checkpoint.h"
 #include "msl/fwcounter.h"
 #include "ooo_cpu.h"
 
@@ -26,7 +27,11 @@ std::size_t gs_table_hash(uint64_t ip, std::bitset<GLOBAL_HISTORY_LENGTH> bh_vec
 }
 } // namespace
 
-void O3_CPU::initialize_branch_predictor() {}
+void O3_CPU::initialize_branch_predictor()
+{
+  ::branch_history_vector[this] = {};
+  ::gs_history_table[this] = {};
+}
 
 uint8_t O3_CPU::predict_branch(uint64_t ip)
 {
@@ -44,3 +49,15 @@ void O3_CPU::last_branch_result(uint64_t ip, uint64_t branch_target, uint8_t tak
   ::branch_history_vector[this] <<= 1;
   ::branch_history_vector[this][0] = taken;
 }
+
+void O3_CPU::branch_predictor_save_state(std::ostream& os)
+{
+  champsim::checkpoint::write(os, ::branch_history_vector[this]);
+  champsim::checkpoint::write(os, ::gs_history_table[this]);
+}
+
+void O3_CPU::branch_predictor_restore_state(std::istream& is)
+{
+  champsim::checkpoint::read(is, ::branch_history_vector[this]);
+  champsim::checkpoint::read(is, ::gs_history_table[this]);
+}
@@ -109,7 +109,13 @@ std::map<O3_CPU*, std::bitset<PERCEPTRON_HISTORY>> global_history;      // real
                                                                         // updated
 } // namespace
 
-void O3_CPU::initialize_branch_predictor() {}
+void O3_CPU::initialize_branch_predictor()
+{
+  ::perceptrons[this] = {};
+  ::perceptron_state_buf[this] = {};
+  ::spec_global_history[this] = {};
+  ::global_history[this] = {};
+}
 
 uint8_t O3_CPU::predict_branch(uint64_t ip)
 {
@@ -1,4 +1,3 @@
-// WARNING!: single-core only.
 #include <assert.h>
 #include <inttypes.h>
 #include <math.h>
@@ -7,12 +6,21 @@
 #include <string.h>
 using namespace std;
 
+#include "checkpoint.h"
 #include "ooo_cpu.h"
 
 #define BORNTICK 1024
 // To get the predictor storage budget on stderr  uncomment the next line
 // #define PRINTSIZE
+#include <algorithm>
+#include <map>
+#include <memory>
 #include <vector>
+
+namespace
+{
+// The state of one predictor. Every member is zero unless it is initialized here or in reinit().
+struct tage_sc_l_state {
 long long IMLIcount; // use to monitor the iteration number
 
 #define SC   // 8.2 % if TAGE alone
@@ -129,6 +137,7 @@ long long T_slhist[NTLOCAL];
 #endif
 #define LOGSIZEUPS (LOGSIZEUP / 2)
 int updatethreshold;
+int THRES;
 int Pupdatethreshold[(1 << LOGSIZEUP)]; // size is fixed by LOGSIZEUP
 #define INDUPD (PC ^ (PC >> 2)) & ((1 << LOGSIZEUP) - 1)
 #define INDUPDS ((PC ^ (PC >> 2)) & ((1 << (LOGSIZEUPS)) - 1))
@@ -164,7 +173,7 @@ public:
   int OLENGTH;
   int OUTPOINT;
 
-  folded_history() {}
+  folded_history() = default;
 
   void init(int original_length, int compressed_length)
   {
@@ -408,13 +417,13 @@ int predictorsize()
 
   return (STORAGESIZE);
 }
+};
 
-class PREDICTOR
+// The tables of the statistical corrector are referred to by pointers into the predictor itself, so it cannot be copied
+class PREDICTOR : tage_sc_l_state
 {
 public:
-  int THRES;
-
-  PREDICTOR(void)
+  PREDICTOR(void) : tage_sc_l_state{}
   {
     reinit();
 #ifdef PRINTSIZE
@@ -422,6 +431,60 @@ public:
 #endif
   }
 
+  PREDICTOR(const PREDICTOR&) = delete;
+  PREDICTOR& operator=(const PREDICTOR&) = delete;
+
+  ~PREDICTOR()
+  {
+    delete[] btable;
+    delete[] gtable[1];
+    delete[] gtable[BORN];
+#ifdef LOOPPREDICTOR
+    delete[] ltable;
+#endif
+  }
+
+  // The state is written whole, followed by the tables it points to. A table shared by several banks is written once.
+  void save(std::ostream& os) const
+  {
+    champsim::checkpoint::write(os, static_cast<const tage_sc_l_state&>(*this));
+    champsim::checkpoint::write_array(os, btable, std::size_t{1} << LOGB);
+    champsim::checkpoint::write_array(os, gtable[1], static_cast<std::size_t>(SizeTable[1]));
+    champsim::checkpoint::write_array(os, gtable[BORN], static_cast<std::size_t>(SizeTable[BORN]));
+#ifdef LOOPPREDICTOR
+    champsim::checkpoint::write_array(os, ltable, std::size_t{1} << LOGL);
+#endif
+  }
+
+  // The saved pointers refer to the tables of the predictor that was saved, so those of this one are kept
+  void restore(std::istream& is)
+  {
+    auto kept = std::make_unique<tage_sc_l_state>(static_cast<const tage_sc_l_state&>(*this));
+    champsim::checkpoint::read(is, static_cast<tage_sc_l_state&>(*this));
+
+    btable = kept->btable;
+    std::copy(std::begin(kept->gtable), std::end(kept->gtable), std::begin(gtable));
+#ifdef LOOPPREDICTOR
+    ltable = kept->ltable;
+#endif
+#ifdef IMLI
+    std::copy(std::begin(kept->IGEHL), std::end(kept->IGEHL), std::begin(IGEHL));
+    std::copy(std::begin(kept->IMGEHL), std::end(kept->IMGEHL), std::begin(IMGEHL));
+#endif
+    std::copy(std::begin(kept->GGEHL), std::end(kept->GGEHL), std::begin(GGEHL));
+    std::copy(std::begin(kept->PGEHL), std::end(kept->PGEHL), std::begin(PGEHL));
+    std::copy(std::begin(kept->LGEHL), std::end(kept->LGEHL), std::begin(LGEHL));
+    std::copy(std::begin(kept->SGEHL), std::end(kept->SGEHL), std::begin(SGEHL));
+    std::copy(std::begin(kept->TGEHL), std::end(kept->TGEHL), std::begin(TGEHL));
+
+    champsim::checkpoint::read_array(is, btable, std::size_t{1} << LOGB);
+    champsim::checkpoint::read_array(is, gtable[1], static_cast<std::size_t>(SizeTable[1]));
+    champsim::checkpoint::read_array(is, gtable[BORN], static_cast<std::size_t>(SizeTable[BORN]));
+#ifdef LOOPPREDICTOR
+    champsim::checkpoint::read_array(is, ltable, std::size_t{1} << LOGL);
+#endif
+  }
+
   void reinit()
   {
     m[1] = MINHIST;
@@ -1395,11 +1458,21 @@ public:
     }
   }
 #endif
-} predictor;
+};
+
+struct tage_sc_l {
+  PREDICTOR predictor;
+  bool was_predicted_taken = false;
+};
 
-void O3_CPU::initialize_branch_predictor() {}
+std::map<O3_CPU*, tage_sc_l> predictors;
+} // namespace
 
-bool was_predicted_taken;
+void O3_CPU::initialize_branch_predictor()
+{
+  ::predictors.erase(this);
+  ::predictors.try_emplace(this);
+}
 
 uint8_t O3_CPU::predict_branch(uint64_t ip)
 {
@@ -1422,14 +1495,30 @@ uint8_t O3_CPU::predict_branch(uint64_t ip)
   // } else {
   //     return was_predicted_taken = true;
   // }
+  auto& [predictor, was_predicted_taken] = ::predictors.at(this);
   return was_predicted_taken = predictor.GetPrediction(ip);
 }
 
 void O3_CPU::last_branch_result(uint64_t ip, uint64_t branch_target, uint8_t taken, uint8_t branch_type)
 {
+  auto& [predictor, was_predicted_taken] = ::predictors.at(this);
   if (branch_type == BRANCH_CONDITIONAL) {
     predictor.UpdatePredictor(ip, branch_type, taken, was_predicted_taken, branch_target);
   } else {
     predictor.TrackOtherInst(ip, branch_type, taken, branch_target);
   }
 }
+
+void O3_CPU::branch_predictor_save_state(std::ostream& os)
+{
+  auto& [predictor, was_predicted_taken] = ::predictors.at(this);
+  predictor.save(os);
+  champsim::checkpoint::write(os, was_predicted_taken);
+}
+
+void O3_CPU::branch_predictor_restore_state(std::istream& is)
+{
+  auto& [predictor, was_predicted_taken] = ::predictors.at(this);
+  predictor.restore(is);
+  champsim::checkpoint::read(is, was_predicted_taken);
+}
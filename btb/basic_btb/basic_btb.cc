@@ -11,6 +11,7 @@
 #include <deque>
 #include <map>
 
+#include "checkpoint.h"
 #include "msl/lru_table.h"
 #include "ooo_cpu.h"
 
@@ -55,6 +56,7 @@ void O3_CPU::initialize_btb()
   std::fill(std::begin(::INDIRECT_BTB[this]), std::end(::INDIRECT_BTB[this]), 0);
   std::fill(std::begin(::CALL_SIZE[this]), std::end(::CALL_SIZE[this]), 4);
   ::CONDITIONAL_HISTORY[this] = 0;
+  ::RAS[this].clear();
 }
 
 std::pair<uint64_t, uint8_t> O3_CPU::btb_prediction(uint64_t ip)
@@ -136,3 +138,23 @@ void O3_CPU::update_btb(uint64_t ip, uint64_t branch_target, uint8_t taken, uint
     ::BTB.at(this).fill(opt_entry.value_or(::btb_entry_t{ip, branch_target, type}));
   }
 }
+
+void O3_CPU::btb_save_state(std::ostream& os)
+{
+  ::BTB.at(this).save(os);
+  champsim::checkpoint::write(os, ::INDIRECT_BTB[this]);
+  champsim::checkpoint::write(os, ::CONDITIONAL_HISTORY[this]);
+  champsim::checkpoint::write(os, std::vector<uint64_t>{std::begin(::RAS[this]), std::end(::RAS[this])});
+  champsim::checkpoint::write(os, ::CALL_SIZE[this]);
+}
+
+void O3_CPU::btb_restore_state(std::istream& is)
+{
+  ::BTB.at(this).restore(is);
+  champsim::checkpoint::read(is, ::INDIRECT_BTB[this]);
+  champsim::checkpoint::read(is, ::CONDITIONAL_HISTORY[this]);
+  std::vector<uint64_t> ras;
+  champsim::checkpoint::read(is, ras);
+  ::RAS[this].assign(std::begin(ras), std::end(ras));
+  champsim::checkpoint::read(is, ::CALL_SIZE[this]);
+}
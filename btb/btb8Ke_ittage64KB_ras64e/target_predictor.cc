@@ -3,39 +3,48 @@
  */
 
 #include <iostream>
+#include <map>
+#include <memory>
 
+#include "checkpoint.h"
 #include "ooo_cpu.h"
 #include "../common/basic_btb.h"
 #include "../common/ittage_64KB.h"
 #include "../common/ras.h"
 
 namespace {
-  BasicBTB<1024, 8> btb[NUM_CPUS];
-  my_predictor *ittage[NUM_CPUS];
-  RAS<64, 4096> ras[NUM_CPUS];
+  struct target_predictor {
+    BasicBTB<1024, 8> btb;
+    std::unique_ptr<my_predictor> ittage;
+    RAS<64, 4096> ras;
+  };
+
+  std::map<O3_CPU*, target_predictor> predictors;
 }
 
 void O3_CPU::initialize_btb()
 {
+  auto& [btb, ittage, ras] = ::predictors[this];
   std::cout << "BTB:" << std::endl;
-  ::btb[cpu].initialize();
+  btb.initialize();
   std::cout << "Indirect:" << std::endl;
-  ::ittage[cpu] = new my_predictor();
+  ittage = std::make_unique<my_predictor>();
   std::cout << "RAS:" << std::endl;
-  ::ras[cpu].initialize();
+  ras.initialize();
 }
 
 std::pair<uint64_t, uint8_t> O3_CPU::btb_prediction(uint64_t ip)
 {
-  auto btb_pred = ::btb[cpu].predict(ip);
+  auto& [btb, ittage, ras] = ::predictors.at(this);
+  auto btb_pred = btb.predict(ip);
   if (btb_pred.first == 0) {
     // no prediction for this IP
     return std::make_pair(0, false);
   }  
   if (btb_pred.second == BRANCH_INFO_INDIRECT) {
-    return std::make_pair(::ittage[cpu]->predict_brindirect(ip), true);
+    return std::make_pair(ittage->predict_brindirect(ip), true);
   } else if (btb_pred.second == BRANCH_INFO_RETURN) {
-    return std::make_pair(::ras[cpu].predict(), true);
+    return std::make_pair(ras.predict(), true);
   } else {
     return std::make_pair(btb_pred.first, btb_pred.second != BRANCH_INFO_CONDITIONAL);
   }
@@ -43,8 +52,25 @@ std::pair<uint64_t, uint8_t> O3_CPU::btb_prediction(uint64_t ip)
 
 void O3_CPU::update_btb(uint64_t ip, uint64_t branch_target, uint8_t taken, uint8_t branch_type)
 {
-  ::ittage[cpu]->update_brindirect(ip, branch_type, taken, branch_target);
-  ::ittage[cpu]->fetch_history_update(ip, branch_type, taken, branch_target);
-  ::ras[cpu].update(ip, branch_target, taken, branch_type);
-  ::btb[cpu].update(ip, branch_target, taken, branch_type);
+  auto& [btb, ittage, ras] = ::predictors.at(this);
+  ittage->update_brindirect(ip, branch_type, taken, branch_target);
+  ittage->fetch_history_update(ip, branch_type, taken, branch_target);
+  ras.update(ip, branch_target, taken, branch_type);
+  btb.update(ip, branch_target, taken, branch_type);
+}
+
+void O3_CPU::btb_save_state(std::ostream& os)
+{
+  auto& [btb, ittage, ras] = ::predictors.at(this);
+  champsim::checkpoint::write(os, btb);
+  ittage->save(os);
+  champsim::checkpoint::write(os, ras);
+}
+
+void O3_CPU::btb_restore_state(std::istream& is)
+{
+  auto& [btb, ittage, ras] = ::predictors.at(this);
+  champsim::checkpoint::read(is, btb);
+  ittage->restore(is);
+  champsim::checkpoint::read(is, ras);
 }
@@ -3,7 +3,9 @@ Code has been largely inspired  by the tagged PPM predictor simulator from Pierr
 */
 
 #include "instruction.h"
+#include "checkpoint.h"
 
+#include <algorithm>
 #include <inttypes.h>
 #include <math.h>
 #define NHIST 15 /*number of tagged tables*/
@@ -285,6 +287,37 @@ public:
     fprintf (stdout, "Total Storage= %d bytes;\n", STORAGESIZE / 8);
 #endif
   }
+
+  // The predictor is written whole, followed by the tables it points to. A table shared by several banks is written once.
+  void save(std::ostream& os) const
+  {
+    champsim::checkpoint::write(os, *this);
+    for (int i = 0; i <= NHIST; i++)
+      if (i == 0 || gtable[i] != gtable[i - 1])
+        champsim::checkpoint::write_array(os, gtable[i], std::size_t{1} << logg[i]);
+    champsim::checkpoint::write_array(os, rtable, 128);
+    champsim::checkpoint::write_array(os, IUMPred, std::size_t{1} << LOGSPEC);
+  }
+
+  // The saved pointers refer to the tables of the predictor that was saved, so those of this one are kept
+  void restore(std::istream& is)
+  {
+    gentry* tables[NHIST + 1];
+    std::copy(std::begin(gtable), std::end(gtable), std::begin(tables));
+    regionentry* regions = rtable;
+    specentry* spec = IUMPred;
+
+    champsim::checkpoint::read(is, *this);
+    std::copy(std::begin(tables), std::end(tables), std::begin(gtable));
+    rtable = regions;
+    IUMPred = spec;
+
+    for (int i = 0; i <= NHIST; i++)
+      if (i == 0 || gtable[i] != gtable[i - 1])
+        champsim::checkpoint::read_array(is, gtable[i], std::size_t{1} << logg[i]);
+    champsim::checkpoint::read_array(is, rtable, 128);
+    champsim::checkpoint::read_array(is, IUMPred, std::size_t{1} << LOGSPEC);
+  }
   
   // the index functions for the tagged tables uses path history as in the OGEHL predictor
   
@@ -76,7 +76,10 @@ class FileWriter:
 
         executable, elements, modules_to_compile, module_info, config_file, env = parsed_config
 
-        self.fileparts.append((os.path.join(inc_dir, instantiation_file_name), instantiation_file.get_instantiation_lines(**elements))) # Instantiation file
+        instantiation_keys = ('cores', 'caches', 'ptws', 'pmem', 'vmem')
+        self.fileparts.append((os.path.join(inc_dir, instantiation_file_name), instantiation_file.get_instantiation_lines(**util.subdict(elements, instantiation_keys)))) # Instantiation file
+        self.fileparts.extend((os.path.join(inc_dir, instantiation_file_name), instantiation_file.get_instantiation_lines(**util.subdict(v['elements'], instantiation_keys), struct_name=v['_struct_name'])) for v in elements.get('variants', []))
+        self.fileparts.append((os.path.join(inc_dir, instantiation_file_name), instantiation_file.get_variant_lines(elements.get('variants', []))))
         self.fileparts.append((os.path.join(inc_dir, constants_file_name), constants_file.get_constants_file(config_file, elements['pmem']))) # Constants header
 
         # Core modules file
@@ -14,6 +14,7 @@
 
 import itertools
 import functools
+import json
 import operator
 
 from . import util
@@ -43,6 +44,8 @@ core_builder_parts = {
     'dispatch_latency': '.dispatch_latency({dispatch_latency})',
     'schedule_latency': '.schedule_latency({schedule_latency})',
     'execute_latency': '.execute_latency({execute_latency})',
+    'ftq_size': '.ftq_size({ftq_size})',
+    'threads': '.threads({threads})',
     'dib_set': '  .dib_set({dib_set})',
     'dib_way': '  .dib_way({dib_way})',
     'dib_window': '  .dib_window({dib_window})'
@@ -82,7 +85,22 @@ def vector_string(iterable):
         return hoisted[0]
     return '{'+', '.join(hoisted)+'}'
 
-def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
+# The data of every module instance in the system
+def system_modules(cores, caches):
+    return itertools.chain(
+        *(cpu.get(k, []) for cpu,k in itertools.product(cores, ('_branch_predictor_data', '_btb_data'))),
+        *(cache.get(k, []) for cache,k in itertools.product(caches, ('_prefetcher_data', '_replacement_data')))
+    )
+
+# The modules of the system that do not mark that they keep their state for each instance
+def modules_with_shared_state(cores, caches):
+    return sorted({m.get('fname', m['name']) for m in system_modules(cores, caches) if not m.get('_per_instance_state', False)})
+
+# The modules of the system that do not save their state in checkpoints
+def modules_without_checkpoint_hooks(cores, caches):
+    return sorted({m.get('fname', m['name']) for m in system_modules(cores, caches) if not m.get('_checkpoint_hooks', False)})
+
+def get_instantiation_lines(cores, caches, ptws, pmem, vmem, struct_name='generated_environment'):
     upper_level_pairs = tuple(itertools.chain(
         ((elem['lower_level'], elem['name']) for elem in ptws),
         ((elem['lower_level'], elem['name']) for elem in caches),
@@ -110,7 +128,7 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
     yield '#include "defaults.hpp"'
     yield '#include "vmem.h"'
     yield 'namespace champsim::configured {'
-    yield 'struct generated_environment final : public champsim::environment {'
+    yield 'struct {} final : public champsim::environment {{'.format(struct_name)
     yield ''
 
     for ll,v in upper_levels.items():
@@ -197,6 +215,9 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
         yield from (v.format(**cpu) for k,v in core_builder_parts.items() if k in cpu)
         yield from (v.format(**cpu['DIB']) for k,v in dib_builder_parts.items() if k in cpu)
 
+        if 'fetch_policy' in cpu:
+            yield '.fetch_policy(O3_CPU::fetch_policy_type::{})'.format(cpu['fetch_policy'].upper())
+
         if cpu.get('_branch_predictor_data'):
             yield '.branch_predictor<{}>()'.format(' | '.join('O3_CPU::b{}'.format(k['name']) for k in cpu['_branch_predictor_data']))
         if cpu.get('_btb_data'):
@@ -240,5 +261,31 @@ def get_instantiation_lines(cores, caches, ptws, pmem, vmem):
     yield '}'
     yield ''
 
+    yield 'std::vector<std::string> modules_with_shared_state() const override {'
+    yield '  return {'
+    yield '    ' + ', '.join(json.dumps(m) for m in modules_with_shared_state(cores, caches))
+    yield '  };'
+    yield '}'
+    yield ''
+
+    yield 'std::vector<std::string> modules_without_checkpoint_hooks() const override {'
+    yield '  return {'
+    yield '    ' + ', '.join(json.dumps(m) for m in modules_without_checkpoint_hooks(cores, caches))
+    yield '  };'
+    yield '}'
+    yield ''
+
+    yield '};'
+    yield '}'
+
+def get_variant_lines(variants):
+    yield '#include <memory>'
+    yield '#include "batch.h"'
+    yield 'namespace champsim::configured {'
+    yield 'inline const std::vector<champsim::environment_variant> variants{'
+    for v in variants:
+        env_vars = ', '.join('{{{}, {}}}'.format(json.dumps(k), json.dumps(str(val))) for k,val in v.get('environment', {}).items())
+        shared_modules = ', '.join(json.dumps(m) for m in modules_with_shared_state(v['elements']['cores'], v['elements']['caches']))
+        yield '  {{{}, {{{}}}, {{{}}}, []() -> std::unique_ptr<champsim::environment> {{ return std::make_unique<{}>(); }}}},'.format(json.dumps(v['name']), env_vars, shared_modules, v['_struct_name'])
     yield '};'
     yield '}'
@@ -14,6 +14,7 @@
 
 import os
 import itertools
+import re
 
 from . import util
 
@@ -22,12 +23,19 @@ def get_module_name(path, start=os.path.dirname(os.path.dirname(os.path.abspath(
     fname_translation_table = str.maketrans('./-','_DH')
     return os.path.relpath(path, start=start).translate(fname_translation_table)
 
+# A module marks that it keeps all of its state for each instance with a file of this name in its directory
+per_instance_state_marker = '__per_instance_state__'
+
+def has_per_instance_state(path):
+    return os.path.isdir(path) and os.path.exists(os.path.join(path, per_instance_state_marker))
+
 class ModuleSearchContext:
     def __init__(self, paths):
         self.paths = [p for p in paths if os.path.exists(p) and os.path.isdir(p)]
 
     def data_from_path(self, path):
-        return {'name': get_module_name(path), 'fname': path, '_is_instruction_prefetcher': path.endswith('_instr')}
+        return {'name': get_module_name(path), 'fname': path, '_is_instruction_prefetcher': path.endswith('_instr'), '_per_instance_state': has_per_instance_state(path),
+                '_checkpoint_hooks': has_checkpoint_hooks(path)}
 
     # Try the context's module directories, then try to interpret as a path
     def find(self, module):
@@ -44,6 +52,18 @@ class ModuleSearchContext:
         files = itertools.starmap(os.path.join, itertools.chain(*(zip(itertools.repeat(b), d) for b,d,_ in base_dirs)))
         return [self.data_from_path(f) for f in files]
 
+# Find which of the given optional functions are defined in the module's sources
+def defined_functions(path, funcs):
+    if path is None or not os.path.isdir(path):
+        return tuple()
+
+    def read_text(fname):
+        with open(fname, 'rt', errors='ignore') as rfp:
+            return rfp.read()
+
+    sources = '\n'.join(read_text(os.path.join(base, f)) for base,_,files in os.walk(path) for f in files)
+    return tuple(f for f in funcs if re.search(r'\b{}\s*\('.format(f), sources))
+
 # A unifying function for the four module types to return their information
 def data_getter(prefix, module_name, funcs):
     return {
@@ -52,16 +72,26 @@ def data_getter(prefix, module_name, funcs):
         'func_map': { k: '_'.join((prefix, module_name, k)) for k in funcs } # Resolve function names
     }
 
-def get_branch_data(module_name):
-    return data_getter('bpred', module_name, ('initialize_branch_predictor', 'last_branch_result', 'predict_branch'))
+# Optional functions are only called for the modules that define them
+branch_optional_funcs = ('branch_predictor_save_state', 'branch_predictor_restore_state')
+btb_optional_funcs = ('btb_save_state', 'btb_restore_state')
+pref_optional_funcs = ('prefetcher_save_state', 'prefetcher_restore_state')
+repl_optional_funcs = ('replacement_save_state', 'replacement_restore_state')
+
+# A module saves its state in checkpoints if it defines both of the optional functions for its type
+def has_checkpoint_hooks(path):
+    return any(len(defined_functions(path, funcs)) == len(funcs) for funcs in (branch_optional_funcs, btb_optional_funcs, pref_optional_funcs, repl_optional_funcs))
+
+def get_branch_data(module_name, path=None):
+    return data_getter('bpred', module_name, ('initialize_branch_predictor', 'last_branch_result', 'predict_branch', *defined_functions(path, branch_optional_funcs)))
 
-def get_btb_data(module_name):
-    return data_getter('btb', module_name, ('initialize_btb', 'update_btb', 'btb_prediction'))
+def get_btb_data(module_name, path=None):
+    return data_getter('btb', module_name, ('initialize_btb', 'update_btb', 'btb_prediction', *defined_functions(path, btb_optional_funcs)))
 
-def get_pref_data(module_name, is_instruction_cache=False):
+def get_pref_data(module_name, is_instruction_cache=False, path=None):
     prefix = 'ipref' if is_instruction_cache else 'pref'
     return util.chain(
-            data_getter(prefix, module_name, ('prefetcher_initialize', 'prefetcher_cache_operate', 'prefetcher_branch_operate', 'prefetcher_cache_fill', 'prefetcher_cycle_operate', 'prefetcher_final_stats')),
+            data_getter(prefix, module_name, ('prefetcher_initialize', 'prefetcher_cache_operate', 'prefetcher_branch_operate', 'prefetcher_cache_fill', 'prefetcher_cycle_operate', 'prefetcher_final_stats', *defined_functions(path, pref_optional_funcs))),
             { 'deprecated_func_map' : {
                     'l1i_prefetcher_initialize': '_'.join((prefix, module_name, 'prefetcher_initialize')),
                     'l1d_prefetcher_initialize': '_'.join((prefix, module_name, 'prefetcher_initialize')),
@@ -85,8 +115,8 @@ def get_pref_data(module_name, is_instruction_cache=False):
             }
         )
 
-def get_repl_data(module_name):
-    return data_getter('repl', module_name, ('initialize_replacement', 'find_victim', 'update_replacement_state', 'replacement_final_stats'))
+def get_repl_data(module_name, path=None):
+    return data_getter('repl', module_name, ('initialize_replacement', 'find_victim', 'update_replacement_state', 'replacement_final_stats', *defined_functions(path, repl_optional_funcs)))
 
 # Generate C++ code giving the mangled module specialization functions
 def mangled_declarations(rtype, names, args, attrs=[]):
@@ -163,7 +193,9 @@ def get_ooo_cpu_module_lines(branch_data, btb_data):
     branch_variant_data = [
         ('initialize_branch_predictor',),
         ('last_branch_result', (('uint64_t', 'ip'), ('uint64_t', 'target'), ('uint8_t', 'taken'), ('uint8_t', 'branch_type'))),
-        ('predict_branch', (('uint64_t','ip'),), 'uint8_t', 'std::bit_or')
+        ('predict_branch', (('uint64_t','ip'),), 'uint8_t', 'std::bit_or'),
+        ('branch_predictor_save_state', (('std::ostream&','os'),)),
+        ('branch_predictor_restore_state', (('std::istream&','is'),))
     ]
 
     btb_prefix = 't'
@@ -171,7 +203,9 @@ def get_ooo_cpu_module_lines(branch_data, btb_data):
     btb_variant_data = [
         ('initialize_btb',),
         ('update_btb', (('uint64_t','ip'), ('uint64_t','predicted_target'), ('uint8_t','taken'), ('uint8_t','branch_type'))),
-        ('btb_prediction', (('uint64_t','ip'),), 'std::pair<uint64_t, uint8_t>', 'champsim::detail::take_last')
+        ('btb_prediction', (('uint64_t','ip'),), 'std::pair<uint64_t, uint8_t>', 'champsim::detail::take_last'),
+        ('btb_save_state', (('std::ostream&','os'),)),
+        ('btb_restore_state', (('std::istream&','is'),))
     ]
 
     classname = 'O3_CPU::module_model<' + branch_varname + ', ' + btb_varname + '>'
@@ -182,13 +216,13 @@ def get_ooo_cpu_module_lines(branch_data, btb_data):
             constants_for_modules(btb_prefix, btb_data.values()), ('',),
 
             # Declare name-mangled functions
-            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in branch_data.values()], *finfo) for fname, *finfo in branch_variant_data),
-            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in btb_data.values()], *finfo) for fname, *finfo in btb_variant_data)
+            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in branch_data.values() if fname in v['func_map']], *finfo) for fname, *finfo in branch_variant_data),
+            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in btb_data.values() if fname in v['func_map']], *finfo) for fname, *finfo in btb_variant_data)
         ),
 
         itertools.chain(
-            *(get_discriminator(fname, branch_varname, btb_varname, [(branch_prefix + v['name'], v['func_map'][fname]) for v in branch_data.values()], *finfo, classname=classname) for fname, *finfo in branch_variant_data),
-            *(get_discriminator(fname, btb_varname, branch_varname, [(btb_prefix + v['name'], v['func_map'][fname]) for v in btb_data.values()], *finfo, classname=classname) for fname, *finfo in btb_variant_data)
+            *(get_discriminator(fname, branch_varname, btb_varname, [(branch_prefix + v['name'], v['func_map'][fname]) for v in branch_data.values() if fname in v['func_map']], *finfo, classname=classname) for fname, *finfo in branch_variant_data),
+            *(get_discriminator(fname, btb_varname, branch_varname, [(btb_prefix + v['name'], v['func_map'][fname]) for v in btb_data.values() if fname in v['func_map']], *finfo, classname=classname) for fname, *finfo in btb_variant_data)
         )
        )
 
@@ -202,7 +236,9 @@ def get_cache_module_lines(pref_data, repl_data):
         ('prefetcher_cache_operate', (('uint64_t', 'addr'), ('uint64_t', 'ip'), ('uint8_t', 'cache_hit'), ('bool', 'useful_prefetch'), ('uint8_t', 'type'), ('uint32_t', 'metadata_in')), 'uint32_t', 'std::bit_xor'),
         ('prefetcher_cache_fill', (('uint64_t', 'addr'), ('uint32_t', 'set'), ('uint32_t', 'way'), ('uint8_t', 'prefetch'), ('uint64_t', 'evicted_addr'), ('uint32_t', 'metadata_in')), 'uint32_t', 'std::bit_xor'),
         ('prefetcher_cycle_operate',),
-        ('prefetcher_final_stats',)
+        ('prefetcher_final_stats',),
+        ('prefetcher_save_state', (('std::ostream&','os'),)),
+        ('prefetcher_restore_state', (('std::istream&','is'),))
     ]
 
     pref_branch_variant_data = [
@@ -216,7 +252,9 @@ def get_cache_module_lines(pref_data, repl_data):
         ('initialize_replacement',),
         ('find_victim', (('uint32_t','triggering_cpu'), ('uint64_t','instr_id'), ('uint32_t','set'), ('const BLOCK*','current_set'), ('uint64_t','ip'), ('uint64_t','full_addr'), ('uint32_t','type')), 'uint32_t', 'champsim::detail::take_last'),
         ('update_replacement_state', (('uint32_t','triggering_cpu'), ('uint32_t','set'), ('uint32_t','way'), ('uint64_t','full_addr'), ('uint64_t','ip'), ('uint64_t','victim_addr'), ('uint32_t','type'), ('uint8_t','hit'))),
-        ('replacement_final_stats',)
+        ('replacement_final_stats',),
+        ('replacement_save_state', (('std::ostream&','os'),)),
+        ('replacement_restore_state', (('std::istream&','is'),))
     ]
 
     classname = 'CACHE::module_model<' + pref_varname + ', ' + repl_varname + '>'
@@ -227,7 +265,7 @@ def get_cache_module_lines(pref_data, repl_data):
             constants_for_modules(repl_prefix, repl_data.values()), ('',),
 
             # Establish functions common to all prefetchers
-            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in pref_data.values()], *finfo) for fname, *finfo in pref_nonbranch_variant_data),
+            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in pref_data.values() if fname in v['func_map']], *finfo) for fname, *finfo in pref_nonbranch_variant_data),
 
             # Establish functions that only matter to instruction prefetchers
             ('', '// Assert data prefetchers do not operate on branches'),
@@ -235,11 +273,11 @@ def get_cache_module_lines(pref_data, repl_data):
             *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in pref_data.values() if v.get('_is_instruction_prefetcher')], *finfo) for fname, *finfo in pref_branch_variant_data),
 
             # Declare name-mangled functions
-            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in repl_data.values()], *finfo) for fname, *finfo in repl_variant_data)
+            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in repl_data.values() if fname in v['func_map']], *finfo) for fname, *finfo in repl_variant_data)
         ),
 
         itertools.chain(
-            *(get_discriminator(fname, pref_varname, repl_varname, [(pref_prefix + v['name'], v['func_map'][fname]) for v in pref_data.values()], *finfo, classname=classname) for fname, *finfo in itertools.chain(pref_nonbranch_variant_data, pref_branch_variant_data)),
-            *(get_discriminator(fname, repl_varname, pref_varname, [(repl_prefix + v['name'], v['func_map'][fname]) for v in repl_data.values()], *finfo, classname=classname) for fname, *finfo in repl_variant_data)
+            *(get_discriminator(fname, pref_varname, repl_varname, [(pref_prefix + v['name'], v['func_map'][fname]) for v in pref_data.values() if fname in v['func_map']], *finfo, classname=classname) for fname, *finfo in itertools.chain(pref_nonbranch_variant_data, pref_branch_variant_data)),
+            *(get_discriminator(fname, repl_varname, pref_varname, [(repl_prefix + v['name'], v['func_map'][fname]) for v in repl_data.values() if fname in v['func_map']], *finfo, classname=classname) for fname, *finfo in repl_variant_data)
         )
        )
@@ -12,11 +12,13 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import copy
 import itertools
 import collections
 import os
 import math
 
+from . import constants_file
 from . import defaults
 from . import modules
 from . import util
@@ -69,7 +71,7 @@ def normalize_config(config_file):
 
     # Default core elements
     # Give cores numeric indices
-    core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB')
+    core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'ftq_size', 'threads', 'fetch_policy', 'branch_predictor', 'btb', 'DIB')
     cores = [util.chain(cpu, util.subdict(config_file, core_keys_to_copy), {'name': 'cpu'+str(i), '_index': i}) for i,cpu in enumerate(cores)]
 
     pinned_cache_names = ('L1I', 'L1D', 'ITLB', 'DTLB', 'L2C', 'STLB')
@@ -232,20 +234,46 @@ def parse_config(*configs, module_dir=[], branch_dir=[], btb_dir=[], pref_dir=[]
 
     name = executable_name(*configs)
     merged_configs = util.chain(*configs)
-    elements, modules_to_compile, module_info, config_file, env = parse_normalized(*normalize_config(merged_configs),
-        merged_configs,
-        branch_context = modules.ModuleSearchContext([*(os.path.join(m, 'branch') for m in module_dir), *branch_dir, os.path.join(champsim_root, 'branch')]),
-        btb_context = modules.ModuleSearchContext([*(os.path.join(m, 'btb') for m in module_dir), *btb_dir, os.path.join(champsim_root, 'btb')]),
-        replacement_context = modules.ModuleSearchContext([*(os.path.join(m, 'replacement') for m in module_dir), *repl_dir, os.path.join(champsim_root, 'replacement')]),
-        prefetcher_context = modules.ModuleSearchContext([*(os.path.join(m, 'prefetcher') for m in module_dir), *pref_dir, os.path.join(champsim_root, 'prefetcher')]),
-        compile_all_modules = compile_all_modules
-    )
+    variants = merged_configs.get('variants', [])
+    merged_configs = {k:v for k,v in merged_configs.items() if k != 'variants'}
+
+    contexts = {
+        'branch_context': modules.ModuleSearchContext([*(os.path.join(m, 'branch') for m in module_dir), *branch_dir, os.path.join(champsim_root, 'branch')]),
+        'btb_context': modules.ModuleSearchContext([*(os.path.join(m, 'btb') for m in module_dir), *btb_dir, os.path.join(champsim_root, 'btb')]),
+        'replacement_context': modules.ModuleSearchContext([*(os.path.join(m, 'replacement') for m in module_dir), *repl_dir, os.path.join(champsim_root, 'replacement')]),
+        'prefetcher_context': modules.ModuleSearchContext([*(os.path.join(m, 'prefetcher') for m in module_dir), *pref_dir, os.path.join(champsim_root, 'prefetcher')])
+    }
+
+    # Parsing modifies the elements in place, so the variants start from a copy
+    base_config = copy.deepcopy(merged_configs)
+    elements, modules_to_compile, module_info, config_file, env = parse_normalized(*normalize_config(base_config), base_config, **contexts, compile_all_modules=compile_all_modules)
+
+    # Each variant is an independent system in the same executable, so it must agree with the base on the compile-time constants
+    if variants:
+        constants = list(constants_file.get_constants_file(config_file, elements['pmem']))
+        parsed_variants = []
+        for i,variant in enumerate(variants):
+            if 'name' not in variant:
+                raise ValueError('Variant {} of {} has no name'.format(i, name))
+
+            variant_config = util.chain({k:v for k,v in variant.items() if k not in ('name', 'environment')}, copy.deepcopy(merged_configs))
+            variant_elements, variant_modules, _, variant_constants, _ = parse_normalized(*normalize_config(variant_config), variant_config, **contexts, compile_all_modules=compile_all_modules)
+            if list(constants_file.get_constants_file(variant_constants, variant_elements['pmem'])) != constants:
+                raise ValueError('Variant {} of {} changes a compile-time constant'.format(variant['name'], name))
+
+            modules_to_compile = [*set(itertools.chain(modules_to_compile, variant_modules))]
+            parsed_variants.append({'name': variant['name'], 'environment': variant.get('environment', {}), 'elements': variant_elements, '_struct_name': 'generated_environment_{}'.format(i)})
+
+        if len(set(v['name'] for v in parsed_variants)) != len(parsed_variants):
+            raise ValueError('The variants of {} do not have unique names'.format(name))
+
+        elements = {**elements, 'variants': parsed_variants}
 
     module_info = {
-            'repl': {k: util.chain(v, modules.get_repl_data(v['name'])) for k,v in module_info['repl'].items()},
-            'pref': {k: util.chain(v, modules.get_pref_data(v['name'], v['_is_instruction_prefetcher'])) for k,v in module_info['pref'].items()},
-            'branch': {k: util.chain(v, modules.get_branch_data(v['name'])) for k,v in module_info['branch'].items()},
-            'btb': {k: util.chain(v, modules.get_btb_data(v['name'])) for k,v in module_info['btb'].items()},
+            'repl': {k: util.chain(v, modules.get_repl_data(v['name'], v.get('fname'))) for k,v in module_info['repl'].items()},
+            'pref': {k: util.chain(v, modules.get_pref_data(v['name'], v['_is_instruction_prefetcher'], v.get('fname'))) for k,v in module_info['pref'].items()},
+            'branch': {k: util.chain(v, modules.get_branch_data(v['name'], v.get('fname'))) for k,v in module_info['branch'].items()},
+            'btb': {k: util.chain(v, modules.get_btb_data(v['name'], v.get('fname'))) for k,v in module_info['btb'].items()},
             }
 
     return name, elements, modules_to_compile, module_info, config_file, env
@@ -0,0 +1,105 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ACCESS_CAPTURE_H
+#define ACCESS_CAPTURE_H
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "champsim_constants.h"
+#include "channel.h"
+#include "seekable_zstd.h"
+
+class CACHE;
+
+namespace champsim
+{
+/**
+ * One access to a cache, as it completed its tag check.
+ * A capture ends with one record per core, of type instructions_marker, that gives the instructions the core retired in the address field.
+ */
+struct cache_access {
+  constexpr static uint8_t hit_flag = 1;
+  constexpr static uint8_t warmup_flag = 2;
+  constexpr static uint8_t instructions_marker = 0xff;
+
+  uint64_t address;
+  uint64_t ip;
+  uint64_t cycle;
+  uint32_t cpu;
+  uint8_t type;
+  uint8_t flags;
+  uint16_t reserved;
+};
+
+/**
+ * Write the accesses to a cache as a compressed stream, in the seekable Zstandard format.
+ */
+class access_capture_writer
+{
+  std::ofstream file;
+  seekable_zstd_writer writer{file};
+
+public:
+  explicit access_capture_writer(std::string fname);
+
+  void write(const cache_access& access);
+
+  // Write the instructions retired by each core and finish the stream
+  void close(const std::vector<uint64_t>& instructions);
+};
+
+class access_capture_reader
+{
+  seekable_zstd_istream stream;
+  std::vector<cache_access> buffer;
+  std::size_t next = 0;
+
+public:
+  explicit access_capture_reader(std::string fname);
+
+  // Read the next access, returning false at the end of the stream
+  bool read(cache_access& access);
+};
+
+struct replay_stats {
+  std::string name;
+  uint64_t warmup_accesses = 0;
+  uint64_t captured_hits = 0; // the accesses after the warmup that hit when they were captured
+  std::array<std::array<uint64_t, NUM_CPUS>, champsim::to_underlying(access_type::NUM_TYPES)> hits = {};
+  std::array<std::array<uint64_t, NUM_CPUS>, champsim::to_underlying(access_type::NUM_TYPES)> misses = {};
+  std::vector<uint64_t> instructions{};
+  double seconds = 0;
+};
+
+/**
+ * Replay the captured accesses through the tags and the replacement policy of the cache, without timing, queues, or prefetching.
+ * The cache is warmed by the accesses captured during the warmup, and the statistics count the rest.
+ */
+replay_stats replay_accesses(CACHE& cache, access_capture_reader& reader);
+
+/**
+ * Replay only the accesses captured during the warmup through the tags and the replacement policy of the cache, as replay_accesses() does,
+ * and return how many there were. The cycle, the warmup flag, and the cpu of the cache are left as they were.
+ */
+uint64_t warm_with_accesses(CACHE& cache, access_capture_reader& reader);
+} // namespace champsim
+
+#endif
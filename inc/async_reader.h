@@ -0,0 +1,192 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ASYNC_READER_H
+#define ASYNC_READER_H
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "instruction.h"
+#include "util/detect.h"
+
+namespace champsim
+{
+/**
+ * Read from another reader on a background thread, so that decompression and decoding are not on the simulation's critical path.
+ * The producer passes finished instructions to the simulation through a single-producer, single-consumer ring. It runs ahead until the ring is full.
+ * Either side that finds the ring full or empty sleeps until the other makes progress, rather than spinning.
+ */
+template <typename T>
+class async_reader
+{
+  struct shared_state {
+    T source;
+    std::vector<std::optional<ooo_model_instr>> ring;
+    alignas(64) std::atomic<std::size_t> head = 0; // the number of instructions taken, written only by the consumer
+    alignas(64) std::atomic<std::size_t> tail = 0; // the number of instructions produced, written only by the producer
+    std::atomic<bool> done = false;                // the source has ended, and every instruction is in the ring
+    std::atomic<bool> stop = false;                // the consumer no longer needs instructions
+    std::optional<ooo_model_instr> held{};         // an instruction read from the source while the ring was full
+    std::exception_ptr error{};
+
+    // A side that is about to sleep sets its flag before checking the ring again, and the other side checks the flag after each change to
+    // the ring. With sequentially consistent stores and loads, at least one of them sees the other, so no wakeup is lost.
+    mutable std::mutex mutex;
+    mutable std::condition_variable progress;
+    mutable std::atomic<bool> producer_waiting = false;
+    mutable std::atomic<bool> consumer_waiting = false;
+
+    shared_state(T&& src, std::size_t capacity) : source(std::move(src)), ring(capacity) {}
+
+    template <typename Pred>
+    void block_until(std::atomic<bool>& waiting, Pred pred) const
+    {
+      std::unique_lock lock{mutex};
+      waiting.store(true);
+      progress.wait(lock, pred);
+      waiting.store(false);
+    }
+
+    void wake(const std::atomic<bool>& waiting) const
+    {
+      if (waiting.load()) {
+        std::lock_guard lock{mutex};
+        progress.notify_all();
+      }
+    }
+
+    void produce()
+    {
+      try {
+        while (held.has_value() || !source.eof()) {
+          if (!held.has_value())
+            held = source();
+
+          auto slot = tail.load(std::memory_order_relaxed);
+          if (slot - head.load(std::memory_order_acquire) >= std::size(ring)) {
+            block_until(producer_waiting, [&] { return slot - head.load() < std::size(ring) || stop.load(); });
+            if (stop.load(std::memory_order_relaxed))
+              return;
+          }
+          ring[slot % std::size(ring)] = std::move(held);
+          held.reset();
+          tail.store(slot + 1);
+          wake(consumer_waiting);
+
+          if (stop.load(std::memory_order_relaxed))
+            return;
+        }
+      } catch (...) {
+        error = std::current_exception();
+      }
+      done.store(true);
+      wake(consumer_waiting);
+    }
+
+    // Wait until an instruction is ready. Returns false if the source has ended instead.
+    bool wait() const
+    {
+      auto slot = head.load(std::memory_order_relaxed);
+      if (slot == tail.load(std::memory_order_acquire))
+        block_until(consumer_waiting, [&] { return slot != tail.load() || done.load(); });
+      if (slot != tail.load(std::memory_order_acquire))
+        return true;
+      if (error)
+        std::rethrow_exception(error);
+      return false;
+    }
+  };
+
+  std::unique_ptr<shared_state> state;
+  std::thread producer;
+
+  template <typename U>
+  using has_skip = decltype(std::declval<U&>().skip(uint64_t{}));
+
+  void stop_producer()
+  {
+    if (producer.joinable()) {
+      state->stop.store(true);
+      state->wake(state->producer_waiting);
+      producer.join();
+    }
+  }
+
+public:
+  constexpr static std::size_t default_capacity = 1 << 14;
+
+  explicit async_reader(T&& source, std::size_t capacity = default_capacity)
+      : state(std::make_unique<shared_state>(std::move(source), capacity)), producer([s = state.get()] { s->produce(); })
+  {
+  }
+
+  async_reader(async_reader&&) = default;
+  async_reader& operator=(async_reader&&) = delete;
+
+  ~async_reader() { stop_producer(); }
+
+  ooo_model_instr operator()()
+  {
+    [[maybe_unused]] bool ready = state->wait();
+    assert(ready);
+
+    auto slot = state->head.load(std::memory_order_relaxed);
+    auto retval = std::move(state->ring[slot % std::size(state->ring)]).value();
+    state->head.store(slot + 1);
+    state->wake(state->producer_waiting);
+    return retval;
+  }
+
+  bool eof() const { return !state->wait(); }
+
+  // If the source can skip instructions without decoding them, the producer is paused while it does
+  template <typename U = T, typename = std::enable_if_t<champsim::is_detected_v<has_skip, U>>>
+  uint64_t skip(uint64_t count)
+  {
+    stop_producer();
+    if (state->error)
+      std::rethrow_exception(state->error);
+
+    // The instructions already produced come first
+    uint64_t skipped = 0;
+    auto head = state->head.load(std::memory_order_relaxed);
+    for (; skipped < count && head != state->tail.load(std::memory_order_relaxed); ++skipped)
+      ++head;
+    state->head.store(head, std::memory_order_relaxed);
+    if (skipped < count && state->held.has_value()) {
+      state->held.reset();
+      ++skipped;
+    }
+
+    skipped += state->source.skip(count - skipped);
+
+    state->stop.store(false, std::memory_order_relaxed);
+    state->done.store(false, std::memory_order_relaxed);
+    producer = std::thread{[s = state.get()] { s->produce(); }};
+    return skipped;
+  }
+};
+} // namespace champsim
+
+#endif
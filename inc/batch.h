@@ -0,0 +1,124 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "environment.h"
+#include "instruction.h"
+#include "phase_info.h"
+#include "tracereader.h"
+
+namespace champsim
+{
+/**
+ * A variation of the configured system. In batch mode, each variant is simulated on its own host thread, reading the same traces, unless
+ * any of the variants has modules that share their state between instances.
+ */
+struct environment_variant {
+  std::string name;
+  std::vector<std::pair<std::string, std::string>> environment_variables; // set while the variant is initialized, for modules that read them
+  std::vector<std::string> modules_with_shared_state;                      // as given by environment::modules_with_shared_state()
+  std::function<std::unique_ptr<environment>()> make;
+};
+
+/**
+ * Decode each trace once for several consumers.
+ * The instructions are decoded in chunks when the first consumer reaches them, and released when the last consumer has passed them.
+ * To bound the memory held, a consumer may not run more than a given number of chunks ahead of the slowest, unless the slowest is itself
+ * held back on another trace.
+ */
+class trace_fanout
+{
+public:
+  constexpr static std::size_t chunk_size = 4096;
+
+  struct chunk_type {
+    std::vector<ooo_model_instr> instrs;
+    bool last = false; // no chunk follows this one
+  };
+
+  trace_fanout(std::vector<tracereader>&& sources, std::size_t num_consumers, std::size_t max_lead = 64);
+
+  /**
+   * A reader of the given trace for the given consumer. Each must be created before any of them is read, and the fanout must outlive it.
+   */
+  tracereader reader(std::size_t trace, std::size_t consumer);
+
+  /**
+   * Note that the consumer has stopped reading, so that it no longer holds back the others.
+   */
+  void finish(std::size_t consumer);
+
+  // The chunk with the given sequence number, waiting while the consumer is too far ahead of the others
+  std::shared_ptr<const chunk_type> get(std::size_t trace, std::size_t consumer, uint64_t seq);
+
+private:
+  struct trace_state {
+    tracereader source;
+    std::deque<std::shared_ptr<const chunk_type>> chunks{};
+    uint64_t first_chunk = 0;        // the sequence number of the front of chunks
+    std::vector<uint64_t> position{}; // the chunk each consumer is reading
+  };
+
+  std::mutex mutex;
+  std::condition_variable progress;
+  std::vector<trace_state> traces;
+  std::vector<bool> waiting; // the consumers held back by the others
+  std::size_t max_lead;
+
+  bool held_back(const trace_state& state, uint64_t seq) const;
+};
+
+struct batch_result {
+  std::string name;
+  std::unique_ptr<environment> env;
+  std::vector<phase_stats> stats;
+};
+
+/**
+ * Make the system of the variant and initialize it, with the variant's environment variables set.
+ */
+std::unique_ptr<environment> make_variant(const environment_variant& variant);
+
+/**
+ * Simulate each of the variants through the phases on its own host thread, feeding all of them from one decoding of the traces.
+ * The variants are initialized one at a time on the calling thread, with their environment variables set.
+ */
+std::vector<batch_result> run_batch(const std::vector<environment_variant>& variants, std::vector<phase_info>& phases, std::vector<tracereader>&& traces,
+                                    bool show_heartbeat);
+
+/**
+ * Simulate each of the variants through the phases in a process of its own, so that modules that share their state between instances start
+ * afresh for each. The processes run at once. Each opens the traces with open_traces and passes its result to report before it exits, and
+ * the reports are printed in the order of the variants when all have finished. Throws if the simulation of any variant fails.
+ */
+void run_batch_in_processes(const std::vector<environment_variant>& variants, std::vector<phase_info>& phases,
+                            const std::function<std::vector<tracereader>()>& open_traces, bool show_heartbeat,
+                            const std::function<void(batch_result&)>& report);
+} // namespace champsim
+
+#endif
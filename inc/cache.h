@@ -25,6 +25,8 @@
 #include <array>
 #include <bitset>
 #include <deque>
+#include <iosfwd>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -33,10 +35,32 @@
 #include "champsim.h"
 #include "champsim_constants.h"
 #include "channel.h"
+#include "latency_histograms.h"
 #include "module_impl.h"
+#include "module_stats.h"
 #include "operable.h"
+#include "util/lru_table.h"
 #include <type_traits>
 
+namespace champsim
+{
+class access_capture_writer;
+}
+
+// The steps of a request through a cache, measured between the events of its timeline
+enum class cache_hop : unsigned {
+  QUEUE = 0, // waiting in the channel for tag bandwidth
+  TAG,       // the tag check, including translation
+  MSHR,      // waiting for an MSHR or for room in the lower level
+  LOWER,     // served by the lower level
+  FILL,      // waiting for fill bandwidth
+  TOTAL,     // from the channel until the hit or the fill
+  NUM_HOPS
+};
+
+inline constexpr std::array<std::string_view, static_cast<std::size_t>(cache_hop::NUM_HOPS)> cache_hop_names{"QUEUE"sv, "TAG"sv, "MSHR"sv, "LOWER"sv, "FILL"sv,
+                                                                                                             "TOTAL"sv};
+
 struct cache_stats {
   std::string name;
   // prefetch stats
@@ -45,12 +69,25 @@ struct cache_stats {
   uint64_t pf_useful = 0;
   uint64_t pf_useless = 0;
   uint64_t pf_fill = 0;
+  uint64_t pf_timely = 0;    // demand hits on prefetched blocks
+  uint64_t pf_late = 0;      // demand misses that merged with a prefetch in flight
+  uint64_t pf_early = 0;     // demand misses on prefetched blocks that were evicted unused
+  uint64_t pf_pollution = 0; // demand misses on blocks that were evicted by a prefetch fill
+  std::array<uint64_t, 16> pf_use_distance = {}; // cycles from the fill of a prefetch to its first hit, in the buckets of champsim::log2_bucket()
 
   std::array<std::array<uint64_t, NUM_CPUS>, champsim::to_underlying(access_type::NUM_TYPES)> hits = {};
   std::array<std::array<uint64_t, NUM_CPUS>, champsim::to_underlying(access_type::NUM_TYPES)> misses = {};
 
   double avg_miss_latency = 0;
   uint64_t total_miss_latency = 0;
+
+  champsim::latency_histograms<cache_hop> latency{};
+
+  // The blocks owned by each core, sampled every occupancy_sample_period cycles
+  uint64_t occupancy_sample_period = 0;
+  std::vector<std::array<uint64_t, NUM_CPUS>> occupancy{};
+
+  champsim::module_stats modules{}; // registered by the prefetcher and replacement policy
 };
 
 class CACHE : public champsim::operable
@@ -83,6 +120,8 @@ class CACHE : public champsim::operable
 
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
 
+    champsim::request_timeline timeline{};
+
     std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
     std::vector<std::deque<response_type>*> to_return{};
 
@@ -107,6 +146,9 @@ class CACHE : public champsim::operable
 
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
     uint64_t cycle_enqueued;
+    uint8_t miss_depth = 0;
+
+    champsim::request_timeline timeline{};
 
     std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
     std::vector<std::deque<response_type>*> to_return{};
@@ -123,6 +165,8 @@ class CACHE : public champsim::operable
   void finish_translation(const response_type& packet);
 
   void issue_translation();
+  void capture_access(const tag_lookup_type& pkt, bool hit);
+  void record_latency(access_type type, const champsim::request_timeline& timeline);
 
   struct BLOCK {
     bool valid = false;
@@ -166,6 +210,27 @@ public:
   const uint64_t HIT_LATENCY, FILL_LATENCY;
   const unsigned OFFSET_BITS;
   set_type block{NUM_SET * NUM_WAY};
+
+  // The cycle at which each block was filled by a prefetch from this cache
+  std::vector<uint64_t> prefetch_fill_cycle = std::vector<uint64_t>(NUM_SET * NUM_WAY);
+
+  // The core whose access filled each block, and the number of valid blocks each core owns
+  std::vector<uint32_t> block_owner = std::vector<uint32_t>(NUM_SET * NUM_WAY, std::numeric_limits<uint32_t>::max());
+  std::array<uint64_t, NUM_CPUS> blocks_owned{};
+
+  void take_ownership(std::size_t block_idx, uint32_t owner);
+  void release_ownership(std::size_t block_idx);
+
+  // Recently evicted blocks, to tell which demand misses the prefetcher caused
+  struct block_number {
+    unsigned shamt;
+    auto operator()(uint64_t address) const { return address >> shamt; }
+  };
+  using victim_filter_type = champsim::lru_table<uint64_t, block_number, block_number>;
+  constexpr static std::size_t victim_filter_sets = 64;
+  constexpr static std::size_t victim_filter_ways = 4;
+  victim_filter_type unused_prefetch_victims{victim_filter_sets, victim_filter_ways, {OFFSET_BITS}, {OFFSET_BITS}}; // prefetched, evicted before a hit
+  victim_filter_type prefetch_fill_victims{victim_filter_sets, victim_filter_ways, {OFFSET_BITS}, {OFFSET_BITS}};   // evicted to make room for a prefetch
   const long int MAX_TAG, MAX_FILL;
   const bool prefetch_as_load;
   const bool match_offset_bits;
@@ -177,9 +242,23 @@ public:
 
   stats_type sim_stats, roi_stats;
 
+  // The statistics of the prefetcher and replacement policy, reported with those of the cache
+  champsim::module_stats_registry stats_registry{};
+
   std::deque<mshr_type> MSHR;
   std::deque<mshr_type> inflight_writes;
 
+  // If set, each access that completes its tag check is recorded
+  champsim::access_capture_writer* access_capture = nullptr;
+
+  // If attached to a tracer, the events of the packets in this cache are recorded
+  champsim::event_source event_trace{};
+
+  // If nonzero, the blocks owned by each core are sampled this often, in cycles of this cache
+  uint64_t occupancy_sample_period = 0;
+
+  const std::array<uint64_t, NUM_CPUS>& get_blocks_owned() const { return blocks_owned; }
+
   long operate() override final;
 
   void initialize() override final;
@@ -218,6 +297,12 @@ public:
 
   void print_deadlock() override;
 
+  // Look up and fill the line at once, as if the miss were served immediately, updating only the tags and the replacement policy. Returns whether it hit.
+  bool replay_access(uint64_t address, uint64_t ip, uint32_t triggering_cpu, access_type type);
+
+  void save_checkpoint(std::ostream& os);
+  void restore_checkpoint(std::istream& is);
+
 #include "cache_module_decl.inc"
 
   struct module_concept {
@@ -236,6 +321,11 @@ public:
     virtual void impl_update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr,
                                                uint32_t type, uint8_t hit) = 0;
     virtual void impl_replacement_final_stats() = 0;
+
+    virtual void impl_prefetcher_save_state(std::ostream& os) = 0;
+    virtual void impl_prefetcher_restore_state(std::istream& is) = 0;
+    virtual void impl_replacement_save_state(std::ostream& os) = 0;
+    virtual void impl_replacement_restore_state(std::istream& is) = 0;
   };
 
   template <unsigned long long P_FLAG, unsigned long long R_FLAG>
@@ -256,6 +346,11 @@ public:
     void impl_update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr,
                                        uint32_t type, uint8_t hit);
     void impl_replacement_final_stats();
+
+    void impl_prefetcher_save_state(std::ostream& os);
+    void impl_prefetcher_restore_state(std::istream& is);
+    void impl_replacement_save_state(std::ostream& os);
+    void impl_replacement_restore_state(std::istream& is);
   };
 
   std::unique_ptr<module_concept> module_pimpl;
@@ -288,6 +383,11 @@ public:
   }
   void impl_replacement_final_stats() { module_pimpl->impl_replacement_final_stats(); }
 
+  void impl_prefetcher_save_state(std::ostream& os) { module_pimpl->impl_prefetcher_save_state(os); }
+  void impl_prefetcher_restore_state(std::istream& is) { module_pimpl->impl_prefetcher_restore_state(is); }
+  void impl_replacement_save_state(std::ostream& os) { module_pimpl->impl_replacement_save_state(os); }
+  void impl_replacement_restore_state(std::istream& is) { module_pimpl->impl_replacement_restore_state(is); }
+
   class builder_conversion_tag
   {
   };
@@ -20,6 +20,9 @@
 #include <cstdint>
 #include <exception>
 
+// The number of instructions retired by each core, for modules that need it. Systems simulated side by side point this at their own counts.
+extern thread_local uint64_t* current_instr_count;
+
 namespace champsim
 {
 struct deadlock : public std::exception {
@@ -32,6 +35,13 @@ constexpr bool debug_print = true;
 #else
 constexpr bool debug_print = false;
 #endif
+
+// Requests carry the cycles of each step through the memory hierarchy, which are collected into latency histograms
+#ifdef LATENCY_BREAKDOWN
+constexpr bool track_latency = true;
+#else
+constexpr bool track_latency = false;
+#endif
 } // namespace champsim
 
 #endif
@@ -26,6 +26,9 @@
 
 #include <string_view>
 
+#include "event_trace.h"
+#include "request_timeline.h"
+
 struct ooo_model_instr;
 
 enum class access_type : unsigned {
@@ -79,6 +82,8 @@ class channel
     uint64_t instr_id = 0;
     uint64_t ip = 0;
 
+    request_timeline timeline{};
+
     std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
   };
 
@@ -87,6 +92,7 @@ class channel
     uint64_t v_address;
     uint64_t data;
     uint32_t pf_metadata = 0;
+    uint8_t miss_depth = 0; // number of cache levels that missed before this response was produced
     std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
 
     response(uint64_t addr, uint64_t v_addr, uint64_t data_, uint32_t pf_meta, std::vector<std::reference_wrapper<ooo_model_instr>> deps)
@@ -115,6 +121,9 @@ public:
 
   stats_type sim_stats{}, roi_stats{};
 
+  // The requests added to this channel are traced as events of the component that reads it
+  event_source event_trace{};
+
   channel() = default;
   channel(std::size_t rq_size, std::size_t pq_size, std::size_t wq_size, unsigned offset_bits, bool match_offset);
 
@@ -131,6 +140,9 @@ public:
   std::size_t pq_size() const;
 
   void check_collision();
+
+  // Stamp the requests that have arrived since the last call with the cycle of the component that reads this channel
+  void mark_arrivals(uint64_t cycle);
 };
 } // namespace champsim
 
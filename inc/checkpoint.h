@@ -0,0 +1,160 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace champsim
+{
+struct environment;
+class tracereader;
+
+struct checkpoint_options {
+  std::string save_file{};    // written at the end of the warmup
+  std::string restore_file{}; // read before the first phase, replacing the warmup
+  std::string llc_warmup_file{}; // if given, the last-level caches are not restored, but warmed with the warmup accesses captured in this file
+};
+
+namespace checkpoint
+{
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T> && !std::is_array_v<T>>>
+void write(std::ostream& os, const T& value)
+{
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void write(std::ostream& os, const std::vector<T>& values)
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  write(os, std::size(values));
+  os.write(reinterpret_cast<const char*>(std::data(values)), static_cast<std::streamsize>(std::size(values) * sizeof(T)));
+}
+
+/**
+ * Write the count values that begin at values, such as a table allocated with new[].
+ */
+template <typename T>
+void write_array(std::ostream& os, const T* values, std::size_t count)
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  write(os, count);
+  os.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+inline void write(std::ostream& os, std::string_view str)
+{
+  write(os, std::size(str));
+  os.write(std::data(str), static_cast<std::streamsize>(std::size(str)));
+}
+
+template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T> && !std::is_array_v<T>>>
+void read(std::istream& is, T& value)
+{
+  is.read(reinterpret_cast<char*>(&value), sizeof(T));
+  if (!is)
+    throw std::runtime_error("Checkpoint ended unexpectedly");
+}
+
+template <typename T>
+void read(std::istream& is, std::vector<T>& values)
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  std::size_t size = 0;
+  read(is, size);
+  values.resize(size);
+  is.read(reinterpret_cast<char*>(std::data(values)), static_cast<std::streamsize>(size * sizeof(T)));
+  if (!is)
+    throw std::runtime_error("Checkpoint ended unexpectedly");
+}
+
+/**
+ * Read the values written by write_array() into a table of the same size.
+ */
+template <typename T>
+void read_array(std::istream& is, T* values, std::size_t count)
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  std::size_t size = 0;
+  read(is, size);
+  if (size != count)
+    throw std::runtime_error("Checkpoint does not match this configuration: expected a table of " + std::to_string(count) + " entries, found "
+                             + std::to_string(size));
+  is.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+  if (!is)
+    throw std::runtime_error("Checkpoint ended unexpectedly");
+}
+
+inline void read(std::istream& is, std::string& str)
+{
+  std::size_t size = 0;
+  read(is, size);
+  str.resize(size);
+  is.read(std::data(str), static_cast<std::streamsize>(size));
+  if (!is)
+    throw std::runtime_error("Checkpoint ended unexpectedly");
+}
+
+/**
+ * Write a named, length-prefixed section. The contents are produced by calling func with a stream.
+ * Sections let a reader check that it is reading the element it expects, and skip the contents it does not use.
+ */
+template <typename F>
+void write_section(std::ostream& os, std::string_view name, F&& func)
+{
+  std::ostringstream contents;
+  func(contents);
+  write(os, name);
+  write(os, contents.str());
+}
+
+/**
+ * Read a section written by write_section(), and return a stream over its contents.
+ */
+inline std::istringstream read_section(std::istream& is, std::string_view name)
+{
+  std::string found_name, contents;
+  read(is, found_name);
+  if (found_name != name)
+    throw std::runtime_error("Checkpoint does not match this configuration: expected " + std::string{name} + ", found " + found_name);
+  read(is, contents);
+  return std::istringstream{contents};
+}
+
+/**
+ * Save the warmed state of the environment and the position of each hardware thread in its trace.
+ */
+void save(const std::string& fname, environment& env);
+
+/**
+ * Restore the state saved by save(). The traces are advanced past the instructions retired before the checkpoint was taken.
+ * If restore_llc is false, the last-level caches are left untouched, so that they can be warmed in some other way.
+ */
+void restore(const std::string& fname, environment& env, std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index, bool restore_llc);
+} // namespace checkpoint
+} // namespace champsim
+
+#endif
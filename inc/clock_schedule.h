@@ -0,0 +1,93 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CLOCK_SCHEDULE_H
+#define CLOCK_SCHEDULE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "operable.h"
+
+namespace champsim
+{
+/**
+ * The order in which elements of different clock domains operate on each cycle.
+ *
+ * The serial loop operates every element, then sorts them by their leap_operation, so that the elements that skipped the most recently go last.
+ * Because the clock scales are fixed, the orders repeat. This finds the period when the schedule is made, and replays it without sorting.
+ * Each element still keeps its own leap_operation and current_cycle, so the elements operate exactly as in the serial loop.
+ * If no period is found within max_period cycles, as when rounding keeps the scales from repeating, the elements are sorted each cycle as before,
+ * but by the leaps they have after the cycle, so that the caller of advance() may operate them later in the cycle.
+ */
+class clock_schedule
+{
+  struct step {
+    std::vector<std::reference_wrapper<operable>> due;  // operate on this cycle, in this order
+    std::vector<std::reference_wrapper<operable>> idle; // skip this cycle
+  };
+
+  std::vector<std::pair<double, std::reference_wrapper<operable>>> sorted; // the order of the serial loop, if no period was found
+  std::vector<step> steps{};
+  std::size_t loop_begin = 0;
+  std::size_t next_step = 0;
+
+public:
+  constexpr static std::size_t default_max_period = 4096;
+
+  clock_schedule() = default;
+  explicit clock_schedule(std::vector<std::reference_wrapper<operable>> operables, std::size_t max_period = default_max_period);
+
+  // Whether a period was found
+  bool periodic() const { return !std::empty(steps); }
+
+  // Call f with each element, in the order that it operates on this cycle, then move to the next cycle
+  template <typename F>
+  void advance(F&& f);
+
+  // Operate each element for one cycle, returning the progress
+  long operate();
+};
+
+template <typename F>
+void clock_schedule::advance(F&& f)
+{
+  if (!periodic()) {
+    // Sort by the leaps that the elements have after this cycle, as in operable::_operate(), since f need not operate them right away
+    for (auto& [leap, elem] : sorted) {
+      operable& op = elem;
+      leap = (op.leap_operation >= 1) ? op.leap_operation - 1 : op.leap_operation + op.CLOCK_SCALE;
+      f(op);
+    }
+    std::sort(std::begin(sorted), std::end(sorted), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    return;
+  }
+
+  const auto& current = steps[next_step];
+  for (operable& op : current.due)
+    f(op);
+  for (operable& op : current.idle)
+    f(op);
+
+  if (++next_step == std::size(steps))
+    next_step = loop_begin;
+}
+} // namespace champsim
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DECODE_THREADS_H
+#define DECODE_THREADS_H
+
+#include <atomic>
+
+namespace champsim
+{
+// The number of host threads that decompress each trace, for the formats that can be decompressed in parallel. Every trace has its own
+// threads, so this is kept small to leave the host's cores to the other traces and to the simulation.
+inline std::atomic<unsigned> decode_threads{2};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DECODED_TRACE_H
+#define DECODED_TRACE_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "instruction.h"
+#include "trace_instruction.h"
+
+namespace champsim
+{
+/*
+ * A pre-decoded trace is a header followed by fixed-size decoded_instr records, uncompressed, so that it can be mapped into memory and read
+ * without decompressing or decoding. The records are stored in the byte order of the host that wrote them.
+ */
+struct decoded_trace_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t flags;
+  uint32_t reserved;
+  uint64_t count;
+};
+
+constexpr uint32_t DECODED_TRACE_VERSION = 1;
+constexpr uint32_t DECODED_TRACE_ASID_FROM_TRACE = 1; // the address space identifiers come from the trace, rather than from the core that reads it
+
+decoded_instr encode(const ooo_model_instr& instr);
+
+/**
+ * Write a pre-decoded trace. The header is completed when the writer is closed.
+ */
+class decoded_trace_writer
+{
+  std::ostream& out;
+  uint32_t flags;
+  uint64_t count = 0;
+
+public:
+  decoded_trace_writer(std::ostream& os, bool asid_from_trace);
+
+  void write(const ooo_model_instr& instr);
+  void close();
+};
+
+/**
+ * Read a pre-decoded trace from a read-only memory mapping of the file.
+ * If sequential is set, the kernel is advised that the trace will be read in order, so that it reads ahead and releases the pages behind.
+ */
+class decoded_tracereader
+{
+  struct unmapper {
+    std::size_t length;
+    void operator()(const char* addr) const;
+  };
+
+  uint8_t cpu;
+  std::unique_ptr<const char, unmapper> mapping;
+  uint64_t count = 0;
+  uint64_t next = 0;
+  bool asid_from_trace = false;
+
+public:
+  decoded_tracereader(uint8_t cpu_idx, std::string fname, bool sequential = true);
+
+  ooo_model_instr operator()();
+  bool eof() const { return next >= count; }
+  uint64_t skip(uint64_t skip_count);
+};
+} // namespace champsim
+
+#endif
@@ -25,13 +25,45 @@
 
 #include "champsim_constants.h"
 #include "channel.h"
+#include "latency_histograms.h"
 #include "operable.h"
 
+// The steps of a request through the memory controller, measured between the events of its timeline
+enum class dram_hop : unsigned {
+  QUEUE = 0, // waiting to be scheduled to its bank
+  ACTIVATE,  // precharging and activating its row, on a row buffer miss
+  CAS,       // the column access
+  BUS,       // waiting for the data bus
+  TRANSFER,  // the burst on the data bus
+  TOTAL,     // from the channel until the transfer finished
+  NUM_HOPS
+};
+
+inline constexpr std::array<std::string_view, static_cast<std::size_t>(dram_hop::NUM_HOPS)> dram_hop_names{"QUEUE"sv, "ACTIVATE"sv, "CAS"sv, "BUS"sv, "TRANSFER"sv,
+                                                                                                           "TOTAL"sv};
+
 struct dram_stats {
   std::string name{};
   uint64_t dbus_cycle_congested = 0, dbus_count_congested = 0;
 
   unsigned WQ_ROW_BUFFER_HIT = 0, WQ_ROW_BUFFER_MISS = 0, RQ_ROW_BUFFER_HIT = 0, RQ_ROW_BUFFER_MISS = 0, WQ_FULL = 0;
+
+  // The cycles of the channel, and those in which its data bus carried a block
+  uint64_t cycles = 0, dbus_cycle_busy = 0;
+  uint64_t switches_to_write = 0, switches_to_read = 0;
+  std::array<uint64_t, DRAM_RANKS * DRAM_BANKS> bank_activations{};
+
+  // The number of cycles in which each queue held each number of requests
+  std::array<uint64_t, DRAM_RQ_SIZE + 1> rq_occupancy{};
+  std::array<uint64_t, DRAM_WQ_SIZE + 1> wq_occupancy{};
+
+  champsim::latency_histograms<dram_hop> latency{};
+
+  uint64_t blocks() const { return uint64_t{WQ_ROW_BUFFER_HIT} + WQ_ROW_BUFFER_MISS + RQ_ROW_BUFFER_HIT + RQ_ROW_BUFFER_MISS; }
+  double dbus_utilization() const { return std::ceil(dbus_cycle_busy) / std::ceil(cycles); }
+
+  // The channel runs at the I/O frequency, in MHz
+  double bandwidth_gbps() const { return std::ceil(blocks() * BLOCK_SIZE) * std::ceil(DRAM_IO_FREQ) / std::ceil(cycles) / 1000; }
 };
 
 struct DRAM_CHANNEL {
@@ -41,14 +73,18 @@ struct DRAM_CHANNEL {
     bool forward_checked = false;
 
     uint8_t asid[2] = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
+    access_type type{access_type::LOAD};
 
     uint32_t pf_metadata = 0;
 
     uint64_t address = 0;
     uint64_t v_address = 0;
     uint64_t data = 0;
+    uint64_t instr_id = 0;
     uint64_t event_cycle = std::numeric_limits<uint64_t>::max();
 
+    champsim::request_timeline timeline{};
+
     std::vector<std::reference_wrapper<ooo_model_instr>> instr_depend_on_me{};
     std::vector<std::deque<response_type>*> to_return{};
 
@@ -98,12 +134,16 @@ class MEMORY_CONTROLLER : public champsim::operable
   constexpr static std::size_t MIN_DRAM_WRITES_PER_SWITCH = ((DRAM_WQ_SIZE * 1) >> 2); // 1/4
 
   void initiate_requests();
+  void record_latency(DRAM_CHANNEL& channel, const DRAM_CHANNEL::request_type& pkt);
   bool add_rq(const request_type& pkt, champsim::channel* ul);
   bool add_wq(const request_type& pkt);
 
 public:
   std::array<DRAM_CHANNEL, DRAM_CHANNELS> channels;
 
+  // If attached to a tracer, the scheduling of each request is recorded
+  champsim::event_source event_trace{};
+
   MEMORY_CONTROLLER(double freq_scale, int io_freq, double t_rp, double t_rcd, double t_cas, double turnaround, std::vector<channel_type*>&& ul);
 
   void initialize() override final;
@@ -113,6 +153,7 @@ public:
   void print_deadlock() override final;
 
   std::size_t size() const;
+  const std::vector<channel_type*>& upper_level_channels() const { return queues; }
 
   uint32_t dram_get_channel(uint64_t address);
   uint32_t dram_get_rank(uint64_t address);
@@ -17,7 +17,9 @@
 #ifndef ENVIRONMENT_H
 #define ENVIRONMENT_H
 
+#include <algorithm>
 #include <functional>
+#include <string>
 #include <vector>
 
 #include "cache.h"
@@ -29,12 +31,27 @@
 namespace champsim
 {
 struct environment {
+  virtual ~environment() = default;
+
   virtual std::vector<std::reference_wrapper<O3_CPU>> cpu_view() = 0;
   virtual std::vector<std::reference_wrapper<CACHE>> cache_view() = 0;
   virtual std::vector<std::reference_wrapper<PageTableWalker>> ptw_view() = 0;
   virtual MEMORY_CONTROLLER& dram_view() = 0;
   virtual std::vector<std::reference_wrapper<operable>> operable_view() = 0;
+
+  // The modules of the system that may keep state shared between their instances, which are not safe to operate from several host threads
+  virtual std::vector<std::string> modules_with_shared_state() const { return {}; }
+
+  // The modules of the system that do not save their state in checkpoints, which prevent the system from using them
+  virtual std::vector<std::string> modules_without_checkpoint_hooks() const { return {}; }
 };
+
+// The last-level caches are those that send their misses to DRAM
+inline bool is_last_level(const CACHE& cache, const MEMORY_CONTROLLER& dram)
+{
+  const auto& dram_uls = dram.upper_level_channels();
+  return std::find(std::begin(dram_uls), std::end(dram_uls), cache.lower_level) != std::end(dram_uls);
+}
 } // namespace champsim
 
 #endif
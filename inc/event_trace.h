@@ -0,0 +1,132 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "operable.h"
+
+namespace champsim
+{
+struct environment;
+
+// The events in the life of a packet that can be traced
+enum class packet_event : uint8_t {
+  ADD_RQ = 0,    // added to the read queue of a channel
+  ADD_WQ,        // added to the write queue of a channel
+  ADD_PQ,        // added to the prefetch queue of a channel
+  PREFETCH,      // issued by the prefetcher of a cache
+  TAG_CHECK,     // started its tag check
+  HIT,           // hit in a cache
+  MISS,          // missed in a cache, and was sent to the lower level
+  MSHR_MERGE,    // merged with a miss already in flight
+  FILL,          // filled into a cache
+  EVICT,         // evicted a block from a cache
+  DRAM_SCHEDULE, // scheduled to a DRAM bank
+  NUM_EVENTS
+};
+
+struct trace_event {
+  uint64_t time = 0;  // in cycles of the fastest clock, so that the components can be compared
+  uint64_t cycle = 0; // in the clock of the component
+  uint64_t address = 0;
+  uint64_t instr_id = 0;
+  uint64_t location = 0; // the way of a fill or an eviction, or the bank of a DRAM schedule
+  uint64_t detail = 0;   // the address evicted by an eviction, or whether a DRAM schedule hit the open row
+  uint32_t component = 0;
+  packet_event what{};
+  uint8_t type = 0;
+};
+
+/**
+ * Record the events of the packets that pass a filter into a buffer of fixed size, keeping the most recent.
+ * The events are written in the Chrome trace event format, to be viewed in Perfetto or chrome://tracing, with one track for each component.
+ */
+class event_tracer
+{
+public:
+  // Each range includes its beginning and excludes its end
+  struct filter_type {
+    std::pair<uint64_t, uint64_t> addresses{0, std::numeric_limits<uint64_t>::max()};
+    std::pair<uint64_t, uint64_t> times{0, std::numeric_limits<uint64_t>::max()};
+    std::pair<uint64_t, uint64_t> instr_ids{0, std::numeric_limits<uint64_t>::max()};
+
+    bool matches(const trace_event& event) const;
+  };
+
+  constexpr static std::size_t default_capacity = 1 << 20;
+
+private:
+  struct component_type {
+    std::string name;
+    const operable* clock;
+  };
+
+  filter_type filter;
+  std::vector<trace_event> ring;
+  std::size_t next = 0;
+  uint64_t recorded = 0;
+  std::vector<component_type> components{};
+
+public:
+  explicit event_tracer(filter_type filter, std::size_t capacity = default_capacity);
+
+  // Add a track, whose events are timed by the given clock
+  uint32_t add_component(std::string name, const operable& clock);
+
+  void record(uint32_t component, packet_event what, uint64_t address, uint64_t instr_id, uint8_t type, uint64_t location, uint64_t detail);
+
+  // The events kept, oldest first
+  std::vector<trace_event> events() const;
+
+  // The number of events that passed the filter but were overwritten
+  uint64_t dropped() const;
+
+  void write_json(std::ostream& os) const;
+};
+
+/**
+ * The handle through which a component records its events. Without a tracer, recording is a single check.
+ */
+struct event_source {
+  event_tracer* tracer = nullptr;
+  uint32_t component = 0;
+
+  template <typename P>
+  void record(packet_event what, const P& pkt, uint64_t location = 0, uint64_t detail = 0) const
+  {
+    if (tracer != nullptr)
+      tracer->record(component, what, pkt.address, pkt.instr_id, static_cast<uint8_t>(pkt.type), location, detail);
+  }
+};
+
+// Record the events of each cache and DRAM controller of the environment, and of the channels they read
+void attach(event_tracer& tracer, environment& env);
+
+// Parse a range given as BEGIN:END, where each number may be decimal or hexadecimal
+std::optional<std::pair<uint64_t, uint64_t>> parse_range(std::string_view text);
+} // namespace champsim
+
+#endif
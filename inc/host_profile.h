@@ -0,0 +1,123 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HOST_PROFILE_H
+#define HOST_PROFILE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "operable.h"
+
+namespace champsim
+{
+struct environment;
+
+/**
+ * Measure where the host spends its time while simulating, and how fast it simulates.
+ *
+ * The wall time of each phase is measured as a whole. In the serial loop, one cycle in every sample period is also timed element by element,
+ * along with the reading of the traces on that cycle. The sampled times are scaled by the period to estimate the time of each part of the simulator,
+ * so that the clock is read only rarely. The cost of reading the clock is measured once and subtracted from each timing. Time not spent in the elements or the traces is reported as the rest of the loop.
+ */
+class host_profiler
+{
+public:
+  using clock_type = std::chrono::steady_clock;
+  using seconds = std::chrono::duration<double>;
+
+  constexpr static uint64_t default_sample_period = 64;
+
+  struct entry {
+    std::string name;
+    seconds time;
+  };
+
+private:
+  uint64_t sample_period;
+  uint64_t countdown = 0;
+  uint64_t cycles = 0;
+  uint64_t sampled_cycles = 0;
+  seconds clock_overhead{}; // of reading the clock once, subtracted from each timing
+
+  std::vector<const operable*> elements{};
+  std::vector<std::string> names{};
+  std::vector<seconds> element_time{};
+  seconds trace_time{};
+
+  seconds total_time{}; // of all phases
+  uint64_t total_instrs = 0;
+
+  std::string phase_name{};
+  clock_type::time_point phase_begin{};
+
+  std::size_t index_of(const operable& op);
+
+public:
+  explicit host_profiler(uint64_t sample_period = default_sample_period);
+
+  // Name the elements of the system, and start the clock of the phase
+  void begin_phase(std::string_view name, environment& env);
+
+  // Stop the clock of the phase, and print its speed
+  void end_phase(environment& env);
+
+  // Whether this cycle of the serial loop should be timed
+  bool sample()
+  {
+    ++cycles;
+    if (++countdown < sample_period)
+      return false;
+    countdown = 0;
+    ++sampled_cycles;
+    return true;
+  }
+
+  // Call f, adding its time to that of the element
+  template <typename F>
+  auto time(const operable& op, F&& f)
+  {
+    auto begin = clock_type::now();
+    auto result = f();
+    element_time.at(index_of(op)) += clock_type::now() - begin;
+    return result;
+  }
+
+  // Call f, adding its time to that of reading the traces
+  template <typename F>
+  auto time_traces(F&& f)
+  {
+    auto begin = clock_type::now();
+    auto result = f();
+    trace_time += clock_type::now() - begin;
+    return result;
+  }
+
+  // The estimated time of each element, of reading the traces, and of the rest of the loop, over all of the phases.
+  // Empty if no cycle was sampled, as when the cores are operated on several threads.
+  std::vector<entry> breakdown() const;
+
+  // The thousands of instructions, retired by all of the cores together, simulated per second over all of the phases
+  double kips() const;
+
+  void print() const;
+};
+} // namespace champsim
+
+#endif
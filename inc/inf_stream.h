@@ -17,13 +17,19 @@
 #ifndef INF_STREAM_H
 #define INF_STREAM_H
 
+#include <algorithm>
+#include <array>
 #include <bzlib.h>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <lzma.h>
 #include <memory>
 #include <zlib.h>
 
+#include "decode_threads.h"
+
 namespace champsim
 {
 namespace decomp_tags
@@ -169,7 +175,17 @@ struct lzma_tag_t {
   {
     inflate_state_type state{new state_type};
     *state = LZMA_STREAM_INIT;
+#if LZMA_VERSION >= 50040002
+    // Files of several blocks, such as those written by xz -T, are decoded on several threads. Others are decoded on one.
+    ::lzma_mt options{};
+    options.flags = flags;
+    options.threads = std::max(1u, champsim::decode_threads.load());
+    options.memlimit_threading = std::max<uint64_t>(::lzma_physmem() / 4, uint64_t{1} << 30);
+    options.memlimit_stop = std::numeric_limits<uint64_t>::max();
+    auto ret = ::lzma_stream_decoder_mt(state.get(), &options);
+#else
     auto ret = ::lzma_stream_decoder(state.get(), std::numeric_limits<uint64_t>::max(), flags);
+#endif
     assert(ret == LZMA_OK);
     return state;
   }
@@ -49,6 +49,7 @@ struct ooo_model_instr {
   bool branch_mispredicted = 0; // A branch can be mispredicted even if the direction prediction is correct when the predicted target is not correct
 
   std::array<uint8_t, 2> asid = {std::numeric_limits<uint8_t>::max(), std::numeric_limits<uint8_t>::max()};
+  uint8_t thread = 0; // hardware thread context within the core
 
   uint8_t branch_type = NOT_BRANCH;
   uint64_t branch_target = 0;
@@ -61,6 +62,7 @@ struct ooo_model_instr {
 
   unsigned completed_mem_ops = 0;
   int num_reg_dependent = 0;
+  uint8_t mem_miss_depth = 0; // deepest cache level missed by any of this instruction's loads
 
   std::vector<uint8_t> destination_registers = {}; // output registers
   std::vector<uint8_t> source_registers = {};      // input registers
@@ -134,6 +136,16 @@ public:
   ooo_model_instr(uint8_t cpu, input_instr instr) : ooo_model_instr(instr, {cpu, cpu}) {}
   ooo_model_instr(uint8_t, cloudsuite_instr instr) : ooo_model_instr(instr, {instr.asid[0], instr.asid[1]}) {}
 
+  // Pre-decoded instructions are already classified, and their branch targets set
+  ooo_model_instr(uint8_t, const decoded_instr& instr)
+      : ip(instr.ip), is_branch(instr.is_branch), branch_taken(instr.branch_taken), asid({instr.asid[0], instr.asid[1]}), branch_type(instr.branch_type),
+        branch_target(instr.branch_target), destination_registers(instr.destination_registers, instr.destination_registers + instr.num_destination_registers),
+        source_registers(instr.source_registers, instr.source_registers + instr.num_source_registers),
+        destination_memory(instr.destination_memory, instr.destination_memory + instr.num_destination_memory),
+        source_memory(instr.source_memory, instr.source_memory + instr.num_source_memory)
+  {
+  }
+
   std::size_t num_mem_ops() const { return std::size(destination_memory) + std::size(source_memory); }
 
   static bool program_order(const ooo_model_instr& lhs, const ooo_model_instr& rhs) { return lhs.instr_id < rhs.instr_id; }
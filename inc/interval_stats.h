@@ -0,0 +1,99 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INTERVAL_STATS_H
+#define INTERVAL_STATS_H
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cache.h"
+#include "channel.h"
+#include "dram_controller.h"
+#include "ooo_cpu.h"
+
+namespace champsim
+{
+struct environment;
+
+/**
+ * The statistics of the system over one interval of a phase.
+ * Each value counts only the events of the interval, so that the statistics of the intervals of a phase add up to those of the phase.
+ */
+struct interval_stats {
+  std::string phase;
+  uint64_t index = 0; // within the phase
+  std::vector<O3_CPU::stats_type> cpu_stats;
+  std::vector<CACHE::stats_type> cache_stats;
+  std::vector<channel::stats_type> cache_queue_stats; // the queues in front of each cache, summed, in the order of cache_stats
+  std::vector<DRAM_CHANNEL::stats_type> dram_stats;
+
+  uint64_t instrs() const;
+};
+
+// The statistics of the current phase so far
+interval_stats snapshot(environment& env);
+
+// The statistics between two snapshots of the same phase
+interval_stats difference(const interval_stats& now, const interval_stats& before);
+
+/**
+ * Write the statistics of the system every given number of instructions, retired by all of the cores together, as one JSON object per line.
+ * The lines are buffered and written in large blocks.
+ */
+class interval_stats_writer
+{
+  std::ofstream file;
+  std::ostringstream pending;
+  uint64_t interval;
+
+  std::string phase_name{};
+  uint64_t index = 0;
+  uint64_t next_boundary = 0;
+  interval_stats last{};
+  std::vector<std::reference_wrapper<O3_CPU>> cpus{};
+
+  void write_interval(environment& env);
+
+public:
+  constexpr static std::streamoff buffer_size = 1 << 20;
+
+  interval_stats_writer(std::string fname, uint64_t interval_instrs);
+  ~interval_stats_writer();
+
+  interval_stats_writer(const interval_stats_writer&) = delete;
+  interval_stats_writer& operator=(const interval_stats_writer&) = delete;
+
+  // Start counting intervals from the state of the system at the beginning of the phase
+  void begin_phase(std::string_view name, environment& env);
+
+  // Write an interval if the cores have retired enough instructions since the last
+  void operate(environment& env);
+
+  // Write what remains of the last interval of the phase
+  void end_phase(environment& env);
+
+  void write(const interval_stats& stats);
+  void flush();
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LATENCY_HISTOGRAMS_H
+#define LATENCY_HISTOGRAMS_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "champsim.h"
+#include "channel.h"
+
+namespace champsim
+{
+// Bucket 0 holds a value of zero, bucket i holds values in [2^(i-1), 2^i), and the last bucket holds the remainder
+inline std::size_t log2_bucket(uint64_t value, std::size_t num_buckets)
+{
+  std::size_t result = 0;
+  for (; value > 0 && result < num_buckets - 1; value >>= 1)
+    ++result;
+  return result;
+}
+
+/**
+ * The latencies of the steps that requests take through a component, by access type and step H.
+ * The latencies are counted in the buckets of log2_bucket().
+ * Unless the breakdown is compiled in, the arrays are empty and nothing is recorded.
+ */
+template <typename H, bool Enabled = track_latency>
+struct latency_histograms {
+  constexpr static std::size_t num_buckets = 16;
+  constexpr static std::size_t num_types = Enabled ? static_cast<std::size_t>(access_type::NUM_TYPES) : 0;
+  constexpr static std::size_t num_hops = static_cast<std::size_t>(H::NUM_HOPS);
+
+  using histogram_type = std::array<uint64_t, num_buckets>;
+
+  std::array<std::array<histogram_type, num_hops>, num_types> buckets = {};
+  std::array<std::array<uint64_t, num_hops>, num_types> total_cycles = {};
+
+  static std::size_t bucket(uint64_t cycles) { return log2_bucket(cycles, num_buckets); }
+
+  void record(access_type type, H hop, std::optional<uint64_t> cycles)
+  {
+    if constexpr (Enabled) {
+      if (cycles.has_value()) {
+        auto& counts = buckets[static_cast<std::size_t>(type)][static_cast<std::size_t>(hop)];
+        ++counts[bucket(cycles.value())];
+        total_cycles[static_cast<std::size_t>(type)][static_cast<std::size_t>(hop)] += cycles.value();
+      }
+    }
+  }
+
+  uint64_t count(std::size_t type, std::size_t hop) const
+  {
+    uint64_t result = 0;
+    for (auto x : buckets.at(type).at(hop))
+      result += x;
+    return result;
+  }
+
+  bool empty() const
+  {
+    for (std::size_t type = 0; type < num_types; ++type)
+      for (std::size_t hop = 0; hop < num_hops; ++hop)
+        if (count(type, hop) > 0)
+          return false;
+    return true;
+  }
+};
+
+// The latencies recorded between two sets of histograms from the same component
+template <typename H, bool Enabled>
+latency_histograms<H, Enabled> difference(const latency_histograms<H, Enabled>& now, const latency_histograms<H, Enabled>& before)
+{
+  auto result = now;
+  for (std::size_t type = 0; type < result.num_types; ++type) {
+    for (std::size_t hop = 0; hop < result.num_hops; ++hop) {
+      for (std::size_t i = 0; i < result.num_buckets; ++i)
+        result.buckets[type][hop][i] -= before.buckets[type][hop][i];
+      result.total_cycles[type][hop] -= before.total_cycles[type][hop];
+    }
+  }
+  return result;
+}
+} // namespace champsim
+
+#endif
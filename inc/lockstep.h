@@ -0,0 +1,152 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "clock_schedule.h"
+#include "environment.h"
+#include "operable.h"
+#include "tracereader.h"
+
+namespace champsim
+{
+struct lockstep_options {
+  std::size_t jobs = 1;  // host threads; 1 runs the simulation serially
+  uint64_t quantum = 1; // cycles each core runs between synchronizations with the shared hierarchy
+};
+
+/**
+ * Read from the traces until each of the core's thread contexts has a full input queue.
+ * Returns true if any of the traces reached its end.
+ */
+bool refill_input_queues(O3_CPU& cpu, std::size_t first_context, std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index);
+
+/**
+ * A fixed set of host threads that run a task together and wait for each other to finish.
+ * The calling thread acts as worker 0. A thread that is waiting spins briefly, since the next task usually follows soon, and then sleeps
+ * until it is woken, so that the helpers do not hold their host cores while the calling thread works alone.
+ */
+class worker_pool
+{
+  std::vector<std::thread> helpers;
+  std::atomic<uint64_t> generation{0};
+  std::atomic<std::size_t> remaining{0};
+  std::atomic<bool> stopping{false};
+
+  void* task_context = nullptr;
+  void (*task_fn)(void*, std::size_t) = nullptr;
+
+  // A sleeper announces itself before it checks its condition, and a waker publishes its change before it checks for sleepers.
+  // With sequentially consistent stores and loads, at least one of them sees the other, so no wakeup is lost.
+  std::mutex mutex;
+  std::condition_variable task_ready;
+  std::condition_variable task_done;
+  std::atomic<std::size_t> helpers_sleeping{0};
+  std::atomic<std::size_t> caller_sleeping{0};
+
+  template <typename Pred>
+  void wait_until(std::condition_variable& cv, std::atomic<std::size_t>& sleeping, Pred pred);
+  void wake(std::condition_variable& cv, const std::atomic<std::size_t>& sleeping);
+
+  void helper_loop(std::size_t index);
+
+public:
+  explicit worker_pool(std::size_t num_workers);
+  ~worker_pool();
+
+  worker_pool(const worker_pool&) = delete;
+  worker_pool& operator=(const worker_pool&) = delete;
+
+  std::size_t size() const { return std::size(helpers) + 1; }
+
+  template <typename F>
+  void run(F& func)
+  {
+    task_context = &func;
+    task_fn = [](void* ctx, std::size_t worker) { (*static_cast<F*>(ctx))(worker); };
+    run_task();
+  }
+
+private:
+  void run_task();
+};
+
+/**
+ * Operates the environment with each core's private hierarchy on its own host thread.
+ *
+ * An operable belongs to a core's domain if the core is the only one that reaches it through the channels below it. Everything else
+ * (the shared caches, the page table walkers, which allocate from the shared virtual memory, and DRAM) is operated on the calling thread
+ * while the domains are stopped, so every channel is only ever accessed by one host thread at a time and the results do not depend on
+ * host scheduling. This holds only if the modules keep their state for each instance, so the simulator refuses more than one job for a
+ * system with any module that does not (see environment::modules_with_shared_state()).
+ *
+ * With a quantum of 1, each cycle operates the elements in the same order as the serial loop, and the results are identical to it. With a
+ * larger quantum, each domain runs the whole quantum before the shared elements catch up, so requests crossing into the shared hierarchy
+ * can be delayed by up to a quantum.
+ */
+class lockstep_executor
+{
+  struct domain {
+    O3_CPU* cpu;
+    std::size_t first_context;
+    std::vector<std::reference_wrapper<operable>> operables;
+    clock_schedule schedule{};
+    std::vector<operable*> pending;
+    long progress = 0;
+    bool trace_ended = false;
+  };
+
+  std::vector<domain> domains;
+  std::vector<std::reference_wrapper<operable>> operables;
+  std::vector<std::reference_wrapper<operable>> shared_operables;
+  clock_schedule serial_schedule{};
+  clock_schedule shared_schedule{};
+  std::vector<std::pair<operable*, domain*>> owner;
+  const uint64_t quantum;
+  worker_pool pool;
+
+  domain* owner_of(const operable& op) const;
+  long operate_cycle(std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index);
+  long operate_quantum(std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index);
+  void flush_pending(bool refill, std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index);
+
+public:
+  lockstep_executor(environment& env, lockstep_options options);
+
+  /**
+   * Operate every element for one quantum and refill the input queues.
+   * Returns the progress made and whether any trace reached its end.
+   */
+  std::pair<long, bool> operate(std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index);
+
+  /**
+   * The number of cycles that each call to operate() advances.
+   */
+  uint64_t cycles_per_operate() const { return quantum; }
+};
+} // namespace champsim
+
+#endif
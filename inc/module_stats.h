@@ -0,0 +1,80 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_STATS_H
+#define MODULE_STATS_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * The values of the statistics registered by the modules of a cache or core, in the order they were registered.
+ */
+struct module_stats {
+  std::vector<std::pair<std::string, uint64_t>> counters{};
+  std::vector<std::pair<std::string, std::vector<uint64_t>>> histograms{};
+
+  bool empty() const { return std::empty(counters) && std::empty(histograms); }
+};
+
+/**
+ * The counters and histograms that the modules of a cache or core keep, by name, so that they are reported with the statistics of their owner.
+ * The values remain in the module, which updates them as it always has. Each is zeroed at the beginning of every phase, so a module
+ * should register only its statistics, and not the state that it acts on.
+ */
+class module_stats_registry
+{
+  struct histogram_entry {
+    std::string name;
+    uint64_t* buckets;
+    std::size_t size;
+  };
+
+  std::vector<std::pair<std::string, uint64_t*>> counters;
+  std::vector<histogram_entry> histograms;
+
+public:
+  void add_counter(std::string name, uint64_t& counter);
+  void add_histogram(std::string name, uint64_t* buckets, std::size_t size);
+
+  template <std::size_t N>
+  void add_histogram(std::string name, uint64_t (&buckets)[N])
+  {
+    add_histogram(std::move(name), buckets, N);
+  }
+
+  template <std::size_t N>
+  void add_histogram(std::string name, std::array<uint64_t, N>& buckets)
+  {
+    add_histogram(std::move(name), std::data(buckets), N);
+  }
+
+  // Zero every registered value
+  void reset();
+
+  module_stats values() const;
+};
+
+// The statistics between two sets of values from the same registry
+module_stats difference(const module_stats& now, const module_stats& before);
+} // namespace champsim
+
+#endif
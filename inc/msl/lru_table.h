@@ -20,7 +20,11 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <istream>
 #include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -128,6 +132,32 @@ public:
     return std::exchange(*hit, {}).data;
   }
 
+  // Write the table's contents as raw bytes, for checkpoints
+  void save(std::ostream& os) const
+  {
+    static_assert(std::is_trivially_copyable_v<value_type>);
+    os.write(reinterpret_cast<const char*>(&NUM_SET), sizeof(NUM_SET));
+    os.write(reinterpret_cast<const char*>(&NUM_WAY), sizeof(NUM_WAY));
+    os.write(reinterpret_cast<const char*>(&access_count), sizeof(access_count));
+    os.write(reinterpret_cast<const char*>(std::data(block)), static_cast<std::streamsize>(std::size(block) * sizeof(block_t)));
+  }
+
+  // Read contents written by save() into a table of the same dimensions
+  void restore(std::istream& is)
+  {
+    static_assert(std::is_trivially_copyable_v<value_type>);
+    std::size_t sets = 0, ways = 0;
+    is.read(reinterpret_cast<char*>(&sets), sizeof(sets));
+    is.read(reinterpret_cast<char*>(&ways), sizeof(ways));
+    if (!is || sets != NUM_SET || ways != NUM_WAY)
+      throw std::runtime_error("Saved table does not match the dimensions of this table");
+
+    is.read(reinterpret_cast<char*>(&access_count), sizeof(access_count));
+    is.read(reinterpret_cast<char*>(std::data(block)), static_cast<std::streamsize>(std::size(block) * sizeof(block_t)));
+    if (!is)
+      throw std::runtime_error("Saved table ended unexpectedly");
+  }
+
   lru_table(std::size_t sets, std::size_t ways, SetProj set_proj, TagProj tag_proj)
       : set_projection(set_proj), tag_projection(tag_proj), NUM_SET(sets), NUM_WAY(ways)
   {
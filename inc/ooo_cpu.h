@@ -24,7 +24,9 @@
 
 #include <array>
 #include <bitset>
+#include <chrono>
 #include <deque>
+#include <iosfwd>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -37,6 +39,7 @@
 #include "channel.h"
 #include "instruction.h"
 #include "module_impl.h"
+#include "module_stats.h"
 #include "operable.h"
 #include "util/lru_table.h"
 #include <type_traits>
@@ -57,8 +60,10 @@ class CacheBus
 
 public:
   CacheBus(uint32_t cpu_idx, champsim::channel* ll) : lower_level(ll), cpu(cpu_idx) {}
+  const channel_type* lower_level_channel() const { return lower_level; }
   bool issue_read(request_type packet);
   bool issue_write(request_type packet);
+  bool issue_prefetch(request_type packet);
 };
 
 struct cpu_stats {
@@ -70,8 +75,21 @@ struct cpu_stats {
   std::array<long long, 8> total_branch_types = {};
   std::array<long long, 8> branch_type_misses = {};
 
+  // Top-down classification of every cycle
+  uint64_t retiring_cycles = 0;
+  uint64_t frontend_l1i_cycles = 0, frontend_other_cycles = 0;
+  uint64_t bad_speculation_cycles = 0;
+  uint64_t backend_core_cycles = 0;
+  std::array<uint64_t, 4> backend_memory_cycles = {}; // indexed by the level that served the load: L1D, L2C, LLC, DRAM
+
+  // Instructions retired by each hardware thread context
+  std::vector<uint64_t> thread_begin_instrs{}, thread_end_instrs{};
+
+  champsim::module_stats modules{}; // registered by the branch predictor and BTB
+
   uint64_t instrs() const { return end_instrs - begin_instrs; }
   uint64_t cycles() const { return end_cycles - begin_cycles; }
+  uint64_t thread_instrs(std::size_t thread) const { return thread_end_instrs.at(thread) - thread_begin_instrs.at(thread); }
 };
 
 struct LSQ_ENTRY {
@@ -87,7 +105,7 @@ struct LSQ_ENTRY {
   std::vector<std::reference_wrapper<std::optional<LSQ_ENTRY>>> lq_depend_on_me{};
 
   LSQ_ENTRY(uint64_t id, uint64_t addr, uint64_t ip, std::array<uint8_t, 2> asid);
-  void finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const;
+  std::deque<ooo_model_instr>::iterator finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const;
 };
 
 // cpu
@@ -103,6 +121,7 @@ public:
   uint64_t finish_phase_instr = 0;
   uint64_t last_heartbeat_cycle = 0;
   uint64_t last_heartbeat_instr = 0;
+  std::chrono::steady_clock::time_point last_heartbeat_time = std::chrono::steady_clock::now();
   uint64_t next_print_instruction = STAT_PRINTING_PERIOD;
 
   // instruction
@@ -114,6 +133,9 @@ public:
 
   stats_type roi_stats{}, sim_stats{};
 
+  // The statistics of the branch predictor and BTB, reported with those of the core
+  champsim::module_stats_registry stats_registry{};
+
   // instruction buffer
   struct dib_shift {
     std::size_t shamt;
@@ -131,7 +153,30 @@ public:
   std::vector<std::optional<LSQ_ENTRY>> LQ;
   std::deque<LSQ_ENTRY> SQ;
 
-  std::array<std::vector<std::reference_wrapper<ooo_model_instr>>, std::numeric_limits<uint8_t>::max() + 1> reg_producers;
+  // hardware thread contexts, which share the pipeline above
+  struct thread_context {
+    std::deque<ooo_model_instr> input_queue;
+
+    // branch
+    uint64_t fetch_resume_cycle = 0;
+
+    // instructions fetched but not yet executed, for the ICOUNT fetch policy
+    std::size_t icount = 0;
+
+    uint64_t num_retired = 0;
+    uint64_t begin_phase_instr = 0;
+
+    // rename map: the youngest scheduled, not-yet-completed producer of each architectural register
+    std::array<ooo_model_instr*, std::numeric_limits<uint8_t>::max() + 1> reg_producers{};
+
+    uint64_t sim_instr() const { return num_retired - begin_phase_instr; }
+  };
+  std::vector<thread_context> threads;
+
+  enum class fetch_policy_type { ROUND_ROBIN, ICOUNT };
+  const fetch_policy_type FETCH_POLICY;
+  std::size_t last_fetch_thread = 0;
+  uint64_t next_instr_id = 0;
 
   // Constants
   const std::size_t IFETCH_BUFFER_SIZE, DISPATCH_BUFFER_SIZE, DECODE_BUFFER_SIZE, ROB_SIZE, SQ_SIZE;
@@ -140,21 +185,36 @@ public:
   const long int RETIRE_WIDTH;
   const unsigned BRANCH_MISPREDICT_PENALTY, DISPATCH_LATENCY, DECODE_LATENCY, SCHEDULING_LATENCY, EXEC_LATENCY;
   const long int L1I_BANDWIDTH, L1D_BANDWIDTH;
+  const std::size_t FTQ_SIZE;
 
-  // branch
-  uint64_t fetch_resume_cycle = 0;
+  // cycles the current ROB head has spent waiting on memory, attributed when it retires
+  uint64_t head_memory_stall_cycles = 0;
 
   const long IN_QUEUE_SIZE = 2 * FETCH_WIDTH;
-  std::deque<ooo_model_instr> input_queue;
+
+  // fetch-directed instruction prefetching: when FTQ_SIZE is nonzero, the branch predictor runs ahead of fetch into the FTQ,
+  // and the cache blocks spanned by the predicted instructions are prefetched into the L1I
+  struct ftq_block {
+    uint64_t block;
+    std::size_t num_instrs;
+    bool prefetch_issued = false;
+  };
+  std::deque<ooo_model_instr> FTQ;
+  std::deque<ftq_block> FTQ_BLOCKS;
 
   CacheBus L1I_bus, L1D_bus;
   CACHE* l1i;
 
+  void add_input(std::size_t thread, ooo_model_instr instr);
+
   void initialize() override final;
   long operate() override final;
   void begin_phase() override final;
   void end_phase(unsigned cpu) override final;
 
+  std::vector<thread_context>::iterator select_fetch_thread();
+  void predict_fetch_targets();
+  long prefetch_fetch_targets();
   void initialize_instruction();
   long check_dib();
   long fetch_instruction();
@@ -167,6 +227,7 @@ public:
   long complete_inflight_instruction();
   long handle_memory_return();
   long retire_rob();
+  void account_cycle(long retired);
 
   bool do_init_instruction(ooo_model_instr& instr);
   bool do_predict_branch(ooo_model_instr& instr);
@@ -177,6 +238,7 @@ public:
   void do_execution(ooo_model_instr& rob_it);
   void do_memory_scheduling(ooo_model_instr& instr);
   void do_complete_execution(ooo_model_instr& instr);
+  void do_attribute_memory_stall(const ooo_model_instr& instr);
   void do_sq_forward_to_lq(LSQ_ENTRY& sq_entry, LSQ_ENTRY& lq_entry);
 
   void do_finish_store(const LSQ_ENTRY& sq_entry);
@@ -190,6 +252,9 @@ public:
 
   void print_deadlock() override final;
 
+  void save_checkpoint(std::ostream& os);
+  void restore_checkpoint(std::istream& is);
+
 #include "ooo_cpu_module_decl.inc"
 
   struct module_concept {
@@ -202,6 +267,11 @@ public:
     virtual void impl_initialize_btb() = 0;
     virtual void impl_update_btb(uint64_t ip, uint64_t predicted_target, uint8_t taken, uint8_t branch_type) = 0;
     virtual std::pair<uint64_t, uint8_t> impl_btb_prediction(uint64_t ip) = 0;
+
+    virtual void impl_branch_predictor_save_state(std::ostream& os) = 0;
+    virtual void impl_branch_predictor_restore_state(std::istream& is) = 0;
+    virtual void impl_btb_save_state(std::ostream& os) = 0;
+    virtual void impl_btb_restore_state(std::istream& is) = 0;
   };
 
   template <unsigned long long B_FLAG, unsigned long long T_FLAG>
@@ -216,6 +286,11 @@ public:
     void impl_initialize_btb();
     void impl_update_btb(uint64_t ip, uint64_t predicted_target, uint8_t taken, uint8_t branch_type);
     std::pair<uint64_t, uint8_t> impl_btb_prediction(uint64_t ip);
+
+    void impl_branch_predictor_save_state(std::ostream& os);
+    void impl_branch_predictor_restore_state(std::istream& is);
+    void impl_btb_save_state(std::ostream& os);
+    void impl_btb_restore_state(std::istream& is);
   };
 
   std::unique_ptr<module_concept> module_pimpl;
@@ -234,6 +309,11 @@ public:
   }
   std::pair<uint64_t, uint8_t> impl_btb_prediction(uint64_t ip) { return module_pimpl->impl_btb_prediction(ip); }
 
+  void impl_branch_predictor_save_state(std::ostream& os) { module_pimpl->impl_branch_predictor_save_state(os); }
+  void impl_branch_predictor_restore_state(std::istream& is) { module_pimpl->impl_branch_predictor_restore_state(is); }
+  void impl_btb_save_state(std::ostream& os) { module_pimpl->impl_btb_save_state(os); }
+  void impl_btb_restore_state(std::istream& is) { module_pimpl->impl_btb_restore_state(is); }
+
   class builder_conversion_tag
   {
   };
@@ -266,6 +346,9 @@ public:
     unsigned m_dispatch_latency{};
     unsigned m_schedule_latency{};
     unsigned m_execute_latency{};
+    std::size_t m_ftq_size{};
+    std::size_t m_threads{1};
+    fetch_policy_type m_fetch_policy{fetch_policy_type::ROUND_ROBIN};
 
     CACHE* m_l1i{};
     long int m_l1i_bw{};
@@ -284,7 +367,7 @@ public:
           m_schedule_width(other.m_schedule_width), m_execute_width(other.m_execute_width), m_lq_width(other.m_lq_width), m_sq_width(other.m_sq_width),
           m_retire_width(other.m_retire_width), m_mispredict_penalty(other.m_mispredict_penalty), m_decode_latency(other.m_decode_latency),
           m_dispatch_latency(other.m_dispatch_latency), m_schedule_latency(other.m_schedule_latency), m_execute_latency(other.m_execute_latency),
-          m_l1i(other.m_l1i), m_l1i_bw(other.m_l1i_bw), m_l1d_bw(other.m_l1d_bw), m_fetch_queues(other.m_fetch_queues), m_data_queues(other.m_data_queues)
+          m_ftq_size(other.m_ftq_size), m_threads(other.m_threads), m_fetch_policy(other.m_fetch_policy), m_l1i(other.m_l1i), m_l1i_bw(other.m_l1i_bw), m_l1d_bw(other.m_l1d_bw), m_fetch_queues(other.m_fetch_queues), m_data_queues(other.m_data_queues)
     {
     }
 
@@ -411,6 +494,21 @@ public:
       m_execute_latency = execute_latency_;
       return *this;
     }
+    self_type& ftq_size(std::size_t ftq_size_)
+    {
+      m_ftq_size = ftq_size_;
+      return *this;
+    }
+    self_type& threads(std::size_t threads_)
+    {
+      m_threads = threads_;
+      return *this;
+    }
+    self_type& fetch_policy(fetch_policy_type fetch_policy_)
+    {
+      m_fetch_policy = fetch_policy_;
+      return *this;
+    }
     self_type& l1i(CACHE* l1i_)
     {
       m_l1i = l1i_;
@@ -452,12 +550,12 @@ public:
   template <unsigned long long B_FLAG, unsigned long long T_FLAG>
   explicit O3_CPU(Builder<B_FLAG, T_FLAG> b)
       : champsim::operable(b.m_freq_scale), cpu(b.m_cpu), DIB(b.m_dib_set, b.m_dib_way, {champsim::lg2(b.m_dib_window)}, {champsim::lg2(b.m_dib_window)}),
-        LQ(b.m_lq_size), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
+        LQ(b.m_lq_size), threads(b.m_threads), FETCH_POLICY(b.m_fetch_policy), IFETCH_BUFFER_SIZE(b.m_ifetch_buffer_size), DISPATCH_BUFFER_SIZE(b.m_dispatch_buffer_size), DECODE_BUFFER_SIZE(b.m_decode_buffer_size),
         ROB_SIZE(b.m_rob_size), SQ_SIZE(b.m_sq_size), FETCH_WIDTH(b.m_fetch_width), DECODE_WIDTH(b.m_decode_width), DISPATCH_WIDTH(b.m_dispatch_width),
         SCHEDULER_SIZE(b.m_schedule_width), EXEC_WIDTH(b.m_execute_width), LQ_WIDTH(b.m_lq_width), SQ_WIDTH(b.m_sq_width), RETIRE_WIDTH(b.m_retire_width),
         BRANCH_MISPREDICT_PENALTY(b.m_mispredict_penalty), DISPATCH_LATENCY(b.m_dispatch_latency), DECODE_LATENCY(b.m_decode_latency),
         SCHEDULING_LATENCY(b.m_schedule_latency), EXEC_LATENCY(b.m_execute_latency), L1I_BANDWIDTH(b.m_l1i_bw), L1D_BANDWIDTH(b.m_l1d_bw),
-        L1I_bus(b.m_cpu, b.m_fetch_queues), L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), module_pimpl(std::make_unique<module_model<B_FLAG, T_FLAG>>(this))
+        FTQ_SIZE(b.m_ftq_size), L1I_bus(b.m_cpu, b.m_fetch_queues), L1D_bus(b.m_cpu, b.m_data_queues), l1i(b.m_l1i), module_pimpl(std::make_unique<module_model<B_FLAG, T_FLAG>>(this))
   {
   }
 };
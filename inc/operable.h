@@ -17,6 +17,8 @@
 #ifndef OPERABLE_H
 #define OPERABLE_H
 
+#include <cstdint>
+
 namespace champsim
 {
 
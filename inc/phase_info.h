@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -36,6 +37,7 @@ struct phase_info {
   uint64_t length;
   std::vector<std::size_t> trace_index;
   std::vector<std::string> trace_names;
+  uint64_t skip_to; // if the traces have not reached this instruction, they are fast-forwarded to it before the phase
 };
 
 struct phase_stats {
@@ -44,8 +46,20 @@ struct phase_stats {
   std::vector<O3_CPU::stats_type> roi_cpu_stats, sim_cpu_stats;
   std::vector<CACHE::stats_type> roi_cache_stats, sim_cache_stats;
   std::vector<DRAM_CHANNEL::stats_type> roi_dram_stats, sim_dram_stats;
+  std::vector<double> isolated_ipc{}; // of the trace of each core, when it ran alone
 };
 
+// How the cores share the system, against their IPC when each ran alone
+struct throughput_stats {
+  double weighted_speedup = 0; // the sum of the IPC of each core relative to its IPC alone
+  double harmonic_speedup = 0; // the number of cores over the sum of their slowdowns
+  double maximum_slowdown = 0;
+  double unfairness = 0; // the largest slowdown over the smallest
+};
+
+// The throughput of the region of interest, if the IPC alone was given for every core
+std::optional<throughput_stats> throughput(const phase_stats& stats);
+
 } // namespace champsim
 
 #endif
@@ -17,10 +17,15 @@
 #ifndef REPEATABLE_H
 #define REPEATABLE_H
 
+#include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include "decoded_trace.h"
 #include "instruction.h"
+#include "util/detect.h"
 #include <fmt/ranges.h>
 
 namespace champsim
@@ -45,6 +50,134 @@ struct repeatable {
   }
 
   bool eof() const { return false; }
+
+  template <typename U>
+  using has_skip = decltype(std::declval<U&>().skip(uint64_t{}));
+
+  // If the trace can skip instructions without decoding them, skip through as many repetitions as needed
+  template <typename U = T, typename = std::enable_if_t<champsim::is_detected_v<has_skip, U>>>
+  uint64_t skip(uint64_t count)
+  {
+    uint64_t skipped = 0;
+    while (skipped < count) {
+      if (intern_.eof()) {
+        fmt::print("*** Reached end of trace: {}\n", args_);
+        intern_ = T{std::apply([](auto... x) { return T{x...}; }, args_)};
+      }
+
+      auto n = intern_.skip(count - skipped);
+      if (n == 0)
+        break; // The trace is empty
+      skipped += n;
+    }
+    return skipped;
+  }
+};
+
+/*
+ * Like repeatable, except that the instructions of the first pass through the trace are kept in memory, as decoded records, and replayed on
+ * each later pass without reopening the trace. If the trace does not fit in the given number of bytes, it is reopened as by repeatable.
+ */
+template <typename T, typename... Args>
+class in_memory_repeatable
+{
+  static_assert(std::is_move_constructible_v<T>);
+  static_assert(std::is_move_assignable_v<T>);
+  std::tuple<Args...> args_;
+  std::size_t capacity_;
+  std::optional<T> intern_{std::apply([](auto... x) { return T{x...}; }, args_)};
+  std::vector<decoded_instr> records_{};
+  std::size_t next_ = 0;
+  bool overflowed_ = false;
+
+  bool replaying() const { return !intern_.has_value(); }
+
+  void reached_end()
+  {
+    fmt::print("*** Reached end of trace: {}\n", args_);
+    if (!overflowed_ && !std::empty(records_)) {
+      intern_.reset(); // The whole trace is in memory, so the reader is no longer needed
+      next_ = 0;
+    } else {
+      intern_ = T{std::apply([](auto... x) { return T{x...}; }, args_)};
+    }
+  }
+
+  void overflow()
+  {
+    overflowed_ = true;
+    records_.clear();
+    records_.shrink_to_fit();
+  }
+
+  template <typename U>
+  using has_skip = decltype(std::declval<U&>().skip(uint64_t{}));
+
+public:
+  explicit in_memory_repeatable(std::size_t capacity_bytes, Args... args) : args_(args...), capacity_(capacity_bytes / sizeof(decoded_instr)) {}
+
+  ooo_model_instr operator()()
+  {
+    if (replaying()) {
+      if (next_ == std::size(records_)) {
+        fmt::print("*** Reached end of trace: {}\n", args_);
+        next_ = 0;
+      }
+      return ooo_model_instr{uint8_t{}, records_[next_++]}; // The address space is kept in the record
+    }
+
+    if (intern_->eof()) {
+      reached_end();
+      if (replaying())
+        return (*this)();
+    }
+
+    auto instr = (*intern_)();
+    if (!overflowed_) {
+      if (std::size(records_) < capacity_)
+        records_.push_back(encode(instr));
+      else
+        overflow();
+    }
+    return instr;
+  }
+
+  bool eof() const { return false; }
+
+  uint64_t skip(uint64_t count)
+  {
+    uint64_t skipped = 0;
+    while (skipped < count) {
+      if (replaying()) {
+        auto n = std::min<uint64_t>(count - skipped, std::size(records_) - next_);
+        next_ += n;
+        skipped += n;
+        if (skipped < count) {
+          fmt::print("*** Reached end of trace: {}\n", args_);
+          next_ = 0;
+        }
+      } else if (intern_->eof()) {
+        reached_end();
+      } else if constexpr (champsim::is_detected_v<has_skip, T>) {
+        // A skip that would not fit in memory seeks instead, giving up the copy in memory
+        if (overflowed_ || std::size(records_) + (count - skipped) > capacity_) {
+          if (!overflowed_)
+            overflow();
+          auto n = intern_->skip(count - skipped);
+          if (n == 0)
+            break; // The trace is empty
+          skipped += n;
+        } else {
+          (*this)();
+          ++skipped;
+        }
+      } else {
+        (*this)();
+        ++skipped;
+      }
+    }
+    return skipped;
+  }
 };
 } // namespace champsim
 
@@ -0,0 +1,94 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef REQUEST_TIMELINE_H
+#define REQUEST_TIMELINE_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+#include "champsim.h"
+
+namespace champsim
+{
+/**
+ * The events in the life of a request at one component of the memory hierarchy.
+ * Caches stamp ENQUEUE through FILL, and the memory controller stamps ENQUEUE and SCHEDULE through COMPLETE.
+ */
+enum class request_event : unsigned {
+  ENQUEUE = 0, // first seen in the channel to the component
+  TAG_CHECK,   // began its tag check
+  TAG_ATTEMPT, // first tried to complete its tag check
+  ISSUE,       // completed its tag check, having hit or been sent to the lower level
+  RETURN,      // its response returned from the lower level
+  FILL,        // filled into the cache
+  SCHEDULE,    // assigned to a DRAM bank
+  ACTIVATE,    // its row was open
+  CAS,         // its column was read or written
+  BUS,         // placed on the data bus
+  COMPLETE,    // its transfer finished
+  NUM_EVENTS
+};
+
+/**
+ * The cycles at which a request reached each event, in the clock of the component that handles it.
+ * A request forwarded to a lower level begins a new timeline there. Unless the breakdown is compiled in, nothing is stored.
+ */
+template <bool Enabled = track_latency>
+class basic_request_timeline
+{
+  constexpr static uint64_t unset = std::numeric_limits<uint64_t>::max();
+  std::array<uint64_t, static_cast<std::size_t>(request_event::NUM_EVENTS)> stamps;
+
+public:
+  basic_request_timeline() { stamps.fill(unset); }
+
+  void mark(request_event event, uint64_t cycle) { stamps[static_cast<std::size_t>(event)] = cycle; }
+  void mark_first(request_event event, uint64_t cycle)
+  {
+    if (!has(event))
+      mark(event, cycle);
+  }
+
+  bool has(request_event event) const { return stamps[static_cast<std::size_t>(event)] != unset; }
+
+  // The cycles from one event to another, if the request has reached both
+  std::optional<uint64_t> between(request_event from, request_event to) const
+  {
+    auto begin = stamps[static_cast<std::size_t>(from)];
+    auto end = stamps[static_cast<std::size_t>(to)];
+    if (begin == unset || end == unset || end < begin)
+      return std::nullopt;
+    return end - begin;
+  }
+};
+
+template <>
+class basic_request_timeline<false>
+{
+public:
+  void mark(request_event, uint64_t) {}
+  void mark_first(request_event, uint64_t) {}
+  bool has(request_event) const { return false; }
+  std::optional<uint64_t> between(request_event, request_event) const { return std::nullopt; }
+};
+
+using request_timeline = basic_request_timeline<>;
+} // namespace champsim
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RESULTS_REPORT_H
+#define RESULTS_REPORT_H
+
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace champsim::report
+{
+/**
+ * The statistics of one run, read from the region of interest of the last phase in its JSON output.
+ * The misses of the private caches of each core are summed into one level, so that cpu0_L2C and cpu1_L2C are both L2C.
+ */
+struct run {
+  std::string config;   // the name of the directory the run was found in
+  std::string trace;    // the path of the run within that directory, without its extension
+  std::string category; // the name of the trace, without its trailing number
+  std::vector<uint64_t> instructions{}, cycles{}; // of each core
+  std::map<std::string, uint64_t> misses{}, load_misses{};
+  std::vector<std::string> trace_names{}; // the paths of the traces that were simulated
+
+  uint64_t total_instructions() const;
+
+  // The sum of the IPC of each core
+  double ipc() const;
+
+  double mpki(uint64_t count) const;
+};
+
+// Read a run from the JSON output of ChampSim, throwing if it does not hold the statistics of a phase
+run read_run(std::istream& is, std::string config, std::string trace);
+
+// Read each JSON file under each directory, on the given number of threads. Files that cannot be read are skipped with a warning.
+std::vector<run> read_runs(const std::vector<std::filesystem::path>& dirs, unsigned jobs);
+
+// The category of a trace is its name without a trailing _N, so that compute_int_7 is compute_int
+std::string category_of(std::string_view trace);
+
+double geomean(const std::vector<double>& values);
+
+// Write one row for each run, with its speedup over the run of the same trace in the baseline configuration
+void write_runs_csv(std::ostream& os, const std::vector<run>& runs, std::string_view baseline);
+
+// Write one row for each category of each configuration, and for all of its runs together, with the geometric means of the IPC and the speedup
+void write_categories_csv(std::ostream& os, const std::vector<run>& runs, std::string_view baseline);
+} // namespace champsim::report
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SEEKABLE_ZSTD_H
+#define SEEKABLE_ZSTD_H
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * A frame of a file in the Zstandard seekable format. Each frame is compressed independently, and a table of their sizes is kept in a skippable
+ * frame at the end of the file, so that ordinary Zstandard decompressors still read the file.
+ */
+struct zstd_frame {
+  uint64_t compressed_offset;
+  uint64_t decompressed_offset;
+  uint32_t compressed_size;
+  uint32_t decompressed_size;
+};
+
+/**
+ * Read the seek table from the end of the file. Throws if the file does not have one.
+ */
+std::vector<zstd_frame> read_zstd_seek_table(std::istream& is);
+
+/**
+ * Compress a stream into independent frames of a fixed decompressed size, followed by the seek table.
+ */
+class seekable_zstd_writer
+{
+  std::ostream& out;
+  int level;
+  std::vector<char> buffer;
+  std::vector<std::pair<uint32_t, uint32_t>> entries{}; // compressed and decompressed sizes
+
+  void write_frame();
+
+public:
+  constexpr static std::size_t default_frame_size = 1 << 20;
+
+  explicit seekable_zstd_writer(std::ostream& os, std::size_t frame_size = default_frame_size, int compression_level = 3);
+
+  void write(const char* s, std::size_t count);
+
+  // Compress the last frame and write the seek table
+  void close();
+};
+
+/**
+ * Read a seekable Zstandard file, decompressing the frames ahead of the reader on several threads.
+ * Unless a number of frames is given, as many frames are decompressed at once as champsim::decode_threads.
+ */
+class seekable_zstd_istream
+{
+  std::ifstream file;
+  std::vector<zstd_frame> frames;
+  std::size_t lookahead;
+  std::size_t next_frame = 0; // the next frame to be started
+  std::deque<std::future<std::vector<char>>> pending{};
+  std::vector<char> current{};
+  std::size_t current_pos = 0;
+  std::streamsize gcount_ = 0;
+  bool eof_ = false;
+
+  void start_frames();
+
+public:
+  explicit seekable_zstd_istream(std::string fname);
+  seekable_zstd_istream(std::string fname, std::size_t frames_ahead);
+
+  seekable_zstd_istream& read(char* s, std::streamsize count);
+  bool eof() const { return eof_; }
+  std::streamsize gcount() const { return gcount_; }
+
+  // The total size of the decompressed file
+  uint64_t size() const;
+
+  // Continue reading from the given offset in the decompressed file
+  void seek(uint64_t offset);
+};
+} // namespace champsim
+
+#endif
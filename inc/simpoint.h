@@ -0,0 +1,63 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SIMPOINT_H
+#define SIMPOINT_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "phase_info.h"
+
+namespace champsim
+{
+class tracereader;
+
+struct simpoint {
+  uint64_t start; // the first instruction of the interval
+  double weight;  // the fraction of the trace that the interval represents
+};
+
+/**
+ * Read a list of intervals, one per line, each given as its first instruction and its weight. Text after a '#' is ignored.
+ * The weights are normalized to sum to one, and the intervals are sorted by their first instruction.
+ */
+std::vector<simpoint> read_simpoints(std::istream& is);
+
+void write_simpoints(std::ostream& os, const std::vector<simpoint>& points);
+
+/**
+ * Read the trace to its end and produce a basic block vector for each complete interval.
+ * A basic block is identified by the address of its first instruction and counted by the instructions it executed. Each vector is normalized
+ * and randomly projected to a fixed, small number of dimensions.
+ */
+std::vector<std::vector<double>> collect_bbvs(tracereader& trace, uint64_t interval_length);
+
+/**
+ * Cluster the basic block vectors with k-means. Each cluster is represented by the interval nearest its centroid, weighted by the size of the cluster.
+ */
+std::vector<simpoint> choose_simpoints(const std::vector<std::vector<double>>& bbvs, std::size_t clusters, uint64_t interval_length);
+
+/**
+ * Combine the statistics of the simulated intervals. Each counter is the weighted sum of the intervals' counters, so that the result describes
+ * an average interval.
+ */
+phase_stats weighted_stats(std::string name, const std::vector<phase_stats>& stats, const std::vector<simpoint>& points);
+} // namespace champsim
+
+#endif
@@ -17,8 +17,10 @@
 #include <iostream>
 #include <vector>
 
+#include "access_capture.h"
 #include "cache.h"
 #include "dram_controller.h"
+#include "interval_stats.h"
 #include "ooo_cpu.h"
 #include "phase_info.h"
 
@@ -31,6 +33,10 @@ class plain_printer
   void print(O3_CPU::stats_type);
   void print(CACHE::stats_type);
   void print(DRAM_CHANNEL::stats_type);
+  void print(std::string_view owner, const module_stats& stats);
+
+  template <typename H, std::size_t N>
+  void print(std::string_view owner, const latency_histograms<H>& stats, const std::array<std::string_view, N>& hop_names);
 
   template <typename T>
   void print(std::vector<T> stats_list)
@@ -43,6 +49,7 @@ public:
   plain_printer(std::ostream& str) : stream(str) {}
   void print(phase_stats& stats);
   void print(std::vector<phase_stats>& stats);
+  void print(const replay_stats& stats);
 };
 
 class json_printer
@@ -52,5 +59,8 @@ class json_printer
 public:
   json_printer(std::ostream& str) : stream(str) {}
   void print(std::vector<phase_stats>& stats);
+
+  // One line, with no whitespace, for a stream of intervals
+  void print(const interval_stats& stats);
 };
 } // namespace champsim
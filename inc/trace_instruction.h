@@ -64,4 +64,26 @@ struct cloudsuite_instr {
   unsigned char asid[2];
 };
 
+// An instruction as decoded for the core, as stored in a pre-decoded trace. The operand lists are packed to the front, with their lengths.
+struct decoded_instr {
+  unsigned long long ip;
+  unsigned long long branch_target;
+
+  unsigned long long destination_memory[NUM_INSTR_DESTINATIONS_SPARC];
+  unsigned long long source_memory[NUM_INSTR_SOURCES];
+
+  unsigned char destination_registers[NUM_INSTR_DESTINATIONS_SPARC];
+  unsigned char source_registers[NUM_INSTR_SOURCES];
+
+  unsigned char asid[2];
+  unsigned char is_branch;
+  unsigned char branch_taken;
+  unsigned char branch_type;
+
+  unsigned char num_destination_registers;
+  unsigned char num_source_registers;
+  unsigned char num_destination_memory;
+  unsigned char num_source_memory;
+};
+
 #endif
@@ -17,6 +17,8 @@
 #ifndef TRACEREADER_H
 #define TRACEREADER_H
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <deque>
 #include <memory>
@@ -30,11 +32,12 @@ namespace champsim
 {
 class tracereader
 {
-  static uint64_t instr_unique_id;
+  static std::atomic<uint64_t> instr_unique_id;
   struct reader_concept {
     virtual ~reader_concept() = default;
     virtual ooo_model_instr operator()() = 0;
     virtual bool eof() const = 0;
+    virtual uint64_t skip(uint64_t count) = 0;
   };
 
   template <typename T>
@@ -45,6 +48,9 @@ class tracereader
     template <typename U>
     using has_eof = decltype(std::declval<U>().eof());
 
+    template <typename U>
+    using has_skip = decltype(std::declval<U&>().skip(uint64_t{}));
+
     ooo_model_instr operator()() override { return intern_(); }
     bool eof() const override
     {
@@ -52,9 +58,21 @@ class tracereader
         return intern_.eof();
       return false; // If an eof() member function is not provided, assume the trace never ends.
     }
+
+    uint64_t skip(uint64_t count) override
+    {
+      if constexpr (champsim::is_detected_v<has_skip, T>)
+        return intern_.skip(count); // The reader can seek past the instructions
+
+      uint64_t skipped = 0;
+      for (; skipped < count && !eof(); ++skipped)
+        intern_();
+      return skipped;
+    }
   };
 
   std::unique_ptr<reader_concept> pimpl_;
+  uint64_t position_ = 0;
 
 public:
   template <typename T>
@@ -65,11 +83,18 @@ public:
   auto operator()()
   {
     auto retval = (*pimpl_)();
-    retval.instr_id = instr_unique_id++;
+    retval.instr_id = instr_unique_id.fetch_add(1, std::memory_order_relaxed);
+    ++position_;
     return retval;
   }
 
   auto eof() const { return pimpl_->eof(); }
+
+  // The number of instructions read from this trace
+  uint64_t position() const { return position_; }
+
+  // Discard up to count instructions, without decoding them if the reader can seek. Fewer are discarded only if the trace ends.
+  uint64_t skip(uint64_t count);
 };
 
 template <typename T, typename F>
@@ -81,6 +106,10 @@ class bulk_tracereader
   uint8_t cpu;
   bool eof_ = false;
   F trace_file;
+  uint64_t records_read = 0;
+
+  template <typename G>
+  using has_seek = decltype(std::declval<G&>().seek(uint64_t{}));
 
   constexpr static std::size_t buffer_size = 128;
   constexpr static std::size_t refresh_thresh = 1;
@@ -93,6 +122,10 @@ public:
   bulk_tracereader(uint8_t cpu_idx, F&& file) : cpu(cpu_idx), trace_file(std::move(file)) {}
 
   bool eof() const { return trace_file.eof() && std::size(instr_buffer) <= refresh_thresh; }
+
+  // Traces in a seekable format can skip instructions without decompressing them
+  template <typename G = F, typename = std::enable_if_t<champsim::is_detected_v<has_seek, G>>>
+  uint64_t skip(uint64_t count);
 };
 
 ooo_model_instr apply_branch_target(ooo_model_instr branch, const ooo_model_instr& target);
@@ -124,6 +157,7 @@ ooo_model_instr bulk_tracereader<T, F>::operator()()
     auto begin = std::begin(trace_read_buf);
     auto end = std::next(begin, bytes_read / sizeof(T));
     std::transform(begin, end, std::back_inserter(instr_buffer), [cpu = this->cpu](T t) { return ooo_model_instr{cpu, t}; });
+    records_read += bytes_read / sizeof(T);
 
     // Set branch targets
     set_branch_targets(std::begin(instr_buffer), std::end(instr_buffer));
@@ -135,9 +169,37 @@ ooo_model_instr bulk_tracereader<T, F>::operator()()
   return retval;
 }
 
+template <typename T, typename F>
+template <typename G, typename>
+uint64_t bulk_tracereader<T, F>::skip(uint64_t count)
+{
+  // Skip the instructions already read
+  auto buffered = std::min<uint64_t>(count, std::size(instr_buffer));
+  instr_buffer.erase(std::begin(instr_buffer), std::next(std::begin(instr_buffer), static_cast<long>(buffered)));
+  if (buffered == count)
+    return count;
+
+  // The buffer is empty, so the next instruction is the next record in the file.
+  // The final record is never read, for want of a branch target, so skipping to it reaches the end.
+  auto total_records = trace_file.size() / sizeof(T);
+  auto last_record = std::max<uint64_t>(total_records, 1) - 1;
+  auto target = records_read + (count - buffered);
+  if (target >= last_record) {
+    auto skipped = buffered + (last_record - std::min(records_read, last_record));
+    trace_file.seek(total_records * sizeof(T));
+    records_read = total_records;
+    return skipped;
+  }
+
+  trace_file.seek(target * sizeof(T));
+  records_read = target;
+  return count;
+}
+
 std::string get_fptr_cmd(std::string_view fname);
 } // namespace champsim
 
-champsim::tracereader get_tracereader(std::string fname, uint8_t cpu, bool is_cloudsuite, bool repeat);
+// If repeat_memory_bytes is nonzero, a repeated trace that fits in that many bytes is kept in memory after the first pass
+champsim::tracereader get_tracereader(std::string fname, uint8_t cpu, bool is_cloudsuite, bool repeat, std::size_t repeat_memory_bytes = 0);
 
 #endif
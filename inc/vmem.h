@@ -18,6 +18,7 @@
 #define VMEM_H
 
 #include <cstdint>
+#include <iosfwd>
 #include <map>
 
 #include "champsim_constants.h"
@@ -55,6 +56,9 @@ public:
   std::size_t available_ppages() const;
   std::pair<uint64_t, uint64_t> va_to_pa(uint32_t cpu_num, uint64_t vaddr);
   std::pair<uint64_t, uint64_t> get_pte_pa(uint32_t cpu_num, uint64_t vaddr, std::size_t level);
+
+  void save_checkpoint(std::ostream& os) const;
+  void restore_checkpoint(std::istream& is);
 };
 
 #endif
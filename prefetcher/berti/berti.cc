@@ -1,6 +1,8 @@
 #include "berti.h"
 #include <algorithm>
 
+#include "checkpoint.h"
+
 /*
  * Berti: an Accurate Local-Delta Data Prefetcher
  *
@@ -699,10 +701,10 @@ uint8_t Berti::get(uint64_t tag, std::vector<delta_t>& res)
         {
                 if constexpr(champsim::debug_print)
                         std::cout << " TAG NOT FOUND" << std::endl;
-                no_found_berti++;
+                stats->no_found_berti++;
                 return 0;
         }
-        found_berti++;
+        stats->found_berti++;
 
         if constexpr(champsim::debug_print)
                 std::cout << std::endl;
@@ -927,6 +929,91 @@ uint64_t Berti::ip_hash(uint64_t ip)
         return ip; // No IP hash
 }
 
+/******************************************************************************/
+/*                        Checkpoints                                         */
+/******************************************************************************/
+void LatencyTable::save(std::ostream& os) const
+{
+        champsim::checkpoint::write_array(os, latencyt, size);
+}
+
+void LatencyTable::restore(std::istream& is)
+{
+        champsim::checkpoint::read_array(is, latencyt, size);
+}
+
+void ShadowCache::save(std::ostream& os) const
+{
+        for(int i = 0; i < sets; i++) champsim::checkpoint::write_array(os, scache[i], ways);
+}
+
+void ShadowCache::restore(std::istream& is)
+{
+        for(int i = 0; i < sets; i++) champsim::checkpoint::read_array(is, scache[i], ways);
+}
+
+void HistoryTable::save(std::ostream& os) const
+{
+        for(int i = 0; i < sets; i++)
+        {
+                champsim::checkpoint::write_array(os, historyt[i], ways);
+
+                // The pointer to the oldest entry is saved as its position in the set
+                champsim::checkpoint::write(os, history_pointers[i] - historyt[i]);
+        }
+}
+
+void HistoryTable::restore(std::istream& is)
+{
+        for(int i = 0; i < sets; i++)
+        {
+                champsim::checkpoint::read_array(is, historyt[i], ways);
+
+                std::ptrdiff_t pos = 0;
+                champsim::checkpoint::read(is, pos);
+                if(pos < 0 || pos >= ways)
+                        throw std::runtime_error("Checkpoint does not match this configuration: Berti history pointer out of range");
+                history_pointers[i] = historyt[i] + pos;
+        }
+}
+
+void Berti::save(std::ostream& os) const
+{
+        // Every tracked tag is in the replacement queue, so the entries are saved in its order
+        auto queue = bertit_queue;
+        champsim::checkpoint::write(os, queue.size());
+        for(; !queue.empty(); queue.pop())
+        {
+                const berti* entry = bertit.at(queue.front());
+                champsim::checkpoint::write(os, queue.front());
+                champsim::checkpoint::write(os, entry->conf);
+                champsim::checkpoint::write(os, entry->total_used);
+                champsim::checkpoint::write(os, entry->deltas);
+        }
+}
+
+void Berti::restore(std::istream& is)
+{
+        for(auto& [tag, entry]: bertit) delete entry;
+        bertit.clear();
+        bertit_queue = {};
+
+        std::size_t count = 0;
+        champsim::checkpoint::read(is, count);
+        for(std::size_t i = 0; i < count; i++)
+        {
+                uint64_t tag = 0;
+                berti*   entry = new berti;
+                champsim::checkpoint::read(is, tag);
+                champsim::checkpoint::read(is, entry->conf);
+                champsim::checkpoint::read(is, entry->total_used);
+                champsim::checkpoint::read(is, entry->deltas);
+
+                bertit.insert(std::make_pair(tag, entry));
+                bertit_queue.push(tag);
+        }
+}
+
 /******************************************************************************/
 /*                        Cache Functions                                     */
 /******************************************************************************/
@@ -939,10 +1026,24 @@ void CACHE::prefetcher_initialize()
         for(auto const& i: get_pq_size()) latency_table_size += i;
 
         // New structures
+        auto& [latencyt, scache, historyt, berti, stats] = prefetchers[this];
         latencyt = new LatencyTable(latency_table_size);
         scache   = new ShadowCache(this->NUM_SET, this->NUM_WAY);
         historyt = new HistoryTable();
-        berti    = new Berti(BERTI_TABLE_DELTA_SIZE);
+        berti    = new Berti(BERTI_TABLE_DELTA_SIZE, historyt, &stats);
+
+        stats_registry.add_counter("BERTI TO_L1", stats.pf_to_l1);
+        stats_registry.add_counter("BERTI TO_L2", stats.pf_to_l2);
+        stats_registry.add_counter("BERTI TO_L2_BC_MSHR", stats.pf_to_l2_bc_mshr);
+        stats_registry.add_counter("BERTI NUM_TRACK_LATENCY", stats.num_track_latency);
+        stats_registry.add_counter("BERTI TOTAL_LATENCY", stats.total_latency);
+        stats_registry.add_counter("BERTI NUM_CANT_TRACK_LATENCY", stats.cant_track_latency);
+        stats_registry.add_counter("BERTI CROSS_PAGE", stats.cross_page);
+        stats_registry.add_counter("BERTI NO_CROSS_PAGE", stats.no_cross_page);
+        stats_registry.add_counter("BERTI FOUND_BERTI", stats.found_berti);
+        stats_registry.add_counter("BERTI NO_FOUND_BERTI", stats.no_found_berti);
+        stats_registry.add_counter("BERTI ISSUED", stats.average_issued);
+        stats_registry.add_counter("BERTI ISSUING_ACCESSES", stats.average_num);
 
         std::cout << "Berti Prefetcher" << std::endl;
 
@@ -968,6 +1069,8 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
                 std::cout << " line_address: " << line_addr << std::dec << std::endl;
         }
 
+        auto& [latencyt, scache, historyt, berti, stats] = prefetchers.at(this);
+
         uint64_t ip_hash = berti->ip_hash(ip) & IP_MASK;
 
         if(!cache_hit) // This is a miss
@@ -1017,33 +1120,33 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
 
                 if((p_addr >> LOG2_PAGE_SIZE) != (addr >> LOG2_PAGE_SIZE))
                 {
-                        cross_page++;
+                        stats.cross_page++;
 #ifdef NO_CROSS_PAGE
                         // We do not cross virtual page
                         continue;
 #endif
                 }
                 else
-                        no_cross_page++;
+                        stats.no_cross_page++;
 
                 float mshr_load = get_mshr_occupancy_ratio() * 100;
 
                 bool fill_this_level = (i.rpl == BERTI_L1) && (mshr_load < MSHR_LIMIT);
 
                 if(i.rpl == BERTI_L1 && mshr_load >= MSHR_LIMIT)
-                        pf_to_l2_bc_mshr++;
+                        stats.pf_to_l2_bc_mshr++;
                 if(fill_this_level)
-                        pf_to_l1++;
+                        stats.pf_to_l1++;
                 else
-                        pf_to_l2++;
+                        stats.pf_to_l2++;
 
                 if(prefetch_line(p_addr, fill_this_level, metadata_in))
                 {
-                        ++average_issued;
+                        ++stats.average_issued;
                         if(first_issue)
                         {
                                 first_issue = false;
-                                ++average_num;
+                                ++stats.average_num;
                         }
 
                         if constexpr(champsim::debug_print)
@@ -1068,6 +1171,8 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
 
 uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way, uint8_t prefetch, uint64_t evicted_addr, uint32_t metadata_in)
 {
+        auto& [latencyt, scache, historyt, berti, stats] = prefetchers.at(this);
+
         uint64_t line_addr = (addr >> LOG2_BLOCK_SIZE); // Line addr
         uint64_t tag       = latencyt->get_tag(line_addr);
         uint64_t cycle     = latencyt->del(line_addr) & TIME_MASK;
@@ -1087,20 +1192,14 @@ uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way,
         if(latency > LAT_MASK)
         {
                 latency = 0;
-                cant_track_latency++;
+                stats.cant_track_latency++;
         }
         else
         {
                 if(latency != 0)
                 {
-                        // Calculate average latency
-                        if(average_latency.num == 0)
-                                average_latency.average = (float)latency;
-                        else
-                        {
-                                average_latency.average = average_latency.average + ((((float)latency) - average_latency.average) / average_latency.num);
-                        }
-                        average_latency.num++;
+                        stats.total_latency += latency;
+                        stats.num_track_latency++;
                 }
         }
 
@@ -1114,25 +1213,23 @@ uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way,
         return metadata_in;
 }
 
-void CACHE::prefetcher_final_stats()
-{
-        std::cout << "BERTI "
-                  << "TO_L1: " << pf_to_l1 << " TO_L2: " << pf_to_l2;
-        std::cout << " TO_L2_BC_MSHR: " << pf_to_l2_bc_mshr << std::endl;
-
-        std::cout << "BERTI AVG_LAT: ";
-        std::cout << average_latency.average << " NUM_TRACK_LATENCY: ";
-        std::cout << average_latency.num << " NUM_CANT_TRACK_LATENCY: ";
-        std::cout << cant_track_latency << std::endl;
-
-        std::cout << "BERTI CROSS_PAGE " << cross_page;
-        std::cout << " NO_CROSS_PAGE: " << no_cross_page << std::endl;
+// The statistics are registered with the cache, and reported with its own
+void CACHE::prefetcher_final_stats() {}
 
-        std::cout << "BERTI";
-        std::cout << " FOUND_BERTI: " << found_berti;
-        std::cout << " NO_FOUND_BERTI: " << no_found_berti << std::endl;
+void CACHE::prefetcher_save_state(std::ostream& os)
+{
+        auto& [latencyt, scache, historyt, berti, stats] = prefetchers.at(this);
+        latencyt->save(os);
+        scache->save(os);
+        historyt->save(os);
+        berti->save(os);
+}
 
-        std::cout << "BERTI";
-        std::cout << " AVERAGE_ISSUED: " << ((1.0 * average_issued) / average_num);
-        std::cout << std::endl;
+void CACHE::prefetcher_restore_state(std::istream& is)
+{
+        auto& [latencyt, scache, historyt, berti, stats] = prefetchers.at(this);
+        latencyt->restore(is);
+        scache->restore(is);
+        historyt->restore(is);
+        berti->restore(is);
 }
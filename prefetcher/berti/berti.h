@@ -57,26 +57,24 @@ namespace berti_space
         /*****************************************************************************
          *                              Stats                                        *
          *****************************************************************************/
-        // Get average latency: Welford's method
-        typedef struct welford
+        struct stats_type
         {
-                        uint64_t num     = 0;
-                        float    average = 0.0;
-        } welford_t;
-
-        welford_t average_latency;
-
-        // Get more info
-        uint64_t pf_to_l1           = 0;
-        uint64_t pf_to_l2           = 0;
-        uint64_t pf_to_l2_bc_mshr   = 0;
-        uint64_t cant_track_latency = 0;
-        uint64_t cross_page         = 0;
-        uint64_t no_cross_page      = 0;
-        uint64_t no_found_berti     = 0;
-        uint64_t found_berti        = 0;
-        uint64_t average_issued     = 0;
-        uint64_t average_num        = 0;
+                        // The average latency is total_latency / num_track_latency
+                        uint64_t num_track_latency = 0;
+                        uint64_t total_latency     = 0;
+
+                        // Get more info
+                        uint64_t pf_to_l1           = 0;
+                        uint64_t pf_to_l2           = 0;
+                        uint64_t pf_to_l2_bc_mshr   = 0;
+                        uint64_t cant_track_latency = 0;
+                        uint64_t cross_page         = 0;
+                        uint64_t no_cross_page      = 0;
+                        uint64_t no_found_berti     = 0;
+                        uint64_t found_berti        = 0;
+                        uint64_t average_issued     = 0;
+                        uint64_t average_num        = 0;
+        };
 
         /*****************************************************************************
          *                      General Structs                                      *
@@ -123,6 +121,9 @@ namespace berti_space
                         uint64_t get(uint64_t addr);
                         uint64_t del(uint64_t addr);
                         uint64_t get_tag(uint64_t addr);
+
+                        void save(std::ostream& os) const;
+                        void restore(std::istream& is);
         };
 
         class ShadowCache
@@ -162,6 +163,9 @@ namespace berti_space
                         void     set_pf(uint64_t addr, bool pf);
                         bool     is_pf(uint64_t addr);
                         uint64_t get_latency(uint64_t addr);
+
+                        void save(std::ostream& os) const;
+                        void restore(std::istream& is);
         };
 
         class HistoryTable
@@ -205,6 +209,9 @@ namespace berti_space
                         int      get_ways();
                         void     add(uint64_t tag, uint64_t addr, uint64_t cycle);
                         uint16_t get(uint32_t latency, uint64_t tag, uint64_t act_addr, uint64_t* tags, uint64_t* addr, uint64_t cycle);
+
+                        void save(std::ostream& os) const;
+                        void restore(std::istream& is);
         };
 
         class Berti
@@ -224,6 +231,9 @@ namespace berti_space
 
                         uint64_t size = 0;
 
+                        HistoryTable* historyt;
+                        stats_type*   stats;
+
                         bool static compare_greater_delta(delta_t a, delta_t b);
                         bool static compare_rpl(delta_t a, delta_t b);
 
@@ -232,15 +242,25 @@ namespace berti_space
                         void add(uint64_t tag, int64_t delta);
 
                 public:
-                        Berti(uint64_t p_size): size(p_size) {};
+                        Berti(uint64_t p_size, HistoryTable* p_historyt, stats_type* p_stats): size(p_size), historyt(p_historyt), stats(p_stats) {};
                         void     find_and_update(uint64_t latency, uint64_t tag, uint64_t cycle, uint64_t line_addr);
                         uint8_t  get(uint64_t tag, std::vector<delta_t>& res);
                         uint64_t ip_hash(uint64_t ip);
+
+                        void save(std::ostream& os) const;
+                        void restore(std::istream& is);
+        };
+
+        // The tables and statistics of each cache that uses the prefetcher
+        struct prefetcher
+        {
+                        LatencyTable* latencyt;
+                        ShadowCache*  scache;
+                        HistoryTable* historyt;
+                        Berti*        berti;
+                        stats_type    stats;
         };
 
-        LatencyTable* latencyt;
-        ShadowCache*  scache;
-        HistoryTable* historyt;
-        Berti*        berti;
+        std::map<CACHE*, prefetcher> prefetchers;
 }; // namespace berti_space
 #endif
@@ -4,6 +4,7 @@
 #include <optional>
 
 #include "cache.h"
+#include "checkpoint.h"
 #include "msl/lru_table.h"
 
 namespace
@@ -33,6 +34,9 @@ struct tracker {
   champsim::msl::lru_table<tracker_entry> table{TRACKER_SETS, TRACKER_WAYS};
 
 public:
+  void save(std::ostream& os) const { table.save(os); }
+  void restore(std::istream& is) { table.restore(is); }
+
   void initiate_lookahead(uint64_t ip, uint64_t cl_addr)
   {
     int64_t stride = 0;
@@ -86,7 +90,7 @@ public:
 std::map<CACHE*, tracker> trackers;
 } // namespace
 
-void CACHE::prefetcher_initialize() {}
+void CACHE::prefetcher_initialize() { ::trackers.insert_or_assign(this, tracker{}); }
 
 void CACHE::prefetcher_cycle_operate() { ::trackers[this].advance_lookahead(this); }
 
@@ -102,3 +106,7 @@ uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way,
 }
 
 void CACHE::prefetcher_final_stats() {}
+
+void CACHE::prefetcher_save_state(std::ostream& os) { ::trackers[this].save(os); }
+
+void CACHE::prefetcher_restore_state(std::istream& is) { ::trackers[this].restore(is); }
@@ -20,3 +20,8 @@ uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way,
 void CACHE::prefetcher_cycle_operate() {}
 
 void CACHE::prefetcher_final_stats() {}
+
+// The prefetcher keeps no state, so there is nothing to save
+void CACHE::prefetcher_save_state(std::ostream& os) {}
+
+void CACHE::prefetcher_restore_state(std::istream& is) {}
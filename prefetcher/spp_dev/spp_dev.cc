@@ -1,7 +1,10 @@
 #include "spp_dev.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <iostream>
+#include <map>
 
 #include "cache.h"
 
@@ -11,6 +14,16 @@ spp::SIGNATURE_TABLE ST;
 spp::PATTERN_TABLE PT;
 spp::PREFETCH_FILTER FILTER;
 spp::GLOBAL_REGISTER GHR;
+
+// Statistics, registered with each cache
+struct stats_type {
+  uint64_t pf_to_l2c = 0;
+  uint64_t pf_to_llc = 0;
+  uint64_t pf_cross_page = 0;
+  std::array<uint64_t, 16> pf_depth = {}; // by the lookahead depth at which the prefetch was issued, the last also counting any deeper
+};
+
+std::map<CACHE*, stats_type> stats;
 } // namespace
 
 void CACHE::prefetcher_initialize()
@@ -30,12 +43,19 @@ void CACHE::prefetcher_initialize()
 
   std::cout << std::endl << "Initialize PREFETCH FILTER" << std::endl;
   std::cout << "FILTER_SET: " << spp::FILTER_SET << std::endl;
+
+  auto& cache_stats = ::stats[this];
+  stats_registry.add_counter("SPP TO_L2C", cache_stats.pf_to_l2c);
+  stats_registry.add_counter("SPP TO_LLC", cache_stats.pf_to_llc);
+  stats_registry.add_counter("SPP CROSS_PAGE", cache_stats.pf_cross_page);
+  stats_registry.add_histogram("SPP DEPTH", cache_stats.pf_depth);
 }
 
 void CACHE::prefetcher_cycle_operate() {}
 
 uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cache_hit, bool useful_prefetch, uint8_t type, uint32_t metadata_in)
 {
+  auto& cache_stats = ::stats.at(this);
   uint64_t page = addr >> LOG2_PAGE_SIZE;
   uint32_t page_offset = (addr >> LOG2_BLOCK_SIZE) & (PAGE_SIZE / BLOCK_SIZE - 1), last_sig = 0, curr_sig = 0, depth = 0;
   std::vector<uint32_t> confidence_q(MSHR_SIZE);
@@ -84,6 +104,8 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
         if ((addr & ~(PAGE_SIZE - 1)) == (pf_addr & ~(PAGE_SIZE - 1))) { // Prefetch request is in the same physical page
           if (::FILTER.check(pf_addr, ((confidence_q[i] >= spp::FILL_THRESHOLD) ? spp::SPP_L2C_PREFETCH : spp::SPP_LLC_PREFETCH))) {
             prefetch_line(pf_addr, (confidence_q[i] >= spp::FILL_THRESHOLD), 0); // Use addr (not base_addr) to obey the same physical page boundary
+            ++((confidence_q[i] >= spp::FILL_THRESHOLD) ? cache_stats.pf_to_l2c : cache_stats.pf_to_llc);
+            ++cache_stats.pf_depth[std::min<std::size_t>(depth, std::size(cache_stats.pf_depth) - 1)];
 
             if (confidence_q[i] >= spp::FILL_THRESHOLD) {
               ::GHR.pf_issued++;
@@ -104,6 +126,7 @@ uint32_t CACHE::prefetcher_cache_operate(uint64_t addr, uint64_t ip, uint8_t cac
             }
           }
         } else { // Prefetch request is crossing the physical page boundary
+          ++cache_stats.pf_cross_page;
           if constexpr (spp::GHR_ON) {
             // Store this prefetch request in GHR to bootstrap SPP learning when
             // we see a ST miss (i.e., accessing a new page)
@@ -4,6 +4,7 @@
 #include <utility>
 
 #include "cache.h"
+#include "checkpoint.h"
 #include "msl/fwcounter.h"
 
 namespace
@@ -39,6 +40,11 @@ void CACHE::initialize_replacement()
   }
 
   ::rrpv.insert({this, std::vector<unsigned>(NUM_SET * NUM_WAY)});
+
+  // Create the counters now, so that the maps are not modified while caches are simulated on other threads
+  ::bip_counter[this] = 0;
+  for (std::size_t core = 0; core < NUM_CPUS; ++core)
+    ::PSEL[std::make_pair(this, core)];
 }
 
 // called on every cache hit and cache fill
@@ -108,3 +114,20 @@ uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t
 
 // use this function to print out your own stats at the end of simulation
 void CACHE::replacement_final_stats() {}
+
+// The sampler sets are chosen the same way by every run, so they are not saved
+void CACHE::replacement_save_state(std::ostream& os)
+{
+  champsim::checkpoint::write(os, ::bip_counter[this]);
+  champsim::checkpoint::write(os, ::rrpv[this]);
+  for (std::size_t core = 0; core < NUM_CPUS; ++core)
+    champsim::checkpoint::write(os, ::PSEL[std::make_pair(this, core)]);
+}
+
+void CACHE::replacement_restore_state(std::istream& is)
+{
+  champsim::checkpoint::read(is, ::bip_counter[this]);
+  champsim::checkpoint::read(is, ::rrpv[this]);
+  for (std::size_t core = 0; core < NUM_CPUS; ++core)
+    champsim::checkpoint::read(is, ::PSEL[std::make_pair(this, core)]);
+}
@@ -15,13 +15,12 @@
 #include <algorithm>
 #include <cassert>
 #include <map>
+#include <random>
 #include <unordered_set>
 
 #include "cache.h"
 #include "champsim.h" // Needed for instruction counter
-
-// Global instruction counter from ChampSim
-extern uint64_t current_instr_count[NUM_CPUS];
+#include "checkpoint.h"
 
 // Create a new namespace for our dueling policy
 namespace DUEL_IPV_Policy
@@ -81,7 +80,7 @@ namespace DUEL_IPV_Policy
             rrpvs.at(way) = new_rrpv;
         }
 
-        uint32_t find_victim()
+        uint32_t find_victim(std::minstd_rand& rng)
         {
             uint32_t max_valid_rrpv = demand_vector.size() - 1;
             uint32_t max_rrpv = *std::max_element(rrpvs.cbegin(), rrpvs.cend());
@@ -97,11 +96,21 @@ namespace DUEL_IPV_Policy
             }
 
             assert(victims.size() > 0 && victims.size() <= num_ways);
-            std::size_t idx = rand() % victims.size();
+            std::size_t idx = rng() % victims.size();
             decltype(victims)::const_iterator it = victims.cbegin();
             std::advance(it, idx);
             return static_cast<uint32_t>(*it);
         }
+
+        void save_state(std::ostream& os) const
+        {
+            champsim::checkpoint::write(os, rrpvs);
+        }
+
+        void restore_state(std::istream& is)
+        {
+            champsim::checkpoint::read(is, rrpvs);
+        }
     }; // --- End of PACIPV_internal class ---
 
     // --- Dueling Parameters ---
@@ -126,6 +135,17 @@ namespace DUEL_IPV_Policy
         unsigned long long last_epoch_instrs = 0;
         int current_winner = 0; // 0 = instr, 1 = data
 
+        // The random victims of the cache are drawn from a generator of its own, so that caches do not affect each other's choices
+        std::minstd_rand victim_rng{};
+
+        // Statistics of the duel, registered with the cache
+        uint64_t epochs = 0;
+        uint64_t instr_wins = 0;
+        uint64_t data_wins = 0;
+        uint64_t winner_changes = 0;
+        uint64_t epoch_instr_misses = 0; // misses in the monitor sets, over the epochs that ended
+        uint64_t epoch_data_misses = 0;
+
         // The vectors to duel between
         std::vector<uint32_t> demand_vector_instr;
         std::vector<uint32_t> prefetch_vector_instr;
@@ -188,7 +208,7 @@ namespace DUEL_IPV_Policy
 
         uint32_t find_victim()
         {
-            return get_policy()->find_victim();
+            return get_policy()->find_victim(global_state->victim_rng);
         }
 
         // --- MODIFIED: Insert functions now track misses ---
@@ -223,6 +243,19 @@ namespace DUEL_IPV_Policy
         {
             get_policy()->prefetch_promote(way);
         }
+
+        // Both policies are saved, since a follower set can switch to either
+        void save_state(std::ostream& os) const
+        {
+            policy_instr.save_state(os);
+            policy_data.save_state(os);
+        }
+
+        void restore_state(std::istream& is)
+        {
+            policy_instr.restore_state(is);
+            policy_data.restore_state(is);
+        }
     }; // --- End of DUEL_IPV class ---
 
     // --- STEP 3: The global map that holds our policies ---
@@ -359,6 +392,16 @@ void CACHE::initialize_replacement()
         std::cout << std::endl;
     }
 
+    // Report the outcome of the duel with the statistics of the cache
+    if (cache == DUEL_IPV_Policy::cache_type::LLC) {
+        stats_registry.add_counter("DUEL-IPV EPOCHS", global_state->epochs);
+        stats_registry.add_counter("DUEL-IPV INSTR_WINS", global_state->instr_wins);
+        stats_registry.add_counter("DUEL-IPV DATA_WINS", global_state->data_wins);
+        stats_registry.add_counter("DUEL-IPV WINNER_CHANGES", global_state->winner_changes);
+        stats_registry.add_counter("DUEL-IPV INSTR_MONITOR_MISSES", global_state->epoch_instr_misses);
+        stats_registry.add_counter("DUEL-IPV DATA_MONITOR_MISSES", global_state->epoch_data_misses);
+    }
+
     // --- NEW: Add drrip.cc's random set selection logic ---
     // This populates the ::rand_sets[this] global vector with unique, random set indices
     // Only do this if we are actually dueling (e.g., in the LLC)
@@ -426,8 +469,8 @@ uint32_t CACHE::find_victim(
 {
     // --- UNCHANGED ---
     // Delegate to our DUEL_IPV object for this set
-    assert(set < DUEL_IPV_Policy::policies[this].size());
-    return DUEL_IPV_Policy::policies[this][set].find_victim();
+    assert(set < DUEL_IPV_Policy::policies.at(this).size());
+    return DUEL_IPV_Policy::policies.at(this)[set].find_victim();
 }
 
 void CACHE::update_replacement_state(
@@ -441,26 +484,35 @@ void CACHE::update_replacement_state(
     uint8_t hit)
 {
     assert(way < NUM_WAY);
-    assert(set < DUEL_IPV_Policy::policies[this].size());
+    assert(set < DUEL_IPV_Policy::policies.at(this).size());
 
     // --- Epoch Check Logic (only for LLC) ---
     // This logic is still correct for your epoch-based dueling.
     // It only runs for caches that have a DuelingState (LLC).
     if (DUEL_IPV_Policy::cache_duel_state.count(this)) // Check if this cache has duel state
     {
-        DUEL_IPV_Policy::DuelingState* global_state = &DUEL_IPV_Policy::cache_duel_state[this];
+        DUEL_IPV_Policy::DuelingState* global_state = &DUEL_IPV_Policy::cache_duel_state.at(this);
 
         // 'current_instr_count' is a global from champsim.h
         if (current_instr_count[triggering_cpu] - global_state->last_epoch_instrs > DUEL_IPV_Policy::DUEL_EPOCH_LENGTH) {
 
             // Only duel if the policies are different (e.g., not for L1/L2)
             if(global_state->demand_vector_instr != global_state->demand_vector_data) {
+                int previous_winner = global_state->current_winner;
                 if (global_state->policy_data_misses < global_state->policy_instr_misses) {
                     global_state->current_winner = 1; // data wins
+                    global_state->data_wins++;
                 } else {
                     global_state->current_winner = 0; // instr wins (or ties)
+                    global_state->instr_wins++;
                 }
 
+                global_state->epochs++;
+                if (global_state->current_winner != previous_winner)
+                    global_state->winner_changes++;
+                global_state->epoch_instr_misses += static_cast<uint64_t>(global_state->policy_instr_misses);
+                global_state->epoch_data_misses += static_cast<uint64_t>(global_state->policy_data_misses);
+
                 // Debug print
                 std::cout << "[DUEL] CPU " << triggering_cpu << " Epoch ended. INSTR misses = " << global_state->policy_instr_misses
                           << ", DATA misses = " << global_state->policy_data_misses
@@ -482,16 +534,16 @@ void CACHE::update_replacement_state(
 
     if (was_prefetch) {
         if (hit)
-            DUEL_IPV_Policy::policies[this].at(set).prefetch_promote(way);
+            DUEL_IPV_Policy::policies.at(this).at(set).prefetch_promote(way);
         else
             // This call will now also check/increment miss counter
-            DUEL_IPV_Policy::policies[this].at(set).prefetch_insert(way);
+            DUEL_IPV_Policy::policies.at(this).at(set).prefetch_insert(way);
     } else {
         if (hit)
-            DUEL_IPV_Policy::policies[this].at(set).demand_promote(way);
+            DUEL_IPV_Policy::policies.at(this).at(set).demand_promote(way);
         else
             // This call will now also check/increment miss counter
-            DUEL_IPV_Policy::policies[this].at(set).demand_insert(way);
+            DUEL_IPV_Policy::policies.at(this).at(set).demand_insert(way);
     }
 }
 
@@ -499,4 +551,26 @@ void CACHE::replacement_final_stats()
 {
     // Do nothing
     return;
-}
\ No newline at end of file
+}
+
+void CACHE::replacement_save_state(std::ostream& os)
+{
+    champsim::checkpoint::write(os, DUEL_IPV_Policy::cache_duel_state.at(this).current_winner);
+    champsim::checkpoint::write(os, DUEL_IPV_Policy::cache_duel_state.at(this).victim_rng);
+    for (const auto& policy : DUEL_IPV_Policy::policies.at(this))
+        policy.save_state(os);
+}
+
+void CACHE::replacement_restore_state(std::istream& is)
+{
+    // The retired instruction counts start over after a restore, so the epoch in progress does too
+    DUEL_IPV_Policy::DuelingState* global_state = &DUEL_IPV_Policy::cache_duel_state.at(this);
+    champsim::checkpoint::read(is, global_state->current_winner);
+    champsim::checkpoint::read(is, global_state->victim_rng);
+    global_state->policy_instr_misses = 0;
+    global_state->policy_data_misses = 0;
+    global_state->last_epoch_instrs = 0;
+
+    for (auto& policy : DUEL_IPV_Policy::policies.at(this))
+        policy.restore_state(is);
+}
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "cache.h"
+#include "checkpoint.h"
 
 namespace
 {
@@ -33,3 +34,7 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
 }
 
 void CACHE::replacement_final_stats() {}
+
+void CACHE::replacement_save_state(std::ostream& os) { champsim::checkpoint::write(os, ::last_used_cycles[this]); }
+
+void CACHE::replacement_restore_state(std::istream& is) { champsim::checkpoint::read(is, ::last_used_cycles[this]); }
@@ -5,9 +5,11 @@
 #include <algorithm>
 #include <cassert>
 #include <map>
+#include <random>
 #include <unordered_set>
 
 #include "cache.h"
+#include "checkpoint.h"
 
 namespace PACIPV_Policy
 {
@@ -76,7 +78,7 @@ namespace PACIPV_Policy
                                 rrpvs.at(way) = new_rrpv;
                         }
 
-                        uint32_t find_victim()
+                        uint32_t find_victim(std::minstd_rand& rng)
                         {
                                 // Find the maximum valid RRPV
                                 uint32_t max_valid_rrpv = demand_vector.size() - 1;
@@ -101,19 +103,33 @@ namespace PACIPV_Policy
                                 assert(victims.size() > 0 && victims.size() <= num_ways);
 
                                 // Randomly pick one of the ways in the victims set
-                                std::size_t idx = rand() % victims.size();
+                                std::size_t idx = rng() % victims.size();
                                 decltype(victims)::const_iterator it = victims.cbegin();
                                 std::advance(it, idx);
                                 return static_cast<uint32_t>(*it);
                         }
+
+                        void save_state(std::ostream& os) const
+                        {
+                                champsim::checkpoint::write(os, rrpvs);
+                        }
+
+                        void restore_state(std::istream& is)
+                        {
+                                champsim::checkpoint::read(is, rrpvs);
+                        }
         };
 
         std::map<CACHE*, std::vector<PACIPV>> policies;
+
+        // Each cache draws its random victims from a generator of its own, so that caches do not affect each other's choices
+        std::map<CACHE*, std::minstd_rand> victim_rngs;
 }
 
 void CACHE::initialize_replacement()
 {
         PACIPV_Policy::policies[this] = std::vector<PACIPV_Policy::PACIPV>();
+        PACIPV_Policy::victim_rngs[this] = std::minstd_rand{};
 
         // Get the cache type
         PACIPV_Policy::cache_type cache;
@@ -232,9 +248,9 @@ uint32_t CACHE::find_victim(
                 )
 {
         // Run sanity check
-        assert(set < PACIPV_Policy::policies[this].size());
+        assert(set < PACIPV_Policy::policies.at(this).size());
 
-        return PACIPV_Policy::policies[this][set].find_victim();
+        return PACIPV_Policy::policies.at(this)[set].find_victim(PACIPV_Policy::victim_rngs.at(this));
 }
 
 void CACHE::update_replacement_state(
@@ -250,7 +266,7 @@ void CACHE::update_replacement_state(
 {
         // Run sanity checks
         assert(way < NUM_WAY);
-        assert(set < PACIPV_Policy::policies[this].size());
+        assert(set < PACIPV_Policy::policies.at(this).size());
 
         // Figure out if access was a prefetch access
         int was_prefetch = access_type{type} == access_type::PREFETCH;
@@ -258,16 +274,16 @@ void CACHE::update_replacement_state(
         if(was_prefetch)  // Handle prefetch access
         {
                 if(hit)
-                        PACIPV_Policy::policies[this].at(set).prefetch_promote(way);
+                        PACIPV_Policy::policies.at(this).at(set).prefetch_promote(way);
                 else
-                        PACIPV_Policy::policies[this].at(set).prefetch_insert(way);
+                        PACIPV_Policy::policies.at(this).at(set).prefetch_insert(way);
         }
         else    // Handle demand access
         {
                 if(hit)
-                        PACIPV_Policy::policies[this].at(set).demand_promote(way);
+                        PACIPV_Policy::policies.at(this).at(set).demand_promote(way);
                 else
-                        PACIPV_Policy::policies[this].at(set).demand_insert(way);
+                        PACIPV_Policy::policies.at(this).at(set).demand_insert(way);
         }
 }
 
@@ -276,3 +292,17 @@ void CACHE::replacement_final_stats()
         // Do nothing
         return;
 }
+
+void CACHE::replacement_save_state(std::ostream& os)
+{
+        champsim::checkpoint::write(os, PACIPV_Policy::victim_rngs.at(this));
+        for(const auto& policy: PACIPV_Policy::policies.at(this))
+                policy.save_state(os);
+}
+
+void CACHE::replacement_restore_state(std::istream& is)
+{
+        champsim::checkpoint::read(is, PACIPV_Policy::victim_rngs.at(this));
+        for(auto& policy: PACIPV_Policy::policies.at(this))
+                policy.restore_state(is);
+}
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "cache.h"
+#include "checkpoint.h"
 #include "msl/bits.h"
 
 namespace
@@ -57,6 +58,10 @@ void CACHE::initialize_replacement()
   sampler.emplace(this, ::SAMPLER_SET * NUM_WAY);
 
   ::rrpv_values[this] = std::vector<int>(NUM_SET * NUM_WAY, ::maxRRPV);
+
+  // Create the counter tables now, so that the map is not modified while caches are simulated on other threads
+  for (std::size_t core = 0; core < NUM_CPUS; ++core)
+    ::SHCT[std::make_pair(this, core)];
 }
 
 // find replacement victim
@@ -137,3 +142,20 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
 
 // use this function to print out your own stats at the end of simulation
 void CACHE::replacement_final_stats() {}
+
+// The sampler sets are chosen the same way by every run, so they are not saved
+void CACHE::replacement_save_state(std::ostream& os)
+{
+  champsim::checkpoint::write(os, ::sampler[this]);
+  champsim::checkpoint::write(os, ::rrpv_values[this]);
+  for (std::size_t core = 0; core < NUM_CPUS; ++core)
+    champsim::checkpoint::write(os, ::SHCT[std::make_pair(this, core)]);
+}
+
+void CACHE::replacement_restore_state(std::istream& is)
+{
+  champsim::checkpoint::read(is, ::sampler[this]);
+  champsim::checkpoint::read(is, ::rrpv_values[this]);
+  for (std::size_t core = 0; core < NUM_CPUS; ++core)
+    champsim::checkpoint::read(is, ::SHCT[std::make_pair(this, core)]);
+}
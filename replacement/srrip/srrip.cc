@@ -1,6 +1,7 @@
 #include <cassert>
 
 #include "cache.h"
+#include "checkpoint.h"
 #include <unordered_map>
 
 namespace
@@ -43,3 +44,7 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
 
 // use this function to print out your own stats at the end of simulation
 void CACHE::replacement_final_stats() {}
+
+void CACHE::replacement_save_state(std::ostream& os) { champsim::checkpoint::write(os, ::rrpv_values[this]); }
+
+void CACHE::replacement_restore_state(std::istream& is) { champsim::checkpoint::read(is, ::rrpv_values[this]); }
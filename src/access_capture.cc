@@ -0,0 +1,152 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "access_capture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <fmt/core.h>
+
+#include "cache.h"
+
+namespace
+{
+struct capture_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+};
+
+constexpr char capture_magic[8] = {'C', 'S', 'A', 'C', 'C', 'E', 'S', 'S'};
+constexpr uint32_t capture_version = 1;
+constexpr std::size_t records_per_read = 4096;
+} // namespace
+
+champsim::access_capture_writer::access_capture_writer(std::string fname) : file(fname, std::ios::binary)
+{
+  if (!file)
+    throw std::runtime_error{fmt::format("Could not open {}", fname)};
+
+  capture_header header{};
+  std::copy(std::begin(capture_magic), std::end(capture_magic), std::begin(header.magic));
+  header.version = capture_version;
+  header.record_size = sizeof(cache_access);
+  writer.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void champsim::access_capture_writer::write(const cache_access& access) { writer.write(reinterpret_cast<const char*>(&access), sizeof(access)); }
+
+void champsim::access_capture_writer::close(const std::vector<uint64_t>& instructions)
+{
+  for (std::size_t cpu = 0; cpu < std::size(instructions); ++cpu) {
+    cache_access marker{};
+    marker.address = instructions[cpu];
+    marker.cpu = static_cast<uint32_t>(cpu);
+    marker.type = cache_access::instructions_marker;
+    write(marker);
+  }
+  writer.close();
+  file.close();
+}
+
+champsim::access_capture_reader::access_capture_reader(std::string fname) : stream(fname)
+{
+  capture_header header{};
+  stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (stream.gcount() != sizeof(header) || !std::equal(std::begin(capture_magic), std::end(capture_magic), std::begin(header.magic))
+      || header.version != capture_version || header.record_size != sizeof(cache_access))
+    throw std::runtime_error{fmt::format("{} is not a capture of cache accesses of this version", fname)};
+}
+
+bool champsim::access_capture_reader::read(cache_access& access)
+{
+  if (next == std::size(buffer)) {
+    if (stream.eof())
+      return false;
+
+    buffer.resize(records_per_read);
+    stream.read(reinterpret_cast<char*>(std::data(buffer)), static_cast<std::streamsize>(records_per_read * sizeof(cache_access)));
+    buffer.resize(static_cast<std::size_t>(stream.gcount()) / sizeof(cache_access));
+    next = 0;
+    if (std::empty(buffer))
+      return false;
+  }
+
+  access = buffer[next++];
+  return true;
+}
+
+auto champsim::replay_accesses(CACHE& cache, access_capture_reader& reader) -> replay_stats
+{
+  replay_stats stats;
+  stats.name = cache.NAME;
+
+  auto start = std::chrono::steady_clock::now();
+  cache_access access;
+  while (reader.read(access)) {
+    if (access.type == cache_access::instructions_marker) {
+      stats.instructions.resize(std::max<std::size_t>(std::size(stats.instructions), access.cpu + 1));
+      stats.instructions.at(access.cpu) = access.address;
+      continue;
+    }
+
+    if (access.cpu >= NUM_CPUS || access.type >= champsim::to_underlying(access_type::NUM_TYPES))
+      throw std::runtime_error{fmt::format("The captured access at cycle {} does not fit this configuration", access.cycle)};
+
+    const bool warmup = (access.flags & cache_access::warmup_flag) != 0;
+    cache.warmup = warmup;
+    cache.current_cycle = access.cycle;
+    auto hit = cache.replay_access(access.address, access.ip, access.cpu, access_type{access.type});
+
+    if (warmup) {
+      ++stats.warmup_accesses;
+    } else {
+      if (access.flags & cache_access::hit_flag)
+        ++stats.captured_hits;
+      ++(hit ? stats.hits : stats.misses).at(access.type).at(access.cpu);
+    }
+  }
+  stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  return stats;
+}
+
+uint64_t champsim::warm_with_accesses(CACHE& cache, access_capture_reader& reader)
+{
+  const auto cycle = cache.current_cycle;
+  const auto warmup = cache.warmup;
+  const auto cpu = cache.cpu;
+
+  // The accesses are captured in order, so the warmup ends with the first access after it
+  uint64_t count = 0;
+  cache_access access;
+  while (reader.read(access) && access.type != cache_access::instructions_marker && (access.flags & cache_access::warmup_flag) != 0) {
+    if (access.cpu >= NUM_CPUS || access.type >= champsim::to_underlying(access_type::NUM_TYPES))
+      throw std::runtime_error{fmt::format("The captured access at cycle {} does not fit this configuration", access.cycle)};
+
+    cache.warmup = true;
+    cache.current_cycle = access.cycle;
+    cache.replay_access(access.address, access.ip, access.cpu, access_type{access.type});
+    ++count;
+  }
+
+  cache.current_cycle = cycle;
+  cache.warmup = warmup;
+  cache.cpu = cpu;
+  return count;
+}
@@ -0,0 +1,309 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "batch.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "champsim.h"
+#include "champsim_constants.h"
+#include "checkpoint.h"
+#include "lockstep.h"
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+
+namespace champsim
+{
+class interval_stats_writer;
+class host_profiler;
+std::vector<phase_stats> simulate(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces, lockstep_options options,
+                                  checkpoint_options checkpoint, interval_stats_writer* intervals, host_profiler* profiler);
+}
+
+namespace
+{
+struct fanout_reader {
+  champsim::trace_fanout* fanout;
+  std::size_t trace;
+  std::size_t consumer;
+  uint64_t seq = 0;
+  std::shared_ptr<const champsim::trace_fanout::chunk_type> current = fanout->get(trace, consumer, seq);
+  std::size_t index = 0; // Either within the current chunk, or at its end if it is the last
+
+  ooo_model_instr operator()()
+  {
+    auto retval = current->instrs.at(index++);
+    if (index == std::size(current->instrs) && !current->last) {
+      current = fanout->get(trace, consumer, ++seq);
+      index = 0;
+    }
+    return retval;
+  }
+
+  bool eof() const { return index >= std::size(current->instrs); }
+};
+
+// Set the variables for the life of this object
+class scoped_environment_variables
+{
+  std::vector<std::pair<std::string, std::optional<std::string>>> saved;
+
+public:
+  explicit scoped_environment_variables(const std::vector<std::pair<std::string, std::string>>& variables)
+  {
+    for (const auto& [name, value] : variables) {
+      const char* old_value = std::getenv(name.c_str());
+      saved.emplace_back(name, old_value == nullptr ? std::nullopt : std::optional<std::string>{old_value});
+      setenv(name.c_str(), value.c_str(), 1);
+    }
+  }
+
+  ~scoped_environment_variables()
+  {
+    for (auto it = std::rbegin(saved); it != std::rend(saved); ++it) {
+      if (it->second.has_value())
+        setenv(it->first.c_str(), it->second->c_str(), 1);
+      else
+        unsetenv(it->first.c_str());
+    }
+  }
+
+  scoped_environment_variables(const scoped_environment_variables&) = delete;
+  scoped_environment_variables& operator=(const scoped_environment_variables&) = delete;
+};
+
+champsim::batch_result make_result(const champsim::environment_variant& variant, std::size_t num_traces, bool show_heartbeat)
+{
+  champsim::batch_result result{variant.name, champsim::make_variant(variant), {}};
+
+  auto cpus = result.env->cpu_view();
+  auto num_contexts = std::accumulate(std::begin(cpus), std::end(cpus), std::size_t{0}, [](auto acc, const O3_CPU& cpu) { return acc + std::size(cpu.threads); });
+  if (num_contexts != num_traces)
+    throw std::invalid_argument(fmt::format("Variant {} has {} thread contexts, but {} traces were given", variant.name, num_contexts, num_traces));
+
+  for (O3_CPU& cpu : cpus)
+    cpu.show_heartbeat = show_heartbeat;
+
+  return result;
+}
+} // namespace
+
+champsim::trace_fanout::trace_fanout(std::vector<tracereader>&& sources, std::size_t num_consumers, std::size_t lead)
+    : waiting(num_consumers, false), max_lead(lead)
+{
+  for (auto& source : sources)
+    traces.push_back({std::move(source), {}, 0, std::vector<uint64_t>(num_consumers, 0)});
+}
+
+champsim::tracereader champsim::trace_fanout::reader(std::size_t trace, std::size_t consumer) { return tracereader{fanout_reader{this, trace, consumer}}; }
+
+bool champsim::trace_fanout::held_back(const trace_state& state, uint64_t seq) const
+{
+  auto slowest = *std::min_element(std::begin(state.position), std::end(state.position));
+  if (seq < slowest + max_lead)
+    return false;
+
+  // Only wait for a consumer that is itself making progress
+  for (std::size_t consumer = 0; consumer < std::size(state.position); ++consumer) {
+    if (state.position[consumer] == slowest && !waiting[consumer])
+      return true;
+  }
+  return false;
+}
+
+auto champsim::trace_fanout::get(std::size_t trace, std::size_t consumer, uint64_t seq) -> std::shared_ptr<const chunk_type>
+{
+  std::unique_lock lock{mutex};
+  auto& state = traces.at(trace);
+  state.position.at(consumer) = seq;
+  progress.notify_all();
+
+  while (held_back(state, seq)) {
+    waiting.at(consumer) = true;
+    progress.notify_all();
+    progress.wait(lock);
+    waiting.at(consumer) = false;
+  }
+
+  while (state.first_chunk + std::size(state.chunks) <= seq) {
+    auto next = std::make_shared<chunk_type>();
+    next->instrs.reserve(chunk_size);
+    while (std::size(next->instrs) < chunk_size && !state.source.eof())
+      next->instrs.push_back(state.source());
+    next->last = state.source.eof();
+    state.chunks.push_back(std::move(next));
+  }
+
+  auto retval = state.chunks.at(seq - state.first_chunk);
+
+  // Release the chunks that every consumer has passed
+  auto slowest = *std::min_element(std::begin(state.position), std::end(state.position));
+  while (state.first_chunk < slowest && !std::empty(state.chunks)) {
+    state.chunks.pop_front();
+    ++state.first_chunk;
+  }
+
+  return retval;
+}
+
+void champsim::trace_fanout::finish(std::size_t consumer)
+{
+  std::lock_guard lock{mutex};
+  for (auto& state : traces)
+    state.position.at(consumer) = std::numeric_limits<uint64_t>::max();
+  progress.notify_all();
+}
+
+std::unique_ptr<champsim::environment> champsim::make_variant(const environment_variant& variant)
+{
+  scoped_environment_variables variables{variant.environment_variables};
+  auto env = variant.make();
+  for (champsim::operable& op : env->operable_view())
+    op.initialize();
+  return env;
+}
+
+auto champsim::run_batch(const std::vector<environment_variant>& variants, std::vector<phase_info>& phases, std::vector<tracereader>&& traces,
+                         bool show_heartbeat) -> std::vector<batch_result>
+{
+  std::vector<batch_result> results;
+  for (const auto& variant : variants)
+    results.push_back(make_result(variant, std::size(traces), show_heartbeat));
+
+  auto num_traces = std::size(traces);
+  trace_fanout fanout{std::move(traces), std::size(variants)};
+  std::vector<std::vector<tracereader>> variant_traces(std::size(variants));
+  for (std::size_t i = 0; i < std::size(variants); ++i) {
+    for (std::size_t trace = 0; trace < num_traces; ++trace)
+      variant_traces[i].push_back(fanout.reader(trace, i));
+  }
+
+  std::vector<std::exception_ptr> errors(std::size(variants));
+  std::vector<std::thread> workers;
+  for (std::size_t i = 0; i < std::size(variants); ++i) {
+    workers.emplace_back([&, i] {
+      // Modules that read the retired instruction counts must see this variant's
+      std::array<uint64_t, NUM_CPUS> instr_counts{};
+      current_instr_count = std::data(instr_counts);
+
+      try {
+        auto variant_phases = phases;
+        results[i].stats = simulate(*results[i].env, variant_phases, variant_traces[i], {}, {}, nullptr, nullptr);
+        fmt::print("Variant {} completed\n", results[i].name);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+      fanout.finish(i);
+    });
+  }
+
+  for (auto& worker : workers)
+    worker.join();
+
+  for (auto& error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  return results;
+}
+
+void champsim::run_batch_in_processes(const std::vector<environment_variant>& variants, std::vector<phase_info>& phases,
+                                      const std::function<std::vector<tracereader>()>& open_traces, bool show_heartbeat,
+                                      const std::function<void(batch_result&)>& report)
+{
+  struct child {
+    const environment_variant* variant;
+    pid_t pid;
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> report_file;
+  };
+
+  std::vector<child> children;
+  std::optional<std::runtime_error> start_error;
+  for (const auto& variant : variants) {
+    // The processes run at once, so each writes its report to a file of its own, which is printed when all have finished
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> report_file{std::tmpfile(), &std::fclose};
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    auto pid = (report_file != nullptr) ? fork() : -1;
+    if (pid < 0) {
+      start_error.emplace(fmt::format("Could not start the process for variant {}", variant.name));
+      break;
+    }
+
+    if (pid == 0) {
+      int status = EXIT_SUCCESS;
+      try {
+        auto traces = open_traces();
+        auto result = make_result(variant, std::size(traces), show_heartbeat);
+        auto variant_phases = phases;
+        result.stats = simulate(*result.env, variant_phases, traces, {}, {}, nullptr, nullptr);
+        fmt::print("Variant {} completed\n", result.name);
+
+        std::cout.flush();
+        std::fflush(nullptr);
+        if (dup2(fileno(report_file.get()), STDOUT_FILENO) < 0)
+          throw std::runtime_error("Could not redirect the report");
+        report(result);
+      } catch (const std::exception& e) {
+        fmt::print(stderr, "Variant {} failed: {}\n", variant.name, e.what());
+        status = EXIT_FAILURE;
+      }
+
+      // Leave without the destructors and exit handlers of the parent's objects
+      std::cout.flush();
+      std::fflush(nullptr);
+      _exit(status);
+    }
+
+    children.push_back({&variant, pid, std::move(report_file)});
+  }
+
+  // Every process that started is waited for, even if another failed
+  std::vector<std::string> failed;
+  for (auto& [variant, pid, report_file] : children) {
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+      failed.push_back(variant->name);
+      continue;
+    }
+
+    std::rewind(report_file.get());
+    std::array<char, 4096> buffer;
+    std::cout.flush();
+    for (std::size_t count; (count = std::fread(std::data(buffer), 1, std::size(buffer), report_file.get())) > 0;)
+      std::fwrite(std::data(buffer), 1, count, stdout);
+    std::fflush(stdout);
+  }
+
+  if (start_error.has_value())
+    throw start_error.value();
+  if (!std::empty(failed))
+    throw std::runtime_error(fmt::format("The simulation of variants {} failed", fmt::join(failed, ", ")));
+}
@@ -24,8 +24,10 @@
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
+#include "access_capture.h"
 #include "champsim.h"
 #include "champsim_constants.h"
+#include "checkpoint.h"
 #include "deadlock.h"
 #include "instruction.h"
 #include "util/algorithm.h"
@@ -34,13 +36,14 @@
 
 CACHE::tag_lookup_type::tag_lookup_type(request_type req, bool local_pref, bool skip)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
-      type(req.type), prefetch_from_this(local_pref), skip_fill(skip), is_translated(req.is_translated), instr_depend_on_me(req.instr_depend_on_me)
+      type(req.type), prefetch_from_this(local_pref), skip_fill(skip), is_translated(req.is_translated), timeline(req.timeline), instr_depend_on_me(req.instr_depend_on_me)
 {
 }
 
 CACHE::mshr_type::mshr_type(tag_lookup_type req, uint64_t cycle)
     : address(req.address), v_address(req.v_address), data(req.data), ip(req.ip), instr_id(req.instr_id), pf_metadata(req.pf_metadata), cpu(req.cpu),
-      type(req.type), prefetch_from_this(req.prefetch_from_this), cycle_enqueued(cycle), instr_depend_on_me(req.instr_depend_on_me), to_return(req.to_return)
+      type(req.type), prefetch_from_this(req.prefetch_from_this), cycle_enqueued(cycle), timeline(req.timeline), instr_depend_on_me(req.instr_depend_on_me),
+      to_return(req.to_return)
 {
 }
 
@@ -58,6 +61,7 @@ CACHE::mshr_type CACHE::mshr_type::merge(mshr_type predecessor, mshr_type succes
   retval.instr_depend_on_me = merged_instr;
   retval.to_return = merged_return;
   retval.data = predecessor.data;
+  retval.timeline = predecessor.timeline; // The latencies are those of the request that was sent to the lower level
 
   if (predecessor.event_cycle < std::numeric_limits<uint64_t>::max()) {
     retval.event_cycle = predecessor.event_cycle;
@@ -127,13 +131,26 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
     if (success) {
       auto evicting_address = (ever_seen_data ? way->address : way->v_address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
 
-      if (way->prefetch)
+      if (way->valid)
+        event_trace.record(champsim::packet_event::EVICT, fill_mshr, way_idx, way->address);
+      event_trace.record(champsim::packet_event::FILL, fill_mshr, way_idx);
+
+      if (way->prefetch) {
         ++sim_stats.pf_useless;
+        unused_prefetch_victims.fill(way->address);
+      } else if (way->valid && fill_mshr.type == access_type::PREFETCH) {
+        prefetch_fill_victims.fill(way->address);
+      }
 
       if (fill_mshr.type == access_type::PREFETCH)
         ++sim_stats.pf_fill;
 
+      take_ownership(static_cast<std::size_t>(std::distance(std::begin(block), way)), fill_mshr.cpu);
       *way = BLOCK{fill_mshr};
+      unused_prefetch_victims.invalidate(fill_mshr.address);
+      prefetch_fill_victims.invalidate(fill_mshr.address);
+      if (way->prefetch)
+        prefetch_fill_cycle[static_cast<std::size_t>(std::distance(std::begin(block), way))] = current_cycle;
 
       metadata_thru = impl_prefetcher_cache_fill(pkt_address, get_set_index(fill_mshr.address), way_idx, fill_mshr.type == access_type::PREFETCH,
                                                  evicting_address, metadata_thru);
@@ -156,7 +173,12 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
     // COLLECT STATS
     sim_stats.total_miss_latency += current_cycle - (fill_mshr.cycle_enqueued + 1);
 
+    auto timeline = fill_mshr.timeline;
+    timeline.mark(champsim::request_event::FILL, current_cycle);
+    record_latency(fill_mshr.type, timeline);
+
     response_type response{fill_mshr.address, fill_mshr.v_address, fill_mshr.data, metadata_thru, fill_mshr.instr_depend_on_me};
+    response.miss_depth = static_cast<uint8_t>(fill_mshr.miss_depth + 1);
     for (auto ret : fill_mshr.to_return)
       ret->push_back(response);
   }
@@ -170,8 +192,9 @@ bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
 
   // access cache
   auto [set_begin, set_end] = get_set_span(handle_pkt.address);
-  auto way = std::find_if(set_begin, set_end,
-                          [match = handle_pkt.address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return (entry.address >> shamt) == match; });
+  auto way = std::find_if(set_begin, set_end, [match = handle_pkt.address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) {
+    return entry.valid && (entry.address >> shamt) == match;
+  });
   const auto hit = (way != set_end);
   const auto useful_prefetch = (hit && way->prefetch && !handle_pkt.prefetch_from_this);
 
@@ -205,6 +228,9 @@ bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
     // update prefetch stats and reset prefetch bit
     if (useful_prefetch) {
       ++sim_stats.pf_useful;
+      ++sim_stats.pf_timely;
+      auto distance = current_cycle - prefetch_fill_cycle[static_cast<std::size_t>(std::distance(std::begin(block), way))];
+      ++sim_stats.pf_use_distance[champsim::log2_bucket(distance, std::size(sim_stats.pf_use_distance))];
       way->prefetch = false;
     }
   }
@@ -212,6 +238,75 @@ bool CACHE::try_hit(const tag_lookup_type& handle_pkt)
   return hit;
 }
 
+bool CACHE::replay_access(uint64_t address, uint64_t ip, uint32_t triggering_cpu, access_type type)
+{
+  cpu = triggering_cpu;
+
+  const auto set = static_cast<uint32_t>(get_set_index(address));
+  auto [set_begin, set_end] = get_set_span(address);
+  auto way = std::find_if(set_begin, set_end,
+                          [match = address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return entry.valid && (entry.address >> shamt) == match; });
+
+  if (way != set_end) {
+    impl_update_replacement_state(triggering_cpu, set, static_cast<uint32_t>(std::distance(set_begin, way)), way->address, ip, 0,
+                                  champsim::to_underlying(type), true);
+    way->dirty |= (type == access_type::WRITE);
+    return true;
+  }
+
+  way = std::find_if_not(set_begin, set_end, [](const auto& x) { return x.valid; });
+  if (way == set_end)
+    way = std::next(set_begin, impl_find_victim(triggering_cpu, 0, set, &*set_begin, ip, address, champsim::to_underlying(type)));
+  assert(set_begin <= way);
+  assert(way <= set_end);
+  const auto way_idx = static_cast<uint32_t>(std::distance(set_begin, way)); // cast protected by earlier assertion
+
+  uint64_t evicting_address = 0;
+  if (way != set_end) {
+    evicting_address = way->address & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
+    take_ownership(static_cast<std::size_t>(std::distance(std::begin(block), way)), triggering_cpu);
+    way->valid = true;
+    way->prefetch = false;
+    way->dirty = (type == access_type::WRITE);
+    way->address = address;
+    way->v_address = address;
+  }
+  impl_update_replacement_state(triggering_cpu, set, way_idx, address, ip, evicting_address, champsim::to_underlying(type), false);
+
+  return false;
+}
+
+void CACHE::capture_access(const tag_lookup_type& pkt, bool hit)
+{
+  if (access_capture == nullptr)
+    return;
+
+  champsim::cache_access access{};
+  access.address = pkt.address;
+  access.ip = pkt.ip;
+  access.cycle = current_cycle;
+  access.cpu = pkt.cpu;
+  access.type = static_cast<uint8_t>(champsim::to_underlying(pkt.type));
+  access.flags = static_cast<uint8_t>((hit ? champsim::cache_access::hit_flag : 0) | (warmup ? champsim::cache_access::warmup_flag : 0));
+  access_capture->write(access);
+}
+
+void CACHE::record_latency(access_type type, const champsim::request_timeline& timeline)
+{
+  using champsim::request_event;
+
+  // Writebacks are filled without visiting the lower level, and hits are never filled
+  auto before_fill = timeline.has(request_event::RETURN) ? request_event::RETURN : request_event::ISSUE;
+  auto finish = timeline.has(request_event::FILL) ? request_event::FILL : request_event::ISSUE;
+
+  sim_stats.latency.record(type, cache_hop::QUEUE, timeline.between(request_event::ENQUEUE, request_event::TAG_CHECK));
+  sim_stats.latency.record(type, cache_hop::TAG, timeline.between(request_event::TAG_CHECK, request_event::TAG_ATTEMPT));
+  sim_stats.latency.record(type, cache_hop::MSHR, timeline.between(request_event::TAG_ATTEMPT, request_event::ISSUE));
+  sim_stats.latency.record(type, cache_hop::LOWER, timeline.between(request_event::ISSUE, request_event::RETURN));
+  sim_stats.latency.record(type, cache_hop::FILL, timeline.between(before_fill, request_event::FILL));
+  sim_stats.latency.record(type, cache_hop::TOTAL, timeline.between(request_event::ENQUEUE, finish));
+}
+
 bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
 {
   if constexpr (champsim::debug_print) {
@@ -221,6 +316,7 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
   }
 
   mshr_type to_allocate{handle_pkt, current_cycle};
+  to_allocate.timeline.mark(champsim::request_event::ISSUE, current_cycle);
 
   cpu = handle_pkt.cpu;
 
@@ -234,10 +330,13 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
   {
     if (mshr_entry->type == access_type::PREFETCH && handle_pkt.type != access_type::PREFETCH) {
       // Mark the prefetch as useful
-      if (mshr_entry->prefetch_from_this)
+      if (mshr_entry->prefetch_from_this) {
         ++sim_stats.pf_useful;
+        ++sim_stats.pf_late;
+      }
     }
 
+    event_trace.record(champsim::packet_event::MSHR_MERGE, handle_pkt);
     *mshr_entry = mshr_type::merge(*mshr_entry, to_allocate);
   } else {
     if (mshr_full) { // not enough MSHR resource
@@ -283,9 +382,19 @@ bool CACHE::handle_miss(const tag_lookup_type& handle_pkt)
     if (fwd_pkt.response_requested) {
       MSHR.push_back(to_allocate);
       MSHR.back().pf_metadata = fwd_pkt.pf_metadata;
+    } else {
+      record_latency(to_allocate.type, to_allocate.timeline);
     }
   }
 
+  // Find whether the prefetcher caused this miss, by evicting the block too early or by filling over it
+  if (handle_pkt.type != access_type::PREFETCH) {
+    if (unused_prefetch_victims.invalidate(handle_pkt.address).has_value())
+      ++sim_stats.pf_early;
+    else if (prefetch_fill_victims.invalidate(handle_pkt.address).has_value())
+      ++sim_stats.pf_pollution;
+  }
+
   ++sim_stats.misses[champsim::to_underlying(handle_pkt.type)][handle_pkt.cpu];
 
   return true;
@@ -301,6 +410,7 @@ bool CACHE::handle_write(const tag_lookup_type& handle_pkt)
 
   inflight_writes.emplace_back(handle_pkt, current_cycle);
   inflight_writes.back().event_cycle = current_cycle + (warmup ? 0 : FILL_LATENCY);
+  inflight_writes.back().timeline.mark(champsim::request_event::ISSUE, current_cycle);
     
   ++sim_stats.misses[champsim::to_underlying(handle_pkt.type)][handle_pkt.cpu];
 
@@ -310,9 +420,11 @@ bool CACHE::handle_write(const tag_lookup_type& handle_pkt)
 template <bool UpdateRequest>
 auto CACHE::initiate_tag_check(champsim::channel* ul)
 {
-  return [cycle = current_cycle + (warmup ? 0 : HIT_LATENCY), ul](const auto& entry) {
+  return [this, now = current_cycle, cycle = current_cycle + (warmup ? 0 : HIT_LATENCY), ul](const auto& entry) {
     CACHE::tag_lookup_type retval{entry};
     retval.event_cycle = cycle;
+    retval.timeline.mark_first(champsim::request_event::TAG_CHECK, now);
+    this->event_trace.record(champsim::packet_event::TAG_CHECK, retval);
 
     if constexpr (UpdateRequest) {
       if (entry.response_requested)
@@ -332,8 +444,10 @@ long CACHE::operate()
 {
   long progress{0};
 
-  for (auto ul : upper_levels)
+  for (auto ul : upper_levels) {
     ul->check_collision();
+    ul->mark_arrivals(current_cycle);
+  }
 
   // Finish returns
   std::for_each(std::cbegin(lower_level->returned), std::cend(lower_level->returned), [this](const auto& pkt) { this->finish_packet(pkt); });
@@ -391,13 +505,25 @@ long CACHE::operate()
   inflight_tag_check.erase(last_not_missed, std::end(inflight_tag_check));
 
   // Perform tag checks
-  auto do_tag_check = [this](const auto& pkt) {
-    if (this->try_hit(pkt))
+  auto do_tag_check = [this](auto& pkt) {
+    pkt.timeline.mark_first(champsim::request_event::TAG_ATTEMPT, this->current_cycle);
+    if (this->try_hit(pkt)) {
+      this->capture_access(pkt, true);
+      this->event_trace.record(champsim::packet_event::HIT, pkt);
+      pkt.timeline.mark(champsim::request_event::ISSUE, this->current_cycle);
+      this->record_latency(pkt.type, pkt.timeline);
       return true;
+    }
+    bool success;
     if (pkt.type == access_type::WRITE && !this->match_offset_bits)
-      return this->handle_write(pkt); // Treat writes (that is, writebacks) like fills
+      success = this->handle_write(pkt); // Treat writes (that is, writebacks) like fills
     else
-      return this->handle_miss(pkt); // Treat writes (that is, stores) like reads
+      success = this->handle_miss(pkt); // Treat writes (that is, stores) like reads
+    if (success) {
+      this->capture_access(pkt, false);
+      this->event_trace.record(champsim::packet_event::MISS, pkt);
+    }
+    return success;
   };
   auto [tag_check_ready_begin, tag_check_ready_end] =
       champsim::get_span_p(std::begin(inflight_tag_check), std::end(inflight_tag_check), MAX_TAG,
@@ -409,6 +535,9 @@ long CACHE::operate()
 
   impl_prefetcher_cycle_operate();
 
+  if (occupancy_sample_period > 0 && current_cycle % occupancy_sample_period == 0)
+    sim_stats.occupancy.push_back(blocks_owned);
+
   if constexpr (champsim::debug_print) {
     fmt::print("[{}] {} cycle completed: {} tags checked: {} remaining: {} stash consumed: {} remaining: {} channel consumed: {} pq consumed {} unused consume bw {}\n", NAME, __func__, current_cycle,
         tag_bw_consumed, std::size(inflight_tag_check),
@@ -455,14 +584,31 @@ uint64_t CACHE::get_way(uint64_t address, uint64_t) const
 }
 // LCOV_EXCL_STOP
 
+void CACHE::take_ownership(std::size_t block_idx, uint32_t owner)
+{
+  release_ownership(block_idx);
+  block_owner[block_idx] = owner;
+  if (owner < NUM_CPUS)
+    ++blocks_owned[owner];
+}
+
+void CACHE::release_ownership(std::size_t block_idx)
+{
+  if (block[block_idx].valid && block_owner[block_idx] < NUM_CPUS)
+    --blocks_owned[block_owner[block_idx]];
+  block_owner[block_idx] = std::numeric_limits<uint32_t>::max();
+}
+
 uint64_t CACHE::invalidate_entry(uint64_t inval_addr)
 {
   auto [begin, end] = get_set_span(inval_addr);
-  auto inv_way =
-      std::find_if(begin, end, [match = inval_addr >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return (entry.address >> shamt) == match; });
+  auto inv_way = std::find_if(begin, end,
+                              [match = inval_addr >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return entry.valid && (entry.address >> shamt) == match; });
 
-  if (inv_way != end)
+  if (inv_way != end) {
+    release_ownership(static_cast<std::size_t>(std::distance(std::begin(block), inv_way)));
     inv_way->valid = 0;
+  }
 
   return std::distance(begin, inv_way);
 }
@@ -483,6 +629,8 @@ int CACHE::prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefet
   pf_packet.is_translated = !virtual_prefetch;
 
   internal_PQ.emplace_back(pf_packet, true, !fill_this_level);
+  internal_PQ.back().timeline.mark(champsim::request_event::ENQUEUE, current_cycle);
+  event_trace.record(champsim::packet_event::PREFETCH, pf_packet);
   ++sim_stats.pf_issued;
 
   return true;
@@ -511,7 +659,9 @@ void CACHE::finish_packet(const response_type& packet)
   // MSHR holds the most updated information about this request
   mshr_entry->data = packet.data;
   mshr_entry->pf_metadata = packet.pf_metadata;
+  mshr_entry->miss_depth = packet.miss_depth;
   mshr_entry->event_cycle = current_cycle + (warmup ? 0 : FILL_LATENCY);
+  mshr_entry->timeline.mark(champsim::request_event::RETURN, current_cycle);
 
   if constexpr (champsim::debug_print) {
     fmt::print("[{}_MSHR] {} instr_id: {} address: {:#x} data: {:#x} type: {} to_finish: {} event: {} current: {}\n", NAME, __func__, mshr_entry->instr_id,
@@ -682,6 +832,8 @@ void CACHE::begin_phase()
 
   new_roi_stats.name = NAME;
   new_sim_stats.name = NAME;
+  new_roi_stats.occupancy_sample_period = occupancy_sample_period;
+  new_sim_stats.occupancy_sample_period = occupancy_sample_period;
 
   roi_stats = new_roi_stats;
   sim_stats = new_sim_stats;
@@ -691,6 +843,8 @@ void CACHE::begin_phase()
     ul->roi_stats = ul_new_roi_stats;
     ul->sim_stats = ul_new_sim_stats;
   }
+
+  stats_registry.reset();
 }
 
 void CACHE::end_phase(unsigned finished_cpu)
@@ -715,6 +869,16 @@ void CACHE::end_phase(unsigned finished_cpu)
   roi_stats.pf_useful = sim_stats.pf_useful;
   roi_stats.pf_useless = sim_stats.pf_useless;
   roi_stats.pf_fill = sim_stats.pf_fill;
+  roi_stats.pf_timely = sim_stats.pf_timely;
+  roi_stats.pf_late = sim_stats.pf_late;
+  roi_stats.pf_early = sim_stats.pf_early;
+  roi_stats.pf_pollution = sim_stats.pf_pollution;
+  roi_stats.pf_use_distance = sim_stats.pf_use_distance;
+  roi_stats.latency = sim_stats.latency;
+  roi_stats.occupancy = sim_stats.occupancy;
+
+  sim_stats.modules = stats_registry.values();
+  roi_stats.modules = sim_stats.modules;
 
   for (auto ul : upper_levels) {
     ul->roi_stats.RQ_ACCESS = ul->sim_stats.RQ_ACCESS;
@@ -741,6 +905,42 @@ bool CACHE::should_activate_prefetcher(const T& pkt) const
   return ((1 << champsim::to_underlying(pkt.type)) & pref_activate_mask) && !pkt.prefetch_from_this;
 }
 
+void CACHE::save_checkpoint(std::ostream& os)
+{
+  champsim::checkpoint::write(os, NUM_SET);
+  champsim::checkpoint::write(os, NUM_WAY);
+  champsim::checkpoint::write(os, block);
+  champsim::checkpoint::write(os, block_owner);
+  champsim::checkpoint::write(os, prefetch_fill_cycle);
+  champsim::checkpoint::write_section(os, "prefetcher", [this](auto& s) { this->impl_prefetcher_save_state(s); });
+  champsim::checkpoint::write_section(os, "replacement", [this](auto& s) { this->impl_replacement_save_state(s); });
+}
+
+void CACHE::restore_checkpoint(std::istream& is)
+{
+  uint32_t sets = 0, ways = 0;
+  champsim::checkpoint::read(is, sets);
+  champsim::checkpoint::read(is, ways);
+  if (sets != NUM_SET || ways != NUM_WAY)
+    throw std::runtime_error("Checkpoint does not match this configuration: " + NAME + " has a different geometry");
+
+  champsim::checkpoint::read(is, block);
+  champsim::checkpoint::read(is, block_owner);
+  champsim::checkpoint::read(is, prefetch_fill_cycle);
+
+  blocks_owned = {};
+  for (std::size_t i = 0; i < std::size(block); ++i) {
+    if (block[i].valid && block_owner[i] < NUM_CPUS)
+      ++blocks_owned[block_owner[i]];
+  }
+
+  // Modules without the hooks keep their initial state
+  auto pref_state = champsim::checkpoint::read_section(is, "prefetcher");
+  impl_prefetcher_restore_state(pref_state);
+  auto repl_state = champsim::checkpoint::read_section(is, "replacement");
+  impl_replacement_restore_state(repl_state);
+}
+
 // LCOV_EXCL_START Exclude the following function from LCOV
 void CACHE::print_deadlock()
 {
@@ -19,9 +19,18 @@
 #include <algorithm>
 #include <chrono>
 #include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
 #include <vector>
 
+#include "access_capture.h"
+#include "checkpoint.h"
+#include "clock_schedule.h"
 #include "environment.h"
+#include "host_profile.h"
+#include "interval_stats.h"
+#include "lockstep.h"
 #include "ooo_cpu.h"
 #include "operable.h"
 #include "phase_info.h"
@@ -37,17 +46,55 @@ std::chrono::seconds elapsed_time() { return std::chrono::duration_cast<std::chr
 
 namespace champsim
 {
-phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader>& traces)
+phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader>& traces, lockstep_options options, interval_stats_writer* intervals,
+                     host_profiler* profiler)
 {
-  auto [phase_name, is_warmup, length, trace_index, trace_names] = phase;
+  auto [phase_name, is_warmup, length, trace_index, trace_names, skip_to] = phase;
   auto operables = env.operable_view();
 
+  // Fast-forward functionally. Instructions already read into the cores are kept, and begin the phase.
+  for (auto idx : trace_index) {
+    auto& trace = traces.at(idx);
+    if (auto distance = skip_to - trace.position(); trace.position() < skip_to) {
+      if (trace.skip(distance) < distance)
+        throw std::runtime_error(fmt::format("{} ended before instruction {}", trace_names.at(idx), skip_to));
+      fmt::print("{} fast-forwarded {} to instruction {}\n", phase_name, trace_names.at(idx), skip_to);
+    }
+  }
+
+  // Operate the cores on several host threads if requested. Like the serial loop, each phase starts from the configured order.
+  std::optional<lockstep_executor> executor;
+  if (options.jobs > 1)
+    executor.emplace(env, options);
+
   // Initialize phase
   for (champsim::operable& op : operables) {
     op.warmup = is_warmup;
     op.begin_phase();
   }
 
+  if (intervals != nullptr)
+    intervals->begin_phase(phase_name, env);
+
+  if (profiler != nullptr)
+    profiler->begin_phase(phase_name, env);
+
+  // The serial loop operates the elements in the order of their clock domains, without sorting them each cycle
+  clock_schedule schedule;
+  if (!executor.has_value())
+    schedule = clock_schedule{operables};
+
+  // Read from trace, one per hardware thread context
+  auto read_traces = [&] {
+    bool ended = false;
+    std::size_t context = 0;
+    for (O3_CPU& cpu : env.cpu_view()) {
+      ended = refill_input_queues(cpu, context, traces, trace_index) || ended;
+      context += std::size(cpu.threads);
+    }
+    return ended;
+  };
+
   // Perform phase
   int stalled_cycle{0};
   std::vector<bool> phase_complete(std::size(env.cpu_view()), false);
@@ -56,12 +103,26 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
 
     // Operate
     long progress{0};
-    for (champsim::operable& op : operables) {
-      progress += op._operate();
+    bool trace_ended = false;
+    if (executor.has_value()) {
+      std::tie(progress, trace_ended) = executor->operate(traces, trace_index);
+    } else if (profiler != nullptr && profiler->sample()) {
+      schedule.advance([&](champsim::operable& op) { progress += profiler->time(op, [&op] { return op._operate(); }); });
+      trace_ended = profiler->time_traces(read_traces);
+    } else {
+      progress += schedule.operate();
+      trace_ended = read_traces();
     }
 
+    // If any trace reaches EOF, terminate all phases
+    if (trace_ended)
+      std::fill(std::begin(next_phase_complete), std::end(next_phase_complete), true);
+
+    if (intervals != nullptr)
+      intervals->operate(env);
+
     if (progress == 0) {
-      ++stalled_cycle;
+      stalled_cycle += executor.has_value() ? static_cast<int>(executor->cycles_per_operate()) : 1;
     } else {
       stalled_cycle = 0;
     }
@@ -71,24 +132,11 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
       abort();
     }
 
-    std::sort(std::begin(operables), std::end(operables),
-              [](const champsim::operable& lhs, const champsim::operable& rhs) { return lhs.leap_operation < rhs.leap_operation; });
-
-    // Read from trace
-    for (O3_CPU& cpu : env.cpu_view()) {
-      auto& trace = traces.at(trace_index.at(cpu.cpu));
-      for (auto pkt_count = cpu.IN_QUEUE_SIZE - static_cast<long>(std::size(cpu.input_queue)); !trace.eof() && pkt_count > 0; --pkt_count)
-        cpu.input_queue.push_back(trace());
-
-      // If any trace reaches EOF, terminate all phases
-      if (trace.eof())
-        std::fill(std::begin(next_phase_complete), std::end(next_phase_complete), true);
-    }
-
     // Check for phase finish
     for (O3_CPU& cpu : env.cpu_view()) {
-      // Phase complete
-      next_phase_complete[cpu.cpu] = next_phase_complete[cpu.cpu] || (cpu.sim_instr() >= length);
+      // Phase complete when every thread has run the phase length
+      next_phase_complete[cpu.cpu] = next_phase_complete[cpu.cpu]
+                                     || std::all_of(std::begin(cpu.threads), std::end(cpu.threads), [length = length](const auto& x) { return x.sim_instr() >= length; });
     }
 
     for (O3_CPU& cpu : env.cpu_view()) {
@@ -104,6 +152,12 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
     phase_complete = next_phase_complete;
   }
 
+  if (intervals != nullptr)
+    intervals->end_phase(env);
+
+  if (profiler != nullptr)
+    profiler->end_phase(env);
+
   for (O3_CPU& cpu : env.cpu_view()) {
     fmt::print("{} complete CPU {} instructions: {} cycles: {} cumulative IPC: {:.4g} (Simulation time: {:%H hr %M min %S sec})\n", phase_name, cpu.cpu,
                cpu.sim_instr(), cpu.sim_cycle(), std::ceil(cpu.sim_instr()) / std::ceil(cpu.sim_cycle()), elapsed_time());
@@ -133,18 +187,51 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
 }
 
 // simulation entry point
-std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces)
+std::vector<phase_stats> simulate(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces, lockstep_options options,
+                                  checkpoint_options checkpoint, interval_stats_writer* intervals, host_profiler* profiler)
 {
-  for (champsim::operable& op : env.operable_view())
-    op.initialize();
+  // A restored checkpoint replaces the warmup. The last-level caches may instead be warmed by replaying the accesses captured in the warmup,
+  // so that their replacement policies are trained without simulating the warmup again.
+  bool skip_warmup = false;
+  if (!std::empty(checkpoint.restore_file)) {
+    const bool warm_llc = !std::empty(checkpoint.llc_warmup_file);
+    checkpoint::restore(checkpoint.restore_file, env, traces, phases.front().trace_index, !warm_llc);
+    skip_warmup = true;
+    fmt::print("Restored checkpoint {}{}\n", checkpoint.restore_file, warm_llc ? " (except the last-level caches)" : "");
+
+    for (CACHE& cache : env.cache_view()) {
+      if (warm_llc && champsim::is_last_level(cache, env.dram_view())) {
+        access_capture_reader reader{checkpoint.llc_warmup_file};
+        auto count = warm_with_accesses(cache, reader);
+        fmt::print("Warmed {} with {} accesses from {}\n", cache.NAME, count, checkpoint.llc_warmup_file);
+      }
+    }
+  }
 
   std::vector<phase_stats> results;
   for (auto phase : phases) {
-    auto stats = do_phase(phase, env, traces);
+    if (phase.is_warmup && skip_warmup)
+      continue;
+
+    auto stats = do_phase(phase, env, traces, options, intervals, profiler);
     if (!phase.is_warmup)
       results.push_back(stats);
+
+    if (phase.is_warmup && !std::empty(checkpoint.save_file)) {
+      checkpoint::save(checkpoint.save_file, env);
+      fmt::print("Saved checkpoint {}\n", checkpoint.save_file);
+    }
   }
 
   return results;
 }
+
+std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces, lockstep_options options,
+                              checkpoint_options checkpoint, interval_stats_writer* intervals, host_profiler* profiler)
+{
+  for (champsim::operable& op : env.operable_view())
+    op.initialize();
+
+  return simulate(env, phases, traces, options, checkpoint, intervals, profiler);
+}
 } // namespace champsim
@@ -144,10 +144,12 @@ bool champsim::channel::add_rq(const request_type& packet)
 
   auto result = do_add_queue(RQ, RQ_SIZE, packet);
 
-  if (result)
+  if (result) {
     sim_stats.RQ_TO_CACHE++;
-  else
+    event_trace.record(packet_event::ADD_RQ, packet);
+  } else {
     sim_stats.RQ_FULL++;
+  }
 
   return result;
 }
@@ -158,10 +160,12 @@ bool champsim::channel::add_wq(const request_type& packet)
 
   auto result = do_add_queue(WQ, WQ_SIZE, packet);
 
-  if (result)
+  if (result) {
     sim_stats.WQ_TO_CACHE++;
-  else
+    event_trace.record(packet_event::ADD_WQ, packet);
+  } else {
     sim_stats.WQ_FULL++;
+  }
 
   return result;
 }
@@ -172,10 +176,12 @@ bool champsim::channel::add_pq(const request_type& packet)
 
   auto fwd_pkt = packet;
   auto result = do_add_queue(PQ, PQ_SIZE, fwd_pkt);
-  if (result)
+  if (result) {
     sim_stats.PQ_TO_CACHE++;
-  else
+    event_trace.record(packet_event::ADD_PQ, fwd_pkt);
+  } else {
     sim_stats.PQ_FULL++;
+  }
 
   return result;
 }
@@ -191,3 +197,14 @@ std::size_t champsim::channel::rq_size() const { return RQ_SIZE; }
 std::size_t champsim::channel::wq_size() const { return WQ_SIZE; }
 
 std::size_t champsim::channel::pq_size() const { return PQ_SIZE; }
+
+void champsim::channel::mark_arrivals(uint64_t cycle)
+{
+  if constexpr (champsim::track_latency) {
+    // Requests are appended, so the unstamped ones are at the back of each queue
+    for (auto q : {std::ref(RQ), std::ref(PQ), std::ref(WQ)}) {
+      for (auto it = std::rbegin(q.get()); it != std::rend(q.get()) && !it->timeline.has(request_event::ENQUEUE); ++it)
+        it->timeline.mark(request_event::ENQUEUE, cycle);
+    }
+  }
+}
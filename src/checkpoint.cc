@@ -0,0 +1,146 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "checkpoint.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "environment.h"
+#include "tracereader.h"
+#include "vmem.h"
+
+namespace
+{
+constexpr std::string_view checkpoint_magic{"champsim-checkpoint"};
+constexpr uint32_t checkpoint_version = 3;
+
+void write_timing(std::ostream& os, const champsim::operable& op)
+{
+  champsim::checkpoint::write(os, op.current_cycle);
+  champsim::checkpoint::write(os, op.leap_operation);
+}
+
+void read_timing(std::istream& is, champsim::operable& op)
+{
+  champsim::checkpoint::read(is, op.current_cycle);
+  champsim::checkpoint::read(is, op.leap_operation);
+}
+
+VirtualMemory* get_vmem(champsim::environment& env)
+{
+  auto ptws = env.ptw_view();
+  if (std::empty(ptws))
+    return nullptr;
+  return ptws.front().get().vmem;
+}
+} // namespace
+
+void champsim::checkpoint::save(const std::string& fname, environment& env)
+{
+  std::ofstream os{fname, std::ios::binary};
+  if (!os)
+    throw std::runtime_error("Could not open checkpoint file " + fname + " for writing");
+
+  write(os, checkpoint_magic);
+  write(os, checkpoint_version);
+
+  write_section(os, "vmem", [vmem = get_vmem(env)](auto& s) {
+    if (vmem != nullptr)
+      vmem->save_checkpoint(s);
+  });
+
+  for (O3_CPU& cpu : env.cpu_view()) {
+    write_section(os, "cpu" + std::to_string(cpu.cpu), [&cpu](auto& s) {
+      write_timing(s, cpu);
+
+      // Each hardware thread resumes after the last instruction it retired
+      std::vector<uint64_t> positions;
+      std::transform(std::begin(cpu.threads), std::end(cpu.threads), std::back_inserter(positions), [](const auto& x) { return x.num_retired; });
+      write(s, positions);
+
+      cpu.save_checkpoint(s);
+    });
+  }
+
+  for (CACHE& cache : env.cache_view()) {
+    write_section(os, cache.NAME, [&cache](auto& s) {
+      write_timing(s, cache);
+      cache.save_checkpoint(s);
+    });
+  }
+
+  for (PageTableWalker& ptw : env.ptw_view())
+    write_section(os, ptw.NAME, [&ptw](auto& s) { write_timing(s, ptw); });
+
+  write_section(os, "DRAM", [&dram = env.dram_view()](auto& s) { write_timing(s, dram); });
+
+  if (!os)
+    throw std::runtime_error("Could not write checkpoint file " + fname);
+}
+
+void champsim::checkpoint::restore(const std::string& fname, environment& env, std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index,
+                                   bool restore_llc)
+{
+  std::ifstream is{fname, std::ios::binary};
+  if (!is)
+    throw std::runtime_error("Could not open checkpoint file " + fname);
+
+  std::string magic;
+  uint32_t version = 0;
+  read(is, magic);
+  read(is, version);
+  if (magic != checkpoint_magic || version != checkpoint_version)
+    throw std::runtime_error(fname + " is not a checkpoint for this version of ChampSim");
+
+  auto vmem_state = read_section(is, "vmem");
+  if (auto vmem = get_vmem(env); vmem != nullptr)
+    vmem->restore_checkpoint(vmem_state);
+
+  std::size_t context = 0;
+  for (O3_CPU& cpu : env.cpu_view()) {
+    auto cpu_state = read_section(is, "cpu" + std::to_string(cpu.cpu));
+    read_timing(cpu_state, cpu);
+
+    std::vector<uint64_t> positions;
+    read(cpu_state, positions);
+    if (std::size(positions) != std::size(cpu.threads))
+      throw std::runtime_error("Checkpoint does not match this configuration: cpu" + std::to_string(cpu.cpu) + " has a different number of threads");
+
+    for (auto count : positions) {
+      auto& trace = traces.at(trace_index.at(context++));
+      if (trace.skip(count) < count)
+        throw std::runtime_error("Trace ended before reaching the checkpoint");
+    }
+
+    cpu.restore_checkpoint(cpu_state);
+  }
+
+  for (CACHE& cache : env.cache_view()) {
+    auto cache_state = read_section(is, cache.NAME);
+    read_timing(cache_state, cache);
+    if (restore_llc || !champsim::is_last_level(cache, env.dram_view()))
+      cache.restore_checkpoint(cache_state);
+  }
+
+  for (PageTableWalker& ptw : env.ptw_view()) {
+    auto ptw_state = read_section(is, ptw.NAME);
+    read_timing(ptw_state, ptw);
+  }
+
+  auto dram_state = read_section(is, "DRAM");
+  read_timing(dram_state, env.dram_view());
+}
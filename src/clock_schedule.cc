@@ -0,0 +1,67 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "clock_schedule.h"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <utility>
+
+champsim::clock_schedule::clock_schedule(std::vector<std::reference_wrapper<operable>> operables, std::size_t max_period)
+{
+  std::transform(std::begin(operables), std::end(operables), std::back_inserter(sorted),
+                 [](operable& op) { return std::pair{op.leap_operation, std::ref(op)}; });
+
+  // Follow the serial loop on copies of the leaps, until the order and the leaps repeat
+  std::vector<double> leap;
+  std::transform(std::begin(operables), std::end(operables), std::back_inserter(leap), [](const operable& op) { return op.leap_operation; });
+  std::vector<std::size_t> order(std::size(operables));
+  std::iota(std::begin(order), std::end(order), 0);
+
+  std::vector<step> found;
+  std::map<std::pair<std::vector<std::size_t>, std::vector<double>>, std::size_t> seen;
+  while (std::size(found) < max_period) {
+    auto [previous, inserted] = seen.try_emplace({order, leap}, std::size(found));
+    if (!inserted) {
+      steps = std::move(found);
+      loop_begin = previous->second;
+      return;
+    }
+
+    // As in operable::_operate()
+    auto& this_step = found.emplace_back();
+    for (auto idx : order) {
+      if (leap[idx] >= 1) {
+        leap[idx] -= 1;
+        this_step.idle.push_back(operables[idx]);
+      } else {
+        leap[idx] += operables[idx].get().CLOCK_SCALE;
+        this_step.due.push_back(operables[idx]);
+      }
+    }
+
+    // The same sort of the same keys gives the same order as sorting the elements themselves
+    std::sort(std::begin(order), std::end(order), [&leap](std::size_t lhs, std::size_t rhs) { return leap[lhs] < leap[rhs]; });
+  }
+}
+
+long champsim::clock_schedule::operate()
+{
+  long progress{0};
+  advance([&progress](operable& op) { progress += op._operate(); });
+  return progress;
+}
@@ -0,0 +1,140 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "decoded_trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+
+namespace
+{
+constexpr char decoded_trace_magic[8] = {'C', 'S', 'D', 'E', 'C', 'O', 'D', 'E'};
+
+template <typename It, typename T>
+unsigned char pack(It begin, It end, T* dest)
+{
+  return static_cast<unsigned char>(std::distance(dest, std::copy(begin, end, dest)));
+}
+} // namespace
+
+decoded_instr champsim::encode(const ooo_model_instr& instr)
+{
+  decoded_instr retval{};
+  retval.ip = instr.ip;
+  retval.branch_target = instr.branch_target;
+  retval.asid[0] = instr.asid[0];
+  retval.asid[1] = instr.asid[1];
+  retval.is_branch = instr.is_branch;
+  retval.branch_taken = instr.branch_taken;
+  retval.branch_type = instr.branch_type;
+  retval.num_destination_registers = pack(std::begin(instr.destination_registers), std::end(instr.destination_registers), retval.destination_registers);
+  retval.num_source_registers = pack(std::begin(instr.source_registers), std::end(instr.source_registers), retval.source_registers);
+  retval.num_destination_memory = pack(std::begin(instr.destination_memory), std::end(instr.destination_memory), retval.destination_memory);
+  retval.num_source_memory = pack(std::begin(instr.source_memory), std::end(instr.source_memory), retval.source_memory);
+  return retval;
+}
+
+champsim::decoded_trace_writer::decoded_trace_writer(std::ostream& os, bool asid_from_trace)
+    : out(os), flags(asid_from_trace ? DECODED_TRACE_ASID_FROM_TRACE : 0)
+{
+  // A placeholder, until the number of records is known
+  decoded_trace_header header{};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void champsim::decoded_trace_writer::write(const ooo_model_instr& instr)
+{
+  auto record = encode(instr);
+  out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+  ++count;
+}
+
+void champsim::decoded_trace_writer::close()
+{
+  decoded_trace_header header{};
+  std::copy(std::begin(decoded_trace_magic), std::end(decoded_trace_magic), std::begin(header.magic));
+  header.version = DECODED_TRACE_VERSION;
+  header.record_size = sizeof(decoded_instr);
+  header.flags = flags;
+  header.count = count;
+
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.flush();
+}
+
+void champsim::decoded_tracereader::unmapper::operator()(const char* addr) const { ::munmap(const_cast<char*>(addr), length); }
+
+champsim::decoded_tracereader::decoded_tracereader(uint8_t cpu_idx, std::string fname, bool sequential) : cpu(cpu_idx)
+{
+  auto fd = ::open(fname.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error{fmt::format("Could not open {}", fname)};
+
+  struct stat file_info;
+  if (::fstat(fd, &file_info) != 0 || static_cast<std::size_t>(file_info.st_size) < sizeof(decoded_trace_header)) {
+    ::close(fd);
+    throw std::runtime_error{fmt::format("{} is not a pre-decoded trace", fname)};
+  }
+
+  auto length = static_cast<std::size_t>(file_info.st_size);
+  auto addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // The mapping keeps the file open
+  if (addr == MAP_FAILED)
+    throw std::runtime_error{fmt::format("Could not map {}", fname)};
+  mapping = decltype(mapping){static_cast<const char*>(addr), unmapper{length}};
+
+  if (sequential)
+    ::madvise(addr, length, MADV_SEQUENTIAL);
+
+  decoded_trace_header header;
+  std::memcpy(&header, mapping.get(), sizeof(header));
+  if (!std::equal(std::begin(decoded_trace_magic), std::end(decoded_trace_magic), std::begin(header.magic)) || header.version != DECODED_TRACE_VERSION
+      || header.record_size != sizeof(decoded_instr))
+    throw std::runtime_error{fmt::format("{} is not a pre-decoded trace of this version", fname)};
+  if (header.count > (length - sizeof(header)) / sizeof(decoded_instr))
+    throw std::runtime_error{fmt::format("{} is shorter than its header claims", fname)};
+
+  count = header.count;
+  asid_from_trace = (header.flags & DECODED_TRACE_ASID_FROM_TRACE) != 0;
+}
+
+ooo_model_instr champsim::decoded_tracereader::operator()()
+{
+  decoded_instr record;
+  std::memcpy(&record, mapping.get() + sizeof(decoded_trace_header) + next * sizeof(decoded_instr), sizeof(record));
+  ++next;
+
+  if (!asid_from_trace) {
+    record.asid[0] = cpu;
+    record.asid[1] = cpu;
+  }
+  return ooo_model_instr{cpu, record};
+}
+
+uint64_t champsim::decoded_tracereader::skip(uint64_t skip_count)
+{
+  auto skipped = std::min(skip_count, count - next);
+  next += skipped;
+  return skipped;
+}
@@ -49,6 +49,11 @@ long MEMORY_CONTROLLER::operate()
 
   for (auto& channel : channels) {
     if (warmup) {
+      // Requests complete immediately, including any that were scheduled before a warmup phase began
+      for (auto& bank : channel.bank_request)
+        bank.valid = false;
+      channel.active_request = std::end(channel.bank_request);
+
       for (auto& entry : channel.RQ) {
         if (entry.has_value()) {
           response_type response{entry->address, entry->v_address, entry->data, entry->pf_metadata, entry->instr_depend_on_me};
@@ -73,6 +78,8 @@ long MEMORY_CONTROLLER::operate()
 
     // Finish request
     if (channel.active_request != std::end(channel.bank_request) && channel.active_request->event_cycle <= current_cycle) {
+      record_latency(channel, channel.active_request->pkt->value());
+
       response_type response{channel.active_request->pkt->value().address, channel.active_request->pkt->value().v_address,
                              channel.active_request->pkt->value().data, channel.active_request->pkt->value().pf_metadata,
                              channel.active_request->pkt->value().instr_depend_on_me};
@@ -89,6 +96,9 @@ long MEMORY_CONTROLLER::operate()
     // Check queue occupancy
     auto wq_occu = static_cast<std::size_t>(std::count_if(std::begin(channel.WQ), std::end(channel.WQ), [](const auto& x) { return x.has_value(); }));
     auto rq_occu = static_cast<std::size_t>(std::count_if(std::begin(channel.RQ), std::end(channel.RQ), [](const auto& x) { return x.has_value(); }));
+    ++channel.sim_stats.cycles;
+    ++channel.sim_stats.wq_occupancy[wq_occu];
+    ++channel.sim_stats.rq_occupancy[rq_occu];
 
     // Change modes if the queues are unbalanced
     if ((!channel.write_mode && (wq_occu >= DRAM_WRITE_HIGH_WM || (rq_occu == 0 && wq_occu > 0)))
@@ -116,6 +126,10 @@ long MEMORY_CONTROLLER::operate()
 
       // Invert the mode
       channel.write_mode = !channel.write_mode;
+      if (channel.write_mode)
+        ++channel.sim_stats.switches_to_write;
+      else
+        ++channel.sim_stats.switches_to_read;
     }
 
     // Look for requests to put on the bus
@@ -127,6 +141,8 @@ long MEMORY_CONTROLLER::operate()
         // Put this request on the data bus
         channel.active_request = iter_next_process;
         channel.active_request->event_cycle = current_cycle + DRAM_DBUS_RETURN_TIME;
+        channel.active_request->pkt->value().timeline.mark(champsim::request_event::BUS, current_cycle);
+        channel.sim_stats.dbus_cycle_busy += DRAM_DBUS_RETURN_TIME;
 
         if (iter_next_process->row_buffer_hit)
           if (channel.write_mode)
@@ -170,9 +186,16 @@ long MEMORY_CONTROLLER::operate()
         bool row_buffer_hit = (channel.bank_request[op_idx].open_row == op_row);
 
         // this bank is now busy
-        channel.bank_request[op_idx] = {true, row_buffer_hit, op_row, current_cycle + tCAS + (row_buffer_hit ? 0 : tRP + tRCD), iter_next_schedule};
-
+        auto row_open_cycle = current_cycle + (row_buffer_hit ? 0 : tRP + tRCD);
+        channel.bank_request[op_idx] = {true, row_buffer_hit, op_row, row_open_cycle + tCAS, iter_next_schedule};
+        if (!row_buffer_hit)
+          ++channel.sim_stats.bank_activations[op_idx];
+
+        iter_next_schedule->value().timeline.mark(champsim::request_event::SCHEDULE, current_cycle);
+        iter_next_schedule->value().timeline.mark(champsim::request_event::ACTIVATE, row_open_cycle);
+        iter_next_schedule->value().timeline.mark(champsim::request_event::CAS, row_open_cycle + tCAS);
         iter_next_schedule->value().scheduled = true;
+        event_trace.record(champsim::packet_event::DRAM_SCHEDULE, iter_next_schedule->value(), op_idx, row_buffer_hit);
         iter_next_schedule->value().event_cycle = std::numeric_limits<uint64_t>::max();
 
         ++progress;
@@ -274,10 +297,26 @@ void DRAM_CHANNEL::check_collision()
   }
 }
 
+void MEMORY_CONTROLLER::record_latency(DRAM_CHANNEL& channel, const DRAM_CHANNEL::request_type& pkt)
+{
+  using champsim::request_event;
+
+  auto timeline = pkt.timeline;
+  timeline.mark(request_event::COMPLETE, current_cycle);
+
+  channel.sim_stats.latency.record(pkt.type, dram_hop::QUEUE, timeline.between(request_event::ENQUEUE, request_event::SCHEDULE));
+  channel.sim_stats.latency.record(pkt.type, dram_hop::ACTIVATE, timeline.between(request_event::SCHEDULE, request_event::ACTIVATE));
+  channel.sim_stats.latency.record(pkt.type, dram_hop::CAS, timeline.between(request_event::ACTIVATE, request_event::CAS));
+  channel.sim_stats.latency.record(pkt.type, dram_hop::BUS, timeline.between(request_event::CAS, request_event::BUS));
+  channel.sim_stats.latency.record(pkt.type, dram_hop::TRANSFER, timeline.between(request_event::BUS, request_event::COMPLETE));
+  channel.sim_stats.latency.record(pkt.type, dram_hop::TOTAL, timeline.between(request_event::ENQUEUE, request_event::COMPLETE));
+}
+
 void MEMORY_CONTROLLER::initiate_requests()
 {
   // Initiate read requests
   for (auto ul : queues) {
+    ul->mark_arrivals(current_cycle);
     for (auto q : {std::ref(ul->RQ), std::ref(ul->PQ)}) {
       auto [begin, end] = champsim::get_span_p(std::cbegin(q.get()), std::cend(q.get()), [ul, this](const auto& pkt) { return this->add_rq(pkt, ul); });
       q.get().erase(begin, end);
@@ -290,7 +329,8 @@ void MEMORY_CONTROLLER::initiate_requests()
 }
 
 DRAM_CHANNEL::request_type::request_type(typename champsim::channel::request_type req)
-    : pf_metadata(req.pf_metadata), address(req.address), v_address(req.address), data(req.data), instr_depend_on_me(req.instr_depend_on_me)
+    : type(req.type), pf_metadata(req.pf_metadata), address(req.address), v_address(req.address), data(req.data), instr_id(req.instr_id),
+      timeline(req.timeline), instr_depend_on_me(req.instr_depend_on_me)
 {
   asid[0] = req.asid[0];
   asid[1] = req.asid[1];
@@ -0,0 +1,150 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "event_trace.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <fmt/core.h>
+#include <fmt/ostream.h>
+
+#include "environment.h"
+
+namespace
+{
+using namespace std::literals::string_view_literals;
+constexpr std::array<std::string_view, static_cast<std::size_t>(champsim::packet_event::NUM_EVENTS)> event_names{
+    "add RQ"sv, "add WQ"sv, "add PQ"sv, "prefetch"sv, "tag check"sv, "hit"sv, "miss"sv, "MSHR merge"sv, "fill"sv, "evict"sv, "DRAM schedule"sv};
+
+bool in_range(uint64_t value, const std::pair<uint64_t, uint64_t>& range) { return range.first <= value && value < range.second; }
+} // namespace
+
+bool champsim::event_tracer::filter_type::matches(const trace_event& event) const
+{
+  bool address_match = in_range(event.address, addresses) || (event.what == packet_event::EVICT && in_range(event.detail, addresses));
+  return address_match && in_range(event.time, times) && in_range(event.instr_id, instr_ids);
+}
+
+champsim::event_tracer::event_tracer(filter_type filter_, std::size_t capacity) : filter(filter_), ring(std::max<std::size_t>(capacity, 1)) {}
+
+uint32_t champsim::event_tracer::add_component(std::string name, const operable& clock)
+{
+  components.push_back({std::move(name), &clock});
+  return static_cast<uint32_t>(std::size(components) - 1);
+}
+
+void champsim::event_tracer::record(uint32_t component, packet_event what, uint64_t address, uint64_t instr_id, uint8_t type, uint64_t location,
+                                    uint64_t detail)
+{
+  const operable* clock = components.at(component).clock;
+
+  trace_event event;
+  event.time = static_cast<uint64_t>(std::llround(static_cast<double>(clock->current_cycle) * (clock->CLOCK_SCALE + 1)));
+  event.cycle = clock->current_cycle;
+  event.address = address;
+  event.instr_id = instr_id;
+  event.location = location;
+  event.detail = detail;
+  event.component = component;
+  event.what = what;
+  event.type = type;
+
+  if (!filter.matches(event))
+    return;
+
+  ring[next] = event;
+  next = (next + 1) % std::size(ring);
+  ++recorded;
+}
+
+auto champsim::event_tracer::events() const -> std::vector<trace_event>
+{
+  if (recorded < std::size(ring))
+    return {std::begin(ring), std::next(std::begin(ring), static_cast<std::ptrdiff_t>(next))};
+
+  // The buffer has wrapped, so the oldest event is the next to be overwritten
+  std::vector<trace_event> result;
+  result.reserve(std::size(ring));
+  std::rotate_copy(std::begin(ring), std::next(std::begin(ring), static_cast<std::ptrdiff_t>(next)), std::end(ring), std::back_inserter(result));
+  return result;
+}
+
+uint64_t champsim::event_tracer::dropped() const { return recorded - std::min<uint64_t>(recorded, std::size(ring)); }
+
+void champsim::event_tracer::write_json(std::ostream& os) const
+{
+  // Each track is a thread of one process, and one cycle of the fastest clock is shown as one microsecond
+  fmt::print(os, "{{\"otherData\":{{\"dropped events\":{}}},\"traceEvents\":[\n", dropped());
+
+  bool first = true;
+  auto separator = [&first] { return std::exchange(first, false) ? "" : ",\n"; };
+
+  for (std::size_t i = 0; i < std::size(components); ++i)
+    fmt::print(os, "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}", separator(), i, components[i].name);
+
+  for (const auto& event : events()) {
+    auto type_name = event.type < std::size(access_type_names) ? access_type_names[event.type] : "UNKNOWN"sv;
+    fmt::print(os, "{}{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"i\",\"s\":\"t\",\"ts\":{},\"pid\":0,\"tid\":{},\"args\":{{\"address\":\"{:#x}\",\"instr_id\":{},\"cycle\":{}",
+               separator(), event_names.at(static_cast<std::size_t>(event.what)), type_name, event.time, event.component, event.address, event.instr_id,
+               event.cycle);
+    if (event.what == packet_event::FILL)
+      fmt::print(os, ",\"way\":{}", event.location);
+    if (event.what == packet_event::EVICT)
+      fmt::print(os, ",\"way\":{},\"victim\":\"{:#x}\"", event.location, event.detail);
+    if (event.what == packet_event::DRAM_SCHEDULE)
+      fmt::print(os, ",\"bank\":{},\"row hit\":{}", event.location, event.detail != 0);
+    fmt::print(os, "}}}}");
+  }
+
+  fmt::print(os, "\n]}}\n");
+}
+
+void champsim::attach(event_tracer& tracer, environment& env)
+{
+  for (CACHE& cache : env.cache_view()) {
+    cache.event_trace = {&tracer, tracer.add_component(cache.NAME, cache)};
+    for (auto* ul : cache.upper_levels)
+      ul->event_trace = cache.event_trace;
+  }
+
+  MEMORY_CONTROLLER& dram = env.dram_view();
+  dram.event_trace = {&tracer, tracer.add_component("DRAM", dram)};
+  for (auto* ul : dram.upper_level_channels())
+    ul->event_trace = dram.event_trace;
+}
+
+std::optional<std::pair<uint64_t, uint64_t>> champsim::parse_range(std::string_view text)
+{
+  auto colon = text.find(':');
+  if (colon == std::string_view::npos)
+    return std::nullopt;
+
+  try {
+    std::size_t begin_len = 0, end_len = 0;
+    std::string begin_text{text.substr(0, colon)}, end_text{text.substr(colon + 1)};
+    auto begin = std::stoull(begin_text, &begin_len, 0);
+    auto end = std::stoull(end_text, &end_len, 0);
+    if (begin_len != std::size(begin_text) || end_len != std::size(end_text) || end < begin)
+      return std::nullopt;
+    return std::pair<uint64_t, uint64_t>{begin, end};
+  } catch (const std::logic_error&) {
+    return std::nullopt;
+  }
+}
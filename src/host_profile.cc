@@ -0,0 +1,109 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "host_profile.h"
+
+#include <algorithm>
+#include <numeric>
+#include <fmt/core.h>
+
+#include "environment.h"
+
+champsim::host_profiler::host_profiler(uint64_t period) : sample_period(std::max<uint64_t>(period, 1))
+{
+  constexpr int calibration_reads = 1000;
+  auto begin = clock_type::now();
+  for (int i = 0; i < calibration_reads; ++i)
+    [[maybe_unused]] volatile auto now = clock_type::now();
+  clock_overhead = (clock_type::now() - begin) / calibration_reads;
+}
+
+std::size_t champsim::host_profiler::index_of(const operable& op)
+{
+  auto found = std::find(std::begin(elements), std::end(elements), &op);
+  if (found != std::end(elements))
+    return static_cast<std::size_t>(std::distance(std::begin(elements), found));
+
+  elements.push_back(&op);
+  names.push_back(fmt::format("element {}", std::size(elements) - 1));
+  element_time.emplace_back();
+  return std::size(elements) - 1;
+}
+
+void champsim::host_profiler::begin_phase(std::string_view name, environment& env)
+{
+  for (const O3_CPU& cpu : env.cpu_view())
+    names.at(index_of(cpu)) = fmt::format("CPU {}", cpu.cpu);
+  for (const CACHE& cache : env.cache_view())
+    names.at(index_of(cache)) = cache.NAME;
+  for (const PageTableWalker& ptw : env.ptw_view())
+    names.at(index_of(ptw)) = ptw.NAME;
+  names.at(index_of(env.dram_view())) = "DRAM";
+
+  phase_name = name;
+  phase_begin = clock_type::now();
+}
+
+void champsim::host_profiler::end_phase(environment& env)
+{
+  seconds phase_time = clock_type::now() - phase_begin;
+  auto cpus = env.cpu_view();
+  auto phase_instrs = std::accumulate(std::begin(cpus), std::end(cpus), uint64_t{0}, [](auto acc, const O3_CPU& cpu) { return acc + cpu.sim_instr(); });
+
+  total_time += phase_time;
+  total_instrs += phase_instrs;
+
+  fmt::print("{} host time: {:.4g} seconds for {} instructions ({:.4g} KIPS)\n", phase_name, phase_time.count(), phase_instrs,
+             static_cast<double>(phase_instrs) / phase_time.count() / 1000);
+}
+
+auto champsim::host_profiler::breakdown() const -> std::vector<entry>
+{
+  std::vector<entry> result;
+  if (sampled_cycles == 0)
+    return result;
+
+  // Each element, and the reading of the traces, is timed once on each sampled cycle
+  auto scale = static_cast<double>(cycles) / static_cast<double>(sampled_cycles);
+  auto estimate = [&](seconds sampled) { return std::max(sampled - clock_overhead * sampled_cycles, seconds{}) * scale; };
+  for (std::size_t i = 0; i < std::size(elements); ++i)
+    result.push_back({names.at(i), estimate(element_time.at(i))});
+  result.push_back({"trace reading", estimate(trace_time)});
+
+  auto measured = std::accumulate(std::begin(result), std::end(result), seconds{}, [](auto acc, const entry& e) { return acc + e.time; });
+  result.push_back({"rest of loop", std::max(total_time - measured, seconds{})});
+  return result;
+}
+
+double champsim::host_profiler::kips() const { return total_time.count() > 0 ? static_cast<double>(total_instrs) / total_time.count() / 1000 : 0; }
+
+void champsim::host_profiler::print() const
+{
+  fmt::print("Host profile: {:.4g} seconds for {} instructions ({:.4g} KIPS)\n", total_time.count(), total_instrs, kips());
+
+  auto entries = breakdown();
+  if (std::empty(entries)) {
+    fmt::print("Host profile: no cycles were sampled, so the time is not broken down\n\n");
+    return;
+  }
+
+  fmt::print("Host profile: sampled {} of {} cycles\n", sampled_cycles, cycles);
+  for (const auto& [name, time] : entries) {
+    auto share = total_time.count() > 0 ? 100 * time / total_time : 0;
+    fmt::print("Host profile: {:<16s} {:>10.4g} seconds {:>6.2f}%\n", name, time.count(), share);
+  }
+  fmt::print("\n");
+}
@@ -0,0 +1,257 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "interval_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <fmt/core.h>
+
+#include "environment.h"
+#include "stats_printer.h"
+
+namespace
+{
+O3_CPU::stats_type difference(const O3_CPU::stats_type& now, const O3_CPU::stats_type& before)
+{
+  auto result = now;
+  result.begin_instrs = before.end_instrs;
+  result.begin_cycles = before.end_cycles;
+  result.thread_begin_instrs = before.thread_end_instrs;
+  result.total_rob_occupancy_at_branch_mispredict -= before.total_rob_occupancy_at_branch_mispredict;
+  std::transform(std::begin(now.total_branch_types), std::end(now.total_branch_types), std::begin(before.total_branch_types),
+                 std::begin(result.total_branch_types), std::minus{});
+  std::transform(std::begin(now.branch_type_misses), std::end(now.branch_type_misses), std::begin(before.branch_type_misses),
+                 std::begin(result.branch_type_misses), std::minus{});
+  result.retiring_cycles -= before.retiring_cycles;
+  result.frontend_l1i_cycles -= before.frontend_l1i_cycles;
+  result.frontend_other_cycles -= before.frontend_other_cycles;
+  result.bad_speculation_cycles -= before.bad_speculation_cycles;
+  result.backend_core_cycles -= before.backend_core_cycles;
+  std::transform(std::begin(now.backend_memory_cycles), std::end(now.backend_memory_cycles), std::begin(before.backend_memory_cycles),
+                 std::begin(result.backend_memory_cycles), std::minus{});
+  result.modules = champsim::difference(now.modules, before.modules);
+  return result;
+}
+
+CACHE::stats_type difference(const CACHE::stats_type& now, const CACHE::stats_type& before)
+{
+  auto result = now;
+  result.pf_requested -= before.pf_requested;
+  result.pf_issued -= before.pf_issued;
+  result.pf_useful -= before.pf_useful;
+  result.pf_useless -= before.pf_useless;
+  result.pf_fill -= before.pf_fill;
+  result.pf_timely -= before.pf_timely;
+  result.pf_late -= before.pf_late;
+  result.pf_early -= before.pf_early;
+  result.pf_pollution -= before.pf_pollution;
+  for (std::size_t i = 0; i < std::size(result.pf_use_distance); ++i)
+    result.pf_use_distance[i] -= before.pf_use_distance[i];
+  result.occupancy.erase(std::begin(result.occupancy), std::next(std::begin(result.occupancy), static_cast<std::ptrdiff_t>(std::size(before.occupancy))));
+
+  uint64_t total_miss = 0;
+  for (std::size_t type = 0; type < std::size(result.hits); ++type) {
+    for (std::size_t cpu = 0; cpu < std::size(result.hits[type]); ++cpu) {
+      result.hits[type][cpu] -= before.hits[type][cpu];
+      result.misses[type][cpu] -= before.misses[type][cpu];
+      total_miss += result.misses[type][cpu];
+    }
+  }
+
+  // The average is otherwise only computed at the end of the phase
+  result.total_miss_latency -= before.total_miss_latency;
+  result.avg_miss_latency = std::ceil(result.total_miss_latency) / std::ceil(total_miss);
+  result.latency = champsim::difference(now.latency, before.latency);
+  result.modules = champsim::difference(now.modules, before.modules);
+  return result;
+}
+
+champsim::channel::stats_type difference(const champsim::channel::stats_type& now, const champsim::channel::stats_type& before)
+{
+  auto result = now;
+  result.RQ_ACCESS -= before.RQ_ACCESS;
+  result.RQ_MERGED -= before.RQ_MERGED;
+  result.RQ_FULL -= before.RQ_FULL;
+  result.RQ_TO_CACHE -= before.RQ_TO_CACHE;
+  result.PQ_ACCESS -= before.PQ_ACCESS;
+  result.PQ_MERGED -= before.PQ_MERGED;
+  result.PQ_FULL -= before.PQ_FULL;
+  result.PQ_TO_CACHE -= before.PQ_TO_CACHE;
+  result.WQ_ACCESS -= before.WQ_ACCESS;
+  result.WQ_MERGED -= before.WQ_MERGED;
+  result.WQ_FULL -= before.WQ_FULL;
+  result.WQ_TO_CACHE -= before.WQ_TO_CACHE;
+  result.WQ_FORWARD -= before.WQ_FORWARD;
+  return result;
+}
+
+DRAM_CHANNEL::stats_type difference(const DRAM_CHANNEL::stats_type& now, const DRAM_CHANNEL::stats_type& before)
+{
+  auto result = now;
+  result.dbus_cycle_congested -= before.dbus_cycle_congested;
+  result.dbus_count_congested -= before.dbus_count_congested;
+  result.WQ_ROW_BUFFER_HIT -= before.WQ_ROW_BUFFER_HIT;
+  result.WQ_ROW_BUFFER_MISS -= before.WQ_ROW_BUFFER_MISS;
+  result.RQ_ROW_BUFFER_HIT -= before.RQ_ROW_BUFFER_HIT;
+  result.RQ_ROW_BUFFER_MISS -= before.RQ_ROW_BUFFER_MISS;
+  result.WQ_FULL -= before.WQ_FULL;
+  result.cycles -= before.cycles;
+  result.dbus_cycle_busy -= before.dbus_cycle_busy;
+  result.switches_to_write -= before.switches_to_write;
+  result.switches_to_read -= before.switches_to_read;
+  std::transform(std::begin(now.bank_activations), std::end(now.bank_activations), std::begin(before.bank_activations), std::begin(result.bank_activations),
+                 std::minus{});
+  std::transform(std::begin(now.rq_occupancy), std::end(now.rq_occupancy), std::begin(before.rq_occupancy), std::begin(result.rq_occupancy), std::minus{});
+  std::transform(std::begin(now.wq_occupancy), std::end(now.wq_occupancy), std::begin(before.wq_occupancy), std::begin(result.wq_occupancy), std::minus{});
+  result.latency = champsim::difference(now.latency, before.latency);
+  return result;
+}
+
+template <typename T>
+std::vector<T> difference_each(const std::vector<T>& now, const std::vector<T>& before)
+{
+  std::vector<T> result;
+  std::transform(std::begin(now), std::end(now), std::begin(before), std::back_inserter(result),
+                 [](const T& x, const T& y) { return ::difference(x, y); });
+  return result;
+}
+} // namespace
+
+uint64_t champsim::interval_stats::instrs() const
+{
+  return std::accumulate(std::begin(cpu_stats), std::end(cpu_stats), uint64_t{0}, [](auto acc, const auto& stats) { return acc + stats.instrs(); });
+}
+
+champsim::interval_stats champsim::snapshot(environment& env)
+{
+  interval_stats stats;
+
+  // The cores, and the modules, record where the phase ended only when it does
+  for (const O3_CPU& cpu : env.cpu_view()) {
+    auto cpu_stats = cpu.sim_stats;
+    cpu_stats.end_instrs = cpu.num_retired;
+    cpu_stats.end_cycles = cpu.current_cycle;
+    cpu_stats.thread_end_instrs.clear();
+    std::transform(std::begin(cpu.threads), std::end(cpu.threads), std::back_inserter(cpu_stats.thread_end_instrs),
+                   [](const auto& x) { return x.num_retired; });
+    cpu_stats.modules = cpu.stats_registry.values();
+    stats.cpu_stats.push_back(cpu_stats);
+  }
+
+  for (const CACHE& cache : env.cache_view()) {
+    stats.cache_stats.push_back(cache.sim_stats);
+    stats.cache_stats.back().modules = cache.stats_registry.values();
+    stats.cache_queue_stats.push_back(std::accumulate(std::begin(cache.upper_levels), std::end(cache.upper_levels), channel::stats_type{},
+                                                      [](auto acc, const channel* ul) {
+                                                        acc.RQ_ACCESS += ul->sim_stats.RQ_ACCESS;
+                                                        acc.RQ_MERGED += ul->sim_stats.RQ_MERGED;
+                                                        acc.RQ_FULL += ul->sim_stats.RQ_FULL;
+                                                        acc.RQ_TO_CACHE += ul->sim_stats.RQ_TO_CACHE;
+                                                        acc.PQ_ACCESS += ul->sim_stats.PQ_ACCESS;
+                                                        acc.PQ_MERGED += ul->sim_stats.PQ_MERGED;
+                                                        acc.PQ_FULL += ul->sim_stats.PQ_FULL;
+                                                        acc.PQ_TO_CACHE += ul->sim_stats.PQ_TO_CACHE;
+                                                        acc.WQ_ACCESS += ul->sim_stats.WQ_ACCESS;
+                                                        acc.WQ_MERGED += ul->sim_stats.WQ_MERGED;
+                                                        acc.WQ_FULL += ul->sim_stats.WQ_FULL;
+                                                        acc.WQ_TO_CACHE += ul->sim_stats.WQ_TO_CACHE;
+                                                        acc.WQ_FORWARD += ul->sim_stats.WQ_FORWARD;
+                                                        return acc;
+                                                      }));
+  }
+
+  const auto& dram = env.dram_view();
+  std::transform(std::begin(dram.channels), std::end(dram.channels), std::back_inserter(stats.dram_stats),
+                 [](const DRAM_CHANNEL& chan) { return chan.sim_stats; });
+
+  return stats;
+}
+
+champsim::interval_stats champsim::difference(const interval_stats& now, const interval_stats& before)
+{
+  interval_stats result;
+  result.phase = now.phase;
+  result.index = now.index;
+  result.cpu_stats = ::difference_each(now.cpu_stats, before.cpu_stats);
+  result.cache_stats = ::difference_each(now.cache_stats, before.cache_stats);
+  result.cache_queue_stats = ::difference_each(now.cache_queue_stats, before.cache_queue_stats);
+  result.dram_stats = ::difference_each(now.dram_stats, before.dram_stats);
+  return result;
+}
+
+champsim::interval_stats_writer::interval_stats_writer(std::string fname, uint64_t interval_instrs) : file(fname), interval(interval_instrs)
+{
+  if (!file)
+    throw std::runtime_error{fmt::format("Could not open {}", fname)};
+  if (interval == 0)
+    throw std::invalid_argument{"The interval must be at least one instruction"};
+}
+
+champsim::interval_stats_writer::~interval_stats_writer() { flush(); }
+
+void champsim::interval_stats_writer::begin_phase(std::string_view name, environment& env)
+{
+  phase_name = name;
+  index = 0;
+  next_boundary = interval;
+  last = snapshot(env);
+  cpus = env.cpu_view();
+}
+
+void champsim::interval_stats_writer::operate(environment& env)
+{
+  uint64_t retired = 0;
+  for (const O3_CPU& cpu : cpus)
+    retired += cpu.num_retired - cpu.sim_stats.begin_instrs;
+
+  if (retired >= next_boundary) {
+    write_interval(env);
+    next_boundary = (retired / interval + 1) * interval;
+  }
+}
+
+void champsim::interval_stats_writer::end_phase(environment& env)
+{
+  if (snapshot(env).instrs() > last.instrs())
+    write_interval(env);
+}
+
+void champsim::interval_stats_writer::write_interval(environment& env)
+{
+  auto now = snapshot(env);
+  auto stats = difference(now, last);
+  stats.phase = phase_name;
+  stats.index = index++;
+  write(stats);
+  last = std::move(now);
+}
+
+void champsim::interval_stats_writer::write(const interval_stats& stats)
+{
+  json_printer{pending}.print(stats);
+  if (pending.tellp() >= buffer_size)
+    flush();
+}
+
+void champsim::interval_stats_writer::flush()
+{
+  file << pending.str();
+  file.flush();
+  pending.str("");
+}
@@ -20,6 +20,34 @@
 #include "stats_printer.h"
 #include <nlohmann/json.hpp>
 
+namespace champsim
+{
+void to_json(nlohmann::json& j, const champsim::module_stats& stats)
+{
+  j = nlohmann::json::object();
+  for (const auto& [name, value] : stats.counters)
+    j[name] = value;
+  for (const auto& [name, buckets] : stats.histograms)
+    j[name] = buckets;
+}
+
+// The steps that were measured, by access type
+template <typename H, std::size_t N>
+nlohmann::json latency_json(const latency_histograms<H>& stats, const std::array<std::string_view, N>& hop_names)
+{
+  auto j = nlohmann::json::object();
+  for (std::size_t type = 0; type < stats.num_types; ++type) {
+    for (std::size_t hop = 0; hop < stats.num_hops; ++hop) {
+      if (auto count = stats.count(type, hop); count > 0) {
+        j[std::string{access_type_names.at(type)}][std::string{hop_names.at(hop)}] =
+            nlohmann::json{{"count", count}, {"total cycles", stats.total_cycles[type][hop]}, {"histogram", stats.buckets[type][hop]}};
+      }
+    }
+  }
+  return j;
+}
+} // namespace champsim
+
 void to_json(nlohmann::json& j, const O3_CPU::stats_type stats)
 {
   std::array<std::pair<std::string, std::size_t>, 6> types{
@@ -34,10 +62,31 @@ void to_json(nlohmann::json& j, const O3_CPU::stats_type stats)
   for (auto [name, idx] : types)
     mpki.emplace(name, stats.branch_type_misses[idx]);
 
+  nlohmann::json topdown{{"retiring", stats.retiring_cycles},
+                         {"frontend", {{"L1I", stats.frontend_l1i_cycles}, {"other", stats.frontend_other_cycles}}},
+                         {"bad speculation", stats.bad_speculation_cycles},
+                         {"backend memory",
+                          {{"L1D", stats.backend_memory_cycles[0]},
+                           {"L2C", stats.backend_memory_cycles[1]},
+                           {"LLC", stats.backend_memory_cycles[2]},
+                           {"DRAM", stats.backend_memory_cycles[3]}}},
+                         {"backend core", stats.backend_core_cycles}};
+
   j = nlohmann::json{{"instructions", stats.instrs()},
                      {"cycles", stats.cycles()},
                      {"Avg ROB occupancy at mispredict", std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / std::ceil(total_mispredictions)},
-                     {"mispredict", mpki}};
+                     {"mispredict", mpki},
+                     {"top-down cycles", topdown}};
+
+  if (std::size(stats.thread_begin_instrs) > 1) {
+    std::vector<nlohmann::json> threads;
+    for (std::size_t thread = 0; thread < std::size(stats.thread_begin_instrs); ++thread)
+      threads.push_back(nlohmann::json{{"instructions", stats.thread_instrs(thread)}});
+    j["threads"] = threads;
+  }
+
+  if (!stats.modules.empty())
+    j["modules"] = stats.modules;
 }
 
 void to_json(nlohmann::json& j, const CACHE::stats_type stats)
@@ -52,10 +101,21 @@ void to_json(nlohmann::json& j, const CACHE::stats_type stats)
   statsmap.emplace("prefetch issued", stats.pf_issued);
   statsmap.emplace("useful prefetch", stats.pf_useful);
   statsmap.emplace("useless prefetch", stats.pf_useless);
+  statsmap.emplace("timely prefetch", stats.pf_timely);
+  statsmap.emplace("late prefetch", stats.pf_late);
+  statsmap.emplace("early prefetch", stats.pf_early);
+  statsmap.emplace("prefetch pollution", stats.pf_pollution);
+  statsmap.emplace("prefetch use distance", stats.pf_use_distance);
   statsmap.emplace("miss latency", stats.avg_miss_latency);
   for (const auto& type : types) {
     statsmap.emplace(type.first, nlohmann::json{{"hit", stats.hits[type.second]}, {"miss", stats.misses[type.second]}});
   }
+  if (!stats.latency.empty())
+    statsmap.emplace("latency", champsim::latency_json(stats.latency, cache_hop_names));
+  if (!stats.modules.empty())
+    statsmap.emplace("modules", stats.modules);
+  if (!std::empty(stats.occupancy))
+    statsmap.emplace("occupancy", nlohmann::json{{"sample period", stats.occupancy_sample_period}, {"samples", stats.occupancy}});
 
   j = statsmap;
 }
@@ -66,11 +126,33 @@ void to_json(nlohmann::json& j, const DRAM_CHANNEL::stats_type stats)
                      {"RQ ROW_BUFFER_MISS", stats.RQ_ROW_BUFFER_MISS},
                      {"WQ ROW_BUFFER_HIT", stats.WQ_ROW_BUFFER_HIT},
                      {"WQ ROW_BUFFER_MISS", stats.WQ_ROW_BUFFER_MISS},
-                     {"AVG DBUS CONGESTED CYCLE", std::ceil(stats.dbus_cycle_congested) / std::ceil(stats.dbus_count_congested)}};
+                     {"AVG DBUS CONGESTED CYCLE", std::ceil(stats.dbus_cycle_congested) / std::ceil(stats.dbus_count_congested)},
+                     {"cycles", stats.cycles},
+                     {"DBUS BUSY CYCLES", stats.dbus_cycle_busy},
+                     {"DBUS UTILIZATION", stats.dbus_utilization()},
+                     {"BANDWIDTH GB/s", stats.bandwidth_gbps()},
+                     {"mode switches", {{"to write", stats.switches_to_write}, {"to read", stats.switches_to_read}}},
+                     {"bank activations", stats.bank_activations},
+                     {"RQ occupancy", stats.rq_occupancy},
+                     {"WQ occupancy", stats.wq_occupancy}};
+  if (!stats.latency.empty())
+    j["latency"] = champsim::latency_json(stats.latency, dram_hop_names);
 }
 
 namespace champsim
 {
+void to_json(nlohmann::json& j, const champsim::channel::stats_type stats)
+{
+  j = nlohmann::json{{"RQ", {{"access", stats.RQ_ACCESS}, {"merged", stats.RQ_MERGED}, {"full", stats.RQ_FULL}, {"to cache", stats.RQ_TO_CACHE}}},
+                     {"PQ", {{"access", stats.PQ_ACCESS}, {"merged", stats.PQ_MERGED}, {"full", stats.PQ_FULL}, {"to cache", stats.PQ_TO_CACHE}}},
+                     {"WQ",
+                      {{"access", stats.WQ_ACCESS},
+                       {"merged", stats.WQ_MERGED},
+                       {"full", stats.WQ_FULL},
+                       {"to cache", stats.WQ_TO_CACHE},
+                       {"forward", stats.WQ_FORWARD}}}};
+}
+
 void to_json(nlohmann::json& j, const champsim::phase_stats stats)
 {
   std::map<std::string, nlohmann::json> roi_stats;
@@ -88,8 +170,29 @@ void to_json(nlohmann::json& j, const champsim::phase_stats stats)
   std::map<std::string, nlohmann::json> statsmap{{"name", stats.name}, {"traces", stats.trace_names}};
   statsmap.emplace("roi", roi_stats);
   statsmap.emplace("sim", sim_stats);
+  if (auto tp = champsim::throughput(stats); tp.has_value()) {
+    statsmap.emplace("throughput", nlohmann::json{{"isolated IPC", stats.isolated_ipc},
+                                                  {"weighted speedup", tp->weighted_speedup},
+                                                  {"harmonic speedup", tp->harmonic_speedup},
+                                                  {"maximum slowdown", tp->maximum_slowdown},
+                                                  {"unfairness", tp->unfairness}});
+  }
   j = statsmap;
 }
 } // namespace champsim
 
 void champsim::json_printer::print(std::vector<phase_stats>& stats) { stream << nlohmann::json::array_t{std::begin(stats), std::end(stats)}; }
+
+void champsim::json_printer::print(const interval_stats& stats)
+{
+  std::map<std::string, nlohmann::json> caches;
+  for (std::size_t i = 0; i < std::size(stats.cache_stats); ++i) {
+    nlohmann::json cache = stats.cache_stats[i];
+    cache["queues"] = stats.cache_queue_stats.at(i);
+    caches.emplace(stats.cache_stats[i].name, cache);
+  }
+
+  nlohmann::json j{{"phase", stats.phase}, {"interval", stats.index}, {"instructions", stats.instrs()},
+                   {"cores", stats.cpu_stats}, {"caches", caches}, {"DRAM", stats.dram_stats}};
+  stream << j << '\n';
+}
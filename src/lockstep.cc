@@ -0,0 +1,245 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lockstep.h"
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <set>
+
+bool champsim::refill_input_queues(O3_CPU& cpu, std::size_t first_context, std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index)
+{
+  bool trace_ended = false;
+  for (std::size_t thread = 0; thread < std::size(cpu.threads); ++thread) {
+    auto& trace = traces.at(trace_index.at(first_context + thread));
+    for (auto pkt_count = cpu.IN_QUEUE_SIZE - static_cast<long>(std::size(cpu.threads[thread].input_queue)); !trace.eof() && pkt_count > 0; --pkt_count)
+      cpu.add_input(thread, trace());
+
+    trace_ended = trace_ended || trace.eof();
+  }
+
+  return trace_ended;
+}
+
+champsim::worker_pool::worker_pool(std::size_t num_workers)
+{
+  assert(num_workers > 0);
+  for (std::size_t i = 1; i < num_workers; ++i)
+    helpers.emplace_back(&worker_pool::helper_loop, this, i);
+}
+
+champsim::worker_pool::~worker_pool()
+{
+  stopping.store(true);
+  generation.fetch_add(1);
+  wake(task_ready, helpers_sleeping);
+  for (auto& helper : helpers)
+    helper.join();
+}
+
+template <typename Pred>
+void champsim::worker_pool::wait_until(std::condition_variable& cv, std::atomic<std::size_t>& sleeping, Pred pred)
+{
+  constexpr int spin_limit = 1024;
+  for (int i = 0; i < spin_limit; ++i) {
+    if (pred())
+      return;
+  }
+
+  std::unique_lock lock{mutex};
+  sleeping.fetch_add(1);
+  cv.wait(lock, pred);
+  sleeping.fetch_sub(1);
+}
+
+void champsim::worker_pool::wake(std::condition_variable& cv, const std::atomic<std::size_t>& sleeping)
+{
+  if (sleeping.load() > 0) {
+    std::lock_guard lock{mutex};
+    cv.notify_all();
+  }
+}
+
+void champsim::worker_pool::helper_loop(std::size_t index)
+{
+  uint64_t seen = 0;
+  while (true) {
+    // Wait for the next task
+    wait_until(task_ready, helpers_sleeping, [&] { return generation.load() != seen; });
+    seen = generation.load();
+
+    if (stopping.load())
+      return;
+
+    task_fn(task_context, index);
+    if (remaining.fetch_sub(1) == 1)
+      wake(task_done, caller_sleeping);
+  }
+}
+
+void champsim::worker_pool::run_task()
+{
+  remaining.store(std::size(helpers));
+  generation.fetch_add(1);
+  wake(task_ready, helpers_sleeping);
+
+  task_fn(task_context, 0);
+
+  wait_until(task_done, caller_sleeping, [&] { return remaining.load() == 0; });
+}
+
+champsim::lockstep_executor::lockstep_executor(environment& env, lockstep_options options)
+    : operables(env.operable_view()), quantum(std::max<uint64_t>(options.quantum, 1)), pool(std::max<std::size_t>(options.jobs, 1))
+{
+  auto cpus = env.cpu_view();
+
+  // Map each channel to the cache that consumes it
+  std::map<const champsim::channel*, CACHE*> consumers;
+  for (CACHE& cache : env.cache_view()) {
+    for (auto ul : cache.upper_levels)
+      consumers.emplace(ul, &cache);
+  }
+
+  // Find which cores reach each cache by following the channels down from the core
+  std::map<const operable*, std::set<uint32_t>> reached_by;
+  for (const O3_CPU& cpu : cpus) {
+    std::vector<const champsim::channel*> to_visit{cpu.L1I_bus.lower_level_channel(), cpu.L1D_bus.lower_level_channel()};
+    std::set<const CACHE*> visited;
+    while (!std::empty(to_visit)) {
+      auto found = consumers.find(to_visit.back());
+      to_visit.pop_back();
+
+      if (found != std::end(consumers) && visited.insert(found->second).second) {
+        reached_by[found->second].insert(cpu.cpu);
+        to_visit.push_back(found->second->lower_level);
+        if (found->second->lower_translate != nullptr)
+          to_visit.push_back(found->second->lower_translate);
+      }
+    }
+  }
+
+  // Each core's domain holds the core and the caches that only it reaches
+  std::size_t context = 0;
+  domains.reserve(std::size(cpus));
+  for (O3_CPU& cpu : cpus) {
+    domains.push_back({&cpu, context, {}, {}, {}});
+    context += std::size(cpu.threads);
+  }
+
+  for (operable& op : operables) {
+    domain* dom = nullptr;
+    if (auto cpu_it = std::find_if(std::begin(domains), std::end(domains), [&op](const auto& d) { return d.cpu == &op; }); cpu_it != std::end(domains)) {
+      dom = &*cpu_it;
+    } else if (auto reached = reached_by.find(&op); reached != std::end(reached_by) && std::size(reached->second) == 1) {
+      auto owner_cpu = *std::begin(reached->second);
+      dom = &*std::find_if(std::begin(domains), std::end(domains), [owner_cpu](const auto& d) { return d.cpu->cpu == owner_cpu; });
+    }
+
+    if (dom != nullptr) {
+      dom->operables.push_back(op);
+      owner.emplace_back(&op, dom);
+    } else {
+      shared_operables.push_back(op);
+    }
+  }
+
+  std::sort(std::begin(owner), std::end(owner));
+
+  serial_schedule = clock_schedule{operables};
+  shared_schedule = clock_schedule{shared_operables};
+  for (auto& dom : domains)
+    dom.schedule = clock_schedule{dom.operables};
+}
+
+auto champsim::lockstep_executor::owner_of(const operable& op) const -> domain*
+{
+  auto found = std::lower_bound(std::begin(owner), std::end(owner), &op, [](const auto& entry, const operable* key) { return entry.first < key; });
+  if (found != std::end(owner) && found->first == &op)
+    return found->second;
+  return nullptr;
+}
+
+void champsim::lockstep_executor::flush_pending(bool refill, std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index)
+{
+  auto task = [&, this](std::size_t worker) {
+    for (auto i = worker; i < std::size(this->domains); i += this->pool.size()) {
+      auto& dom = this->domains[i];
+      for (auto op : dom.pending)
+        dom.progress += op->_operate();
+      dom.pending.clear();
+
+      if (refill)
+        dom.trace_ended = refill_input_queues(*dom.cpu, dom.first_context, traces, trace_index) || dom.trace_ended;
+    }
+  };
+  pool.run(task);
+}
+
+long champsim::lockstep_executor::operate_cycle(std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index)
+{
+  long progress{0};
+
+  // Walk the serial order. Consecutive elements of different domains are independent and run concurrently, while a shared element waits
+  // for every domain to catch up to its position in the order.
+  serial_schedule.advance([&, this](operable& op) {
+    if (auto dom = this->owner_of(op); dom != nullptr) {
+      dom->pending.push_back(&op);
+    } else {
+      this->flush_pending(false, traces, trace_index);
+      progress += op._operate();
+    }
+  });
+  flush_pending(true, traces, trace_index);
+
+  return progress;
+}
+
+long champsim::lockstep_executor::operate_quantum(std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index)
+{
+  long progress{0};
+
+  auto task = [&, this](std::size_t worker) {
+    for (auto i = worker; i < std::size(this->domains); i += this->pool.size()) {
+      auto& dom = this->domains[i];
+      for (uint64_t cycle = 0; cycle < this->quantum; ++cycle) {
+        dom.progress += dom.schedule.operate();
+
+        dom.trace_ended = refill_input_queues(*dom.cpu, dom.first_context, traces, trace_index) || dom.trace_ended;
+      }
+    }
+  };
+  pool.run(task);
+
+  // The shared elements catch up to the domains
+  for (uint64_t cycle = 0; cycle < quantum; ++cycle)
+    progress += shared_schedule.operate();
+
+  return progress;
+}
+
+std::pair<long, bool> champsim::lockstep_executor::operate(std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index)
+{
+  auto progress = (quantum == 1) ? operate_cycle(traces, trace_index) : operate_quantum(traces, trace_index);
+
+  bool trace_ended = false;
+  for (auto& dom : domains) {
+    progress += std::exchange(dom.progress, 0);
+    trace_ended = std::exchange(dom.trace_ended, false) || trace_ended;
+  }
+
+  return {progress, trace_ended};
+}
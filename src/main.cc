@@ -15,24 +15,56 @@
  */
 
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <numeric>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
+#include "access_capture.h"
+#include "batch.h"
 #include "champsim.h"
 #include "champsim_constants.h"
+#include "checkpoint.h"
 #include "core_inst.inc"
+#include "decode_threads.h"
+#include "event_trace.h"
+#include "host_profile.h"
+#include "interval_stats.h"
+#include "lockstep.h"
 #include "phase_info.h"
+#include "results_report.h"
+#include "simpoint.h"
 #include "stats_printer.h"
 #include "tracereader.h"
 #include "vmem.h"
 #include <CLI/CLI.hpp>
 #include <fmt/core.h>
+#include <fmt/ranges.h>
+
+namespace
+{
+// Capture and replay follow the single cache that sends its misses to DRAM
+CACHE& only_last_level_cache(champsim::environment& env)
+{
+  std::vector<std::reference_wrapper<CACHE>> llcs;
+  for (CACHE& cache : env.cache_view()) {
+    if (champsim::is_last_level(cache, env.dram_view()))
+      llcs.push_back(cache);
+  }
+
+  if (std::size(llcs) != 1)
+    throw std::runtime_error{fmt::format("Capturing or replaying cache accesses requires a single last-level cache, but there are {}", std::size(llcs))};
+  return llcs.front();
+}
+} // namespace
 
 namespace champsim
 {
-std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces);
+std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces, lockstep_options options,
+                              checkpoint_options checkpoint, interval_stats_writer* intervals, host_profiler* profiler);
 }
 
 int main(int argc, char** argv)
@@ -44,10 +76,29 @@ int main(int argc, char** argv)
   bool knob_cloudsuite{false};
   uint64_t warmup_instructions = 0;
   uint64_t simulation_instructions = std::numeric_limits<uint64_t>::max();
+  uint64_t skip_instructions = 0;
+  std::size_t repeat_memory_mib = 0;
+  unsigned decode_threads = champsim::decode_threads;
   std::string json_file_name;
   std::vector<std::string> trace_names;
+  champsim::lockstep_options lockstep{};
+  champsim::checkpoint_options checkpoint{};
+  std::string simpoint_file_name;
+  std::size_t simpoint_clusters = 0;
+  std::string simpoint_output_name;
+  std::string capture_file_name;
+  std::string replay_file_name;
+  std::string interval_file_name;
+  uint64_t interval_instructions = 1000000;
+  std::string event_trace_file_name;
+  std::string event_trace_addresses, event_trace_cycles, event_trace_instrs;
+  std::size_t event_trace_size = champsim::event_tracer::default_capacity;
+  std::vector<std::string> isolated_ipc_files;
+  uint64_t occupancy_sample_period = 0;
+  bool show_heartbeat{true};
 
   auto set_heartbeat_callback = [&](auto) {
+    show_heartbeat = false;
     for (O3_CPU& cpu : gen_environment.cpu_view())
       cpu.show_heartbeat = false;
   };
@@ -62,15 +113,231 @@ int main(int argc, char** argv)
   auto deprec_sim_instr_option =
       app.add_option("--simulation_instructions", simulation_instructions, "[deprecated] use --simulation-instructions instead")->excludes(sim_instr_option);
 
+  auto skip_instr_option = app.add_option("--skip-instructions", skip_instructions,
+                                          "The number of instructions to skip at the start of each trace, before the warmup. "
+                                          "Traces in the seekable Zstandard format skip directly to the instruction; others are decompressed up to it.");
+
+  app.add_option("--repeat-in-memory", repeat_memory_mib,
+                 "Keep each trace that is repeated to reach the simulation instructions in memory, if it fits in this many MiB, "
+                 "and replay it rather than decompressing it again")
+      ->needs(sim_instr_option);
+
+  app.add_option("--decode-threads", decode_threads,
+                 "The number of host threads that decompress each trace. Seekable Zstandard traces and xz traces of several blocks, such as those "
+                 "written by xz -T, use them; other traces are decompressed on one.")
+      ->check(CLI::PositiveNumber);
+
   auto json_option =
       app.add_option("--json", json_file_name, "The name of the file to receive JSON output. If no name is specified, stdout will be used")->expected(0, 1);
 
-  app.add_option("traces", trace_names, "The paths to the traces")->required()->expected(NUM_CPUS)->check(CLI::ExistingFile);
+  app.add_option("-j,--jobs", lockstep.jobs, "The number of host threads used to operate the cores. Each core and its private caches run on one thread.")
+      ->check(CLI::PositiveNumber);
+  app.add_option("--quantum", lockstep.quantum,
+                 "The number of cycles the cores run between synchronizations with the shared caches when using more than one job. "
+                 "A quantum of 1 gives results identical to a single job.")
+      ->check(CLI::PositiveNumber);
+
+  auto save_option = app.add_option("--save-checkpoint", checkpoint.save_file, "Save the warmed state to this file at the end of the warmup phase");
+  auto restore_option =
+      app.add_option("--restore-checkpoint", checkpoint.restore_file, "Restore the warmed state from this file and skip the warmup phase")
+          ->check(CLI::ExistingFile)
+          ->excludes(skip_instr_option);
+  auto llc_warmup_option =
+      app.add_option("--checkpoint-llc-warmup", checkpoint.llc_warmup_file,
+                     "Do not restore the last-level cache from the checkpoint, but warm it with the warmup accesses recorded with --capture-llc by the run "
+                     "that saved the checkpoint, so that its replacement policy is trained")
+          ->check(CLI::ExistingFile)
+          ->needs(restore_option);
+
+  auto simpoint_option = app.add_option("--simpoints", simpoint_file_name,
+                                        "Simulate only the intervals listed in this file, one per line as the first instruction and the weight. "
+                                        "Each interval runs for the simulation instructions after a warmup, which is shortened if it would overlap the previous interval, "
+                                        "and the statistics are also reported as a weighted sum.")
+                             ->check(CLI::ExistingFile)
+                             ->needs(sim_instr_option)
+                             ->excludes(save_option)
+                             ->excludes(restore_option)
+                             ->excludes(skip_instr_option);
+  auto simpoint_clusters_option =
+      app.add_option("--simpoint-clusters", simpoint_clusters,
+                     "Choose this many intervals by clustering the basic block vectors of the trace, then simulate them as with --simpoints")
+          ->check(CLI::PositiveNumber)
+          ->needs(sim_instr_option)
+          ->excludes(simpoint_option)
+          ->excludes(save_option)
+          ->excludes(restore_option)
+          ->excludes(skip_instr_option);
+  app.add_option("--simpoint-output", simpoint_output_name, "Write the intervals chosen by --simpoint-clusters to this file")->needs(simpoint_clusters_option);
+
+  auto capture_option = app.add_option("--capture-llc", capture_file_name,
+                                       "Record each access to the last-level cache, with whether it hit, to this file for replay with --replay-llc");
+  auto replay_option = app.add_option("--replay-llc", replay_file_name,
+                                      "Replay the accesses recorded with --capture-llc through the last-level cache and its replacement policy alone, "
+                                      "instead of simulating traces. The accesses recorded in the warmup warm the cache.")
+                           ->check(CLI::ExistingFile)
+                           ->excludes(capture_option)
+                           ->excludes(save_option)
+                           ->excludes(restore_option)
+                           ->excludes(skip_instr_option)
+                           ->excludes(simpoint_option)
+                           ->excludes(simpoint_clusters_option);
+
+  auto interval_option = app.add_option("--interval-stats", interval_file_name,
+                                        "Write the statistics of each interval of every phase to this file, as one JSON object per line. "
+                                        "Each interval counts only its own events.")
+                             ->excludes(replay_option);
+  app.add_option("--interval-instructions", interval_instructions, "The number of instructions, retired by all of the cores together, in each interval")
+      ->check(CLI::PositiveNumber)
+      ->needs(interval_option);
+
+  bool host_profile = false;
+  uint64_t host_profile_period = champsim::host_profiler::default_sample_period;
+  auto host_profile_option = app.add_flag("--host-profile", host_profile, "Report the host time of each phase, and estimate the time spent in each element of the system");
+  app.add_option("--host-profile-period", host_profile_period, "Time the elements of the system on one in this many cycles")
+      ->check(CLI::PositiveNumber)
+      ->needs(host_profile_option);
+
+  auto event_trace_option = app.add_option("--event-trace", event_trace_file_name,
+                                           "Write the events of the packets in the caches and DRAM to this file, in the Chrome trace event format")
+                                ->excludes(replay_option);
+  app.add_option("--event-trace-addresses", event_trace_addresses, "Trace only the packets whose addresses are in BEGIN:END")->needs(event_trace_option);
+  app.add_option("--event-trace-cycles", event_trace_cycles, "Trace only the events in BEGIN:END, in cycles of the fastest clock")->needs(event_trace_option);
+  app.add_option("--event-trace-instrs", event_trace_instrs, "Trace only the packets whose instruction IDs are in BEGIN:END")->needs(event_trace_option);
+  app.add_option("--event-trace-size", event_trace_size, "Keep at most this many of the most recent events")
+      ->check(CLI::PositiveNumber)
+      ->needs(event_trace_option);
+
+  app.add_option("--isolated-ipc", isolated_ipc_files,
+                 "The JSON output of single-core runs of the traces, to compare the throughput and fairness of the cores against")
+      ->check(CLI::ExistingFile);
+  auto occupancy_option = app.add_option("--occupancy-sample-period", occupancy_sample_period,
+                                         "Sample the number of blocks each core holds in the last-level cache once in this many cycles")
+                              ->check(CLI::PositiveNumber);
+
+  auto cpus = gen_environment.cpu_view();
+  auto num_contexts = std::accumulate(std::begin(cpus), std::end(cpus), std::size_t{0}, [](auto acc, const O3_CPU& cpu) { return acc + std::size(cpu.threads); });
+  auto traces_option = app.add_option("traces", trace_names, "The paths to the traces, one for each hardware thread")
+                           ->expected(static_cast<int>(num_contexts))
+                           ->check(CLI::ExistingFile);
+  replay_option->excludes(traces_option);
 
   CLI11_PARSE(app, argc, argv);
 
+  if (replay_option->count() == 0 && traces_option->count() == 0) {
+    fmt::print(stderr, "traces is required\n");
+    return 1;
+  }
+
+  champsim::decode_threads = decode_threads;
+
+  // In batch mode, each of the configured variants is simulated instead of the base system
+  const bool batch = !std::empty(champsim::configured::variants);
+  if (batch && (lockstep.jobs > 1 || !std::empty(checkpoint.save_file) || !std::empty(checkpoint.restore_file) || capture_option->count() > 0
+                || interval_option->count() > 0 || host_profile_option->count() > 0 || event_trace_option->count() > 0 || occupancy_option->count() > 0)) {
+    fmt::print(stderr, "The configured variants cannot be simulated with more than one job, with checkpoints, with a capture, with interval statistics, with "
+                       "a host profile, with an event trace, or with occupancy sampling\n");
+    return 1;
+  }
+
+  // Modules that share their state between instances would be operated from several host threads at once
+  if (auto shared = gen_environment.modules_with_shared_state(); lockstep.jobs > 1 && !std::empty(shared)) {
+    fmt::print(stderr, "The system cannot be simulated with more than one job, because these modules do not keep their state for each instance: {}\n",
+               fmt::join(shared, ", "));
+    return 1;
+  }
+
+  // Modules without the hooks would start from their initial state after a restore, which need not agree with the restored caches
+  if (auto cold = gen_environment.modules_without_checkpoint_hooks();
+      (!std::empty(checkpoint.save_file) || !std::empty(checkpoint.restore_file)) && !std::empty(cold)) {
+    fmt::print(stderr, "The system cannot use checkpoints, because these modules do not save their state in them: {}\n", fmt::join(cold, ", "));
+    return 1;
+  }
+
+  // The captured accesses belong to a single last-level cache
+  if (llc_warmup_option->count() > 0)
+    only_last_level_cache(gen_environment);
+
+  // The tracer is not shared between host threads
+  if (lockstep.jobs > 1 && event_trace_option->count() > 0) {
+    fmt::print(stderr, "An event trace cannot be recorded with more than one job\n");
+    return 1;
+  }
+
+  champsim::event_tracer::filter_type event_filter;
+  for (auto [text, range, name] : {std::tuple{event_trace_addresses, &event_filter.addresses, "--event-trace-addresses"},
+                                   std::tuple{event_trace_cycles, &event_filter.times, "--event-trace-cycles"},
+                                   std::tuple{event_trace_instrs, &event_filter.instr_ids, "--event-trace-instrs"}}) {
+    if (std::empty(text))
+      continue;
+    auto parsed = champsim::parse_range(text);
+    if (!parsed.has_value()) {
+      fmt::print(stderr, "{} must be given as BEGIN:END\n", name);
+      return 1;
+    }
+    *range = parsed.value();
+  }
+
+  // Replay the captured accesses through the last-level cache of the system, or of each variant
+  if (replay_option->count() > 0) {
+    auto replay = [&](champsim::environment& env) {
+      CACHE& llc = only_last_level_cache(env);
+      champsim::access_capture_reader reader{replay_file_name};
+      auto stats = champsim::replay_accesses(llc, reader);
+      champsim::plain_printer{std::cout}.print(stats);
+      llc.impl_replacement_final_stats();
+    };
+
+    if (batch) {
+      for (const auto& variant : champsim::configured::variants) {
+        fmt::print("\n=== Variant {} ===\n\n", variant.name);
+        replay(*champsim::make_variant(variant));
+      }
+    } else {
+      for (champsim::operable& op : gen_environment.operable_view())
+        op.initialize();
+      replay(gen_environment);
+    }
+
+    return 0;
+  }
+
   const bool warmup_given = (warmup_instr_option->count() > 0) || (deprec_warmup_instr_option->count() > 0);
   const bool simulation_given = (sim_instr_option->count() > 0) || (deprec_sim_instr_option->count() > 0);
+  const bool sampled = (simpoint_option->count() > 0) || (simpoint_clusters_option->count() > 0);
+
+  if (sampled && std::size(trace_names) != 1) {
+    fmt::print(stderr, "Sampled simulation requires a single trace\n");
+    return 1;
+  }
+
+  // Each core is compared against the single-core run of the trace of its first hardware thread
+  std::vector<double> isolated_ipc;
+  if (!std::empty(isolated_ipc_files)) {
+    std::vector<champsim::report::run> alone;
+    for (const auto& file : isolated_ipc_files) {
+      std::ifstream json_file{file};
+      try {
+        alone.push_back(champsim::report::read_run(json_file, "", file));
+      } catch (const std::exception& e) {
+        fmt::print(stderr, "{} is not the JSON output of a run: {}\n", file, e.what());
+        return 1;
+      }
+    }
+
+    std::size_t context = 0;
+    for (const O3_CPU& cpu : gen_environment.cpu_view()) {
+      auto trace = std::filesystem::path{trace_names.at(context)}.filename();
+      auto found = std::find_if(std::begin(alone), std::end(alone), [&](const champsim::report::run& r) {
+        return std::size(r.trace_names) == 1 && std::filesystem::path{r.trace_names.front()}.filename() == trace;
+      });
+      if (found == std::end(alone)) {
+        fmt::print(stderr, "None of the runs given to --isolated-ipc ran {} alone\n", trace.string());
+        return 1;
+      }
+      isolated_ipc.push_back(found->ipc());
+      context += std::size(cpu.threads);
+    }
+  }
 
   if (deprec_warmup_instr_option->count() > 0)
     fmt::print("WARNING: option --warmup_instructions is deprecated. Use --warmup-instructions instead.\n");
@@ -81,41 +348,180 @@ int main(int argc, char** argv)
   if (simulation_given && !warmup_given)
     warmup_instructions = simulation_instructions * 2 / 10;
 
-  std::vector<champsim::tracereader> traces;
-  std::transform(
-      std::begin(trace_names), std::end(trace_names), std::back_inserter(traces),
-      [knob_cloudsuite, repeat = simulation_given, i = uint8_t(0)](auto name) mutable { return get_tracereader(name, i++, knob_cloudsuite, repeat); });
+  auto open_traces = [&, repeat = simulation_given && !sampled, repeat_memory_bytes = repeat_memory_mib << 20]() {
+    std::vector<champsim::tracereader> opened;
+    std::transform(std::begin(trace_names), std::end(trace_names), std::back_inserter(opened),
+                   [knob_cloudsuite, repeat, repeat_memory_bytes, i = uint8_t(0)](auto name) mutable {
+                     return get_tracereader(name, i++, knob_cloudsuite, repeat, repeat_memory_bytes);
+                   });
+    return opened;
+  };
+
+  std::vector<champsim::simpoint> simpoints;
+  if (simpoint_option->count() > 0) {
+    std::ifstream simpoint_file{simpoint_file_name};
+    simpoints = champsim::read_simpoints(simpoint_file);
+  }
 
-  std::vector<champsim::phase_info> phases{
-      {champsim::phase_info{"Warmup", true, warmup_instructions, std::vector<std::size_t>(std::size(trace_names), 0), trace_names},
-       champsim::phase_info{"Simulation", false, simulation_instructions, std::vector<std::size_t>(std::size(trace_names), 0), trace_names}}};
+  if (simpoint_clusters_option->count() > 0) {
+    auto profile_trace = get_tracereader(trace_names.front(), 0, knob_cloudsuite, false);
+    simpoints = champsim::choose_simpoints(champsim::collect_bbvs(profile_trace, simulation_instructions), simpoint_clusters, simulation_instructions);
+    if (!std::empty(simpoint_output_name)) {
+      std::ofstream simpoint_output{simpoint_output_name};
+      champsim::write_simpoints(simpoint_output, simpoints);
+    }
+  }
 
-  for (auto& p : phases)
-    std::iota(std::begin(p.trace_index), std::end(p.trace_index), 0);
+  std::vector<std::size_t> trace_index(std::size(trace_names), 0);
+  std::iota(std::begin(trace_index), std::end(trace_index), 0);
+
+  std::vector<champsim::phase_info> phases;
+  if (sampled) {
+    // Fast-forward to the warmup before each interval. The intervals are sorted, and the traces cannot go back, so a warmup is shortened
+    // rather than reach into the interval before it.
+    uint64_t previous_end = 0;
+    for (std::size_t i = 0; i < std::size(simpoints); ++i) {
+      auto start = simpoints[i].start;
+      if (start < previous_end) {
+        fmt::print(stderr, "SimPoint {} begins at instruction {}, before the previous interval ends at instruction {}\n", i, start, previous_end);
+        return 1;
+      }
+
+      auto warmup_begin = start - std::min(start, warmup_instructions);
+      if (warmup_begin < previous_end) {
+        fmt::print("WARNING: SimPoint {} is warmed up for {} instructions, because the previous interval ends at instruction {}\n", i,
+                   start - previous_end, previous_end);
+        warmup_begin = previous_end;
+      }
+
+      phases.push_back({"Warmup " + std::to_string(i), true, start - warmup_begin, trace_index, trace_names, warmup_begin});
+      phases.push_back({"SimPoint " + std::to_string(i), false, simulation_instructions, trace_index, trace_names, start});
+      previous_end = start + simulation_instructions;
+    }
+  } else {
+    phases.push_back({"Warmup", true, warmup_instructions, trace_index, trace_names, skip_instructions});
+    phases.push_back({"Simulation", false, simulation_instructions, trace_index, trace_names, skip_instructions});
+  }
 
   fmt::print("\n*** ChampSim Multicore Out-of-Order Simulator ***\nWarmup Instructions: {}\nSimulation Instructions: {}\nNumber of CPUs: {}\nPage size: {}\n\n",
              phases.at(0).length, phases.at(1).length, std::size(gen_environment.cpu_view()), PAGE_SIZE);
 
-  auto phase_stats = champsim::main(gen_environment, phases, traces);
+  for (std::size_t i = 0; i < std::size(simpoints); ++i)
+    fmt::print("SimPoint {}: instruction {} weight {:.4g}\n", i, simpoints[i].start, simpoints[i].weight);
 
-  fmt::print("\nChampSim completed all CPUs\n\n");
+  auto print_results = [&](champsim::environment& env, std::vector<champsim::phase_stats> phase_stats, std::string json_name) {
+    if (sampled)
+      phase_stats.push_back(champsim::weighted_stats("Weighted", phase_stats, simpoints));
 
-  champsim::plain_printer{std::cout}.print(phase_stats);
+    for (auto& stats : phase_stats)
+      stats.isolated_ipc = isolated_ipc;
 
-  for (CACHE& cache : gen_environment.cache_view())
-    cache.impl_prefetcher_final_stats();
+    champsim::plain_printer{std::cout}.print(phase_stats);
 
-  for (CACHE& cache : gen_environment.cache_view())
-    cache.impl_replacement_final_stats();
+    for (CACHE& cache : env.cache_view())
+      cache.impl_prefetcher_final_stats();
 
-  if (json_option->count() > 0) {
-    if (json_file_name.empty()) {
-      champsim::json_printer{std::cout}.print(phase_stats);
-    } else {
-      std::ofstream json_file{json_file_name};
-      champsim::json_printer{json_file}.print(phase_stats);
+    for (CACHE& cache : env.cache_view())
+      cache.impl_replacement_final_stats();
+
+    if (json_option->count() > 0) {
+      if (json_name.empty()) {
+        champsim::json_printer{std::cout}.print(phase_stats);
+      } else {
+        std::ofstream json_file{json_name};
+        champsim::json_printer{json_file}.print(phase_stats);
+      }
     }
+  };
+
+  if (batch) {
+    auto report_variant = [&](champsim::batch_result& result) {
+      fmt::print("\n=== Variant {} ===\n\n", result.name);
+
+      // Each variant's JSON output is written to its own file, named for the variant
+      std::filesystem::path json_path{json_file_name};
+      if (!json_file_name.empty())
+        json_path.replace_filename(json_path.stem().string() + "." + result.name + json_path.extension().string());
+      print_results(*result.env, result.stats, json_path.string());
+    };
+
+    // Variants with modules that share state between instances cannot run in one process, so each runs in a process of its own
+    std::vector<std::string> shared;
+    for (const auto& variant : champsim::configured::variants)
+      shared.insert(std::end(shared), std::begin(variant.modules_with_shared_state), std::end(variant.modules_with_shared_state));
+    std::sort(std::begin(shared), std::end(shared));
+    shared.erase(std::unique(std::begin(shared), std::end(shared)), std::end(shared));
+
+    if (!std::empty(shared)) {
+      fmt::print("The variants are simulated in separate processes, because these modules do not keep their state for each instance: {}\n",
+                 fmt::join(shared, ", "));
+      champsim::run_batch_in_processes(champsim::configured::variants, phases, open_traces, show_heartbeat, report_variant);
+      fmt::print("\nChampSim completed all variants\n");
+      return 0;
+    }
+
+    auto results = champsim::run_batch(champsim::configured::variants, phases, open_traces(), show_heartbeat);
+
+    fmt::print("\nChampSim completed all variants\n");
+
+    for (auto& result : results)
+      report_variant(result);
+
+    return 0;
+  }
+
+  auto traces = open_traces();
+
+  std::optional<champsim::access_capture_writer> capture;
+  if (capture_option->count() > 0) {
+    capture.emplace(capture_file_name);
+    only_last_level_cache(gen_environment).access_capture = &capture.value();
   }
 
+  std::optional<champsim::interval_stats_writer> intervals;
+  if (interval_option->count() > 0)
+    intervals.emplace(interval_file_name, interval_instructions);
+
+  std::optional<champsim::event_tracer> event_trace;
+  if (event_trace_option->count() > 0) {
+    event_trace.emplace(event_filter, event_trace_size);
+    champsim::attach(event_trace.value(), gen_environment);
+  }
+
+  for (CACHE& cache : gen_environment.cache_view()) {
+    if (champsim::is_last_level(cache, gen_environment.dram_view()))
+      cache.occupancy_sample_period = occupancy_sample_period;
+  }
+
+  std::optional<champsim::host_profiler> profiler;
+  if (host_profile)
+    profiler.emplace(host_profile_period);
+
+  auto phase_stats = champsim::main(gen_environment, phases, traces, lockstep, checkpoint, intervals.has_value() ? &intervals.value() : nullptr,
+                                    profiler.has_value() ? &profiler.value() : nullptr);
+
+  fmt::print("\nChampSim completed all CPUs\n\n");
+
+  if (profiler.has_value())
+    profiler->print();
+
+  if (event_trace.has_value()) {
+    std::ofstream trace_file{event_trace_file_name};
+    event_trace->write_json(trace_file);
+    fmt::print("Wrote {} events to {}{}\n\n", std::size(event_trace->events()), event_trace_file_name,
+               event_trace->dropped() > 0 ? fmt::format(" ({} earlier events were dropped)", event_trace->dropped()) : "");
+  }
+
+  if (capture.has_value()) {
+    std::vector<uint64_t> instructions(std::size(gen_environment.cpu_view()), 0);
+    for (const auto& stats : phase_stats) {
+      for (std::size_t cpu = 0; cpu < std::size(stats.roi_cpu_stats); ++cpu)
+        instructions.at(cpu) += stats.roi_cpu_stats[cpu].instrs();
+    }
+    capture->close(instructions);
+  }
+
+  print_results(gen_environment, phase_stats, json_file_name);
+
   return 0;
 }
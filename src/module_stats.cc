@@ -0,0 +1,57 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "module_stats.h"
+
+#include <algorithm>
+
+void champsim::module_stats_registry::add_counter(std::string name, uint64_t& counter) { counters.emplace_back(std::move(name), &counter); }
+
+void champsim::module_stats_registry::add_histogram(std::string name, uint64_t* buckets, std::size_t size)
+{
+  histograms.push_back({std::move(name), buckets, size});
+}
+
+void champsim::module_stats_registry::reset()
+{
+  for (auto [name, counter] : counters)
+    *counter = 0;
+  for (const auto& hist : histograms)
+    std::fill_n(hist.buckets, hist.size, uint64_t{0});
+}
+
+champsim::module_stats champsim::module_stats_registry::values() const
+{
+  module_stats result;
+  for (auto [name, counter] : counters)
+    result.counters.emplace_back(name, *counter);
+  for (const auto& hist : histograms)
+    result.histograms.emplace_back(hist.name, std::vector<uint64_t>(hist.buckets, hist.buckets + hist.size));
+  return result;
+}
+
+champsim::module_stats champsim::difference(const module_stats& now, const module_stats& before)
+{
+  auto result = now;
+  for (std::size_t i = 0; i < std::min(std::size(result.counters), std::size(before.counters)); ++i)
+    result.counters[i].second -= before.counters[i].second;
+  for (std::size_t i = 0; i < std::min(std::size(result.histograms), std::size(before.histograms)); ++i) {
+    auto& buckets = result.histograms[i].second;
+    const auto& before_buckets = before.histograms[i].second;
+    std::transform(std::begin(buckets), std::end(buckets), std::begin(before_buckets), std::begin(buckets), std::minus{});
+  }
+  return result;
+}
@@ -23,6 +23,7 @@
 
 #include "cache.h"
 #include "champsim.h"
+#include "checkpoint.h"
 #include "deadlock.h"
 #include "instruction.h"
 #include "util/span.h"
@@ -30,7 +31,11 @@
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
-uint64_t current_instr_count[NUM_CPUS] = {0};
+namespace
+{
+uint64_t retired_instr_count[NUM_CPUS] = {0};
+}
+thread_local uint64_t* current_instr_count = retired_instr_count;
 
 std::chrono::seconds elapsed_time();
 
@@ -38,7 +43,10 @@ long O3_CPU::operate()
 {
   long progress{0};
 
-  progress += retire_rob();                    // retire
+  auto retired = retire_rob(); // retire
+  account_cycle(retired);
+  progress += retired;
+
   progress += complete_inflight_instruction(); // finalize execution
   progress += execute_instruction();           // execute instructions
   progress += schedule_instruction();          // schedule instructions
@@ -53,6 +61,9 @@ long O3_CPU::operate()
   progress += check_dib();
   initialize_instruction();
 
+  progress += prefetch_fetch_targets(); // fetch-directed prefetch
+  predict_fetch_targets();
+
   // heartbeat
   if (show_heartbeat && (num_retired >= next_print_instruction)) {
     auto heartbeat_instr{std::ceil(num_retired - last_heartbeat_instr)};
@@ -61,12 +72,18 @@ long O3_CPU::operate()
     auto phase_instr{std::ceil(num_retired - begin_phase_instr)};
     auto phase_cycle{std::ceil(current_cycle - begin_phase_cycle)};
 
-    fmt::print("Heartbeat CPU {} instructions: {} cycles: {} heartbeat IPC: {:.4g} cumulative IPC: {:.4g} (Simulation time: {:%H hr %M min %S sec})\n", cpu,
-               num_retired, current_cycle, heartbeat_instr / heartbeat_cycle, phase_instr / phase_cycle, elapsed_time());
+    // The host speed since the last heartbeat, in thousands of instructions per second
+    auto now = std::chrono::steady_clock::now();
+    auto heartbeat_seconds = std::chrono::duration<double>{now - last_heartbeat_time}.count();
+
+    fmt::print("Heartbeat CPU {} instructions: {} cycles: {} heartbeat IPC: {:.4g} cumulative IPC: {:.4g} (Simulation time: {:%H hr %M min %S sec}, {:.4g} KIPS)\n",
+               cpu, num_retired, current_cycle, heartbeat_instr / heartbeat_cycle, phase_instr / phase_cycle, elapsed_time(),
+               heartbeat_instr / heartbeat_seconds / 1000);
     next_print_instruction += STAT_PRINTING_PERIOD;
 
     last_heartbeat_instr = num_retired;
     last_heartbeat_cycle = current_cycle;
+    last_heartbeat_time = now;
   }
 
   return progress;
@@ -77,6 +94,9 @@ void O3_CPU::initialize()
   // BRANCH PREDICTOR & BTB
   impl_initialize_branch_predictor();
   impl_initialize_btb();
+
+  // The first heartbeat measures from the start of the simulation, not from the construction of the core
+  last_heartbeat_time = std::chrono::steady_clock::now();
 }
 
 void O3_CPU::begin_phase()
@@ -89,14 +109,26 @@ void O3_CPU::begin_phase()
   stats.name = "CPU " + std::to_string(cpu);
   stats.begin_instrs = num_retired;
   stats.begin_cycles = current_cycle;
+  for (auto& thread : threads) {
+    thread.begin_phase_instr = thread.num_retired;
+    stats.thread_begin_instrs.push_back(thread.num_retired);
+  }
   sim_stats = stats;
+  stats_registry.reset();
 }
 
 void O3_CPU::end_phase(unsigned finished_cpu)
 {
+  // Attribute a stall that is still in progress at the phase boundary
+  if (!std::empty(ROB))
+    do_attribute_memory_stall(ROB.front());
+
   // Record where the phase ended (overwrite if this is later)
   sim_stats.end_instrs = num_retired;
   sim_stats.end_cycles = current_cycle;
+  sim_stats.thread_end_instrs.clear();
+  std::transform(std::begin(threads), std::end(threads), std::back_inserter(sim_stats.thread_end_instrs), [](const auto& x) { return x.num_retired; });
+  sim_stats.modules = stats_registry.values();
 
   if (finished_cpu == this->cpu) {
     finish_phase_instr = num_retired;
@@ -106,25 +138,152 @@ void O3_CPU::end_phase(unsigned finished_cpu)
   }
 }
 
+void O3_CPU::predict_fetch_targets()
+{
+  if (FTQ_SIZE == 0)
+    return;
+
+  auto instrs_to_predict_this_cycle = FETCH_WIDTH;
+  auto thread = select_fetch_thread();
+
+  while (thread != std::end(threads) && current_cycle >= thread->fetch_resume_cycle && instrs_to_predict_this_cycle > 0
+         && !std::empty(thread->input_queue)) {
+    auto& instr = thread->input_queue.front();
+
+    // A fetch block ends at a cache block boundary or after a taken branch
+    auto block = instr.ip >> LOG2_BLOCK_SIZE;
+    bool new_block = std::empty(FTQ) || FTQ_BLOCKS.back().block != block || (FTQ.back().is_branch && FTQ.back().branch_taken);
+    if (new_block && std::size(FTQ_BLOCKS) >= FTQ_SIZE)
+      break;
+
+    instrs_to_predict_this_cycle--;
+
+    auto stop_fetch = do_init_instruction(instr);
+    if (stop_fetch)
+      instrs_to_predict_this_cycle = 0;
+
+    if (new_block)
+      FTQ_BLOCKS.push_back({block, 0});
+    FTQ_BLOCKS.back().num_instrs++;
+
+    // Add to FTQ
+    FTQ.push_back(instr);
+    thread->input_queue.pop_front();
+
+    FTQ.back().event_cycle = current_cycle;
+  }
+}
+
+long O3_CPU::prefetch_fetch_targets()
+{
+  long progress{0};
+
+  auto pf_begin = std::find_if(std::begin(FTQ_BLOCKS), std::end(FTQ_BLOCKS), [](const auto& x) { return !x.prefetch_issued; });
+  for (auto to_issue = L1I_BANDWIDTH; to_issue > 0 && pf_begin != std::end(FTQ_BLOCKS); --to_issue) {
+    CacheBus::request_type pf_packet;
+    pf_packet.v_address = pf_begin->block << LOG2_BLOCK_SIZE;
+    pf_packet.ip = pf_packet.v_address;
+
+    if constexpr (champsim::debug_print) {
+      fmt::print("[FTQ] {} v_address: {:#x} queued blocks: {}\n", __func__, pf_packet.v_address, std::size(FTQ_BLOCKS));
+    }
+
+    if (!L1I_bus.issue_prefetch(pf_packet))
+      break;
+
+    pf_begin->prefetch_issued = true;
+    ++pf_begin;
+    ++progress;
+  }
+
+  return progress;
+}
+
 void O3_CPU::initialize_instruction()
 {
   auto instrs_to_read_this_cycle = std::min(FETCH_WIDTH, static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER)));
 
-  while (current_cycle >= fetch_resume_cycle && instrs_to_read_this_cycle > 0 && !std::empty(input_queue)) {
+  if (FTQ_SIZE > 0) {
+    // The branch predictor has already run ahead, so fetch follows the predicted stream in the FTQ
+    while (instrs_to_read_this_cycle > 0 && !std::empty(FTQ)) {
+      instrs_to_read_this_cycle--;
+
+      if (FTQ.front().is_branch && FTQ.front().branch_taken)
+        instrs_to_read_this_cycle = 0;
+
+      if (--FTQ_BLOCKS.front().num_instrs == 0)
+        FTQ_BLOCKS.pop_front();
+
+      // Add to IFETCH_BUFFER
+      IFETCH_BUFFER.push_back(FTQ.front());
+      FTQ.pop_front();
+
+      IFETCH_BUFFER.back().event_cycle = current_cycle;
+    }
+
+    return;
+  }
+
+  auto thread = select_fetch_thread();
+  while (thread != std::end(threads) && current_cycle >= thread->fetch_resume_cycle && instrs_to_read_this_cycle > 0
+         && !std::empty(thread->input_queue)) {
     instrs_to_read_this_cycle--;
 
-    auto stop_fetch = do_init_instruction(input_queue.front());
+    auto& instr = thread->input_queue.front();
+    auto stop_fetch = do_init_instruction(instr);
     if (stop_fetch)
       instrs_to_read_this_cycle = 0;
 
     // Add to IFETCH_BUFFER
-    IFETCH_BUFFER.push_back(input_queue.front());
-    input_queue.pop_front();
+    IFETCH_BUFFER.push_back(instr);
+    thread->input_queue.pop_front();
 
     IFETCH_BUFFER.back().event_cycle = current_cycle;
   }
 }
 
+auto O3_CPU::select_fetch_thread() -> std::vector<thread_context>::iterator
+{
+  auto selected = std::end(threads);
+
+  // Consider the threads in round-robin order, starting after the thread that fetched last
+  for (std::size_t i = 1; i <= std::size(threads); ++i) {
+    auto candidate = std::next(std::begin(threads), static_cast<long>((last_fetch_thread + i) % std::size(threads)));
+    if (current_cycle < candidate->fetch_resume_cycle || std::empty(candidate->input_queue))
+      continue;
+
+    // ICOUNT prefers the thread with the fewest instructions in the front end and waiting to execute
+    if (selected == std::end(threads) || (FETCH_POLICY == fetch_policy_type::ICOUNT && candidate->icount < selected->icount))
+      selected = candidate;
+
+    if (FETCH_POLICY == fetch_policy_type::ROUND_ROBIN)
+      break;
+  }
+
+  if (selected != std::end(threads))
+    last_fetch_thread = static_cast<std::size_t>(std::distance(std::begin(threads), selected));
+  return selected;
+}
+
+void O3_CPU::add_input(std::size_t thread, ooo_model_instr arch_instr)
+{
+  arch_instr.thread = static_cast<uint8_t>(thread);
+
+  if (std::size(threads) > 1) {
+    // Give each thread its own region of the virtual address space, so that threads do not alias in the shared TLBs and caches
+    auto tag = uint64_t{thread} << 56;
+    arch_instr.ip ^= tag;
+    if (arch_instr.branch_target != 0)
+      arch_instr.branch_target ^= tag;
+    for (auto& addr : arch_instr.source_memory)
+      addr ^= tag;
+    for (auto& addr : arch_instr.destination_memory)
+      addr ^= tag;
+  }
+
+  threads.at(thread).input_queue.push_back(std::move(arch_instr));
+}
+
 namespace
 {
 void do_stack_pointer_folding(ooo_model_instr& arch_instr)
@@ -172,7 +331,7 @@ bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr)
       sim_stats.total_rob_occupancy_at_branch_mispredict += std::size(ROB);
       sim_stats.branch_type_misses[arch_instr.branch_type]++;
       if (!warmup) {
-        fetch_resume_cycle = std::numeric_limits<uint64_t>::max();
+        threads[arch_instr.thread].fetch_resume_cycle = std::numeric_limits<uint64_t>::max();
         stop_fetch = true;
         arch_instr.branch_mispredicted = 1;
       }
@@ -189,6 +348,12 @@ bool O3_CPU::do_predict_branch(ooo_model_instr& arch_instr)
 
 bool O3_CPU::do_init_instruction(ooo_model_instr& arch_instr)
 {
+  ++threads[arch_instr.thread].icount;
+
+  // The threads share the ROB and LSQ, which are ordered by instr_id
+  if (std::size(threads) > 1)
+    arch_instr.instr_id = next_instr_id++;
+
   // fast warmup eliminates register dependencies between instructions branch predictor, cache contents, and prefetchers are still warmed up
   if (warmup) {
     arch_instr.source_registers.clear();
@@ -308,7 +473,7 @@ long O3_CPU::decode_instruction()
         // clear the branch_mispredicted bit so we don't attempt to resume fetch again at execute
         db_entry.branch_mispredicted = 0;
         // pay misprediction penalty
-        this->fetch_resume_cycle = this->current_cycle + BRANCH_MISPREDICT_PENALTY;
+        this->threads[db_entry.thread].fetch_resume_cycle = this->current_cycle + BRANCH_MISPREDICT_PENALTY;
       }
     }
 
@@ -362,23 +527,21 @@ long O3_CPU::schedule_instruction()
 
 void O3_CPU::do_scheduling(ooo_model_instr& instr)
 {
+  auto& reg_producers = threads[instr.thread].reg_producers;
+
   // Mark register dependencies
   for (auto src_reg : instr.source_registers) {
-    if (!std::empty(reg_producers[src_reg])) {
-      ooo_model_instr& prior = reg_producers[src_reg].back();
-      if (prior.registers_instrs_depend_on_me.empty() || prior.registers_instrs_depend_on_me.back().get().instr_id != instr.instr_id) {
-        prior.registers_instrs_depend_on_me.push_back(instr);
+    if (ooo_model_instr* prior = reg_producers[src_reg]; prior != nullptr) {
+      if (prior->registers_instrs_depend_on_me.empty() || &prior->registers_instrs_depend_on_me.back().get() != &instr) {
+        prior->registers_instrs_depend_on_me.push_back(instr);
         instr.num_reg_dependent++;
       }
     }
   }
 
-  for (auto dreg : instr.destination_registers) {
-    auto begin = std::begin(reg_producers[dreg]);
-    auto end = std::end(reg_producers[dreg]);
-    auto ins = std::lower_bound(begin, end, instr, [](const ooo_model_instr& lhs, const ooo_model_instr& rhs) { return lhs.instr_id < rhs.instr_id; });
-    reg_producers[dreg].insert(ins, std::ref(instr));
-  }
+  // Rename the destination registers to this instruction
+  for (auto dreg : instr.destination_registers)
+    reg_producers[dreg] = &instr;
 
   instr.scheduled = COMPLETED;
   instr.event_cycle = current_cycle + (warmup ? 0 : SCHEDULING_LATENCY);
@@ -401,6 +564,8 @@ void O3_CPU::do_execution(ooo_model_instr& rob_entry)
 {
   rob_entry.executed = INFLIGHT;
   rob_entry.event_cycle = current_cycle + (warmup ? 0 : EXEC_LATENCY);
+  if (threads[rob_entry.thread].icount > 0)
+    --threads[rob_entry.thread].icount;
 
   // Mark LQ entries as ready to translate
   for (auto& lq_entry : LQ)
@@ -540,12 +705,11 @@ bool O3_CPU::execute_load(const LSQ_ENTRY& lq_entry)
 
 void O3_CPU::do_complete_execution(ooo_model_instr& instr)
 {
+  // Release any mappings that have not been overwritten by a younger producer
+  auto& reg_producers = threads[instr.thread].reg_producers;
   for (auto dreg : instr.destination_registers) {
-    auto begin = std::begin(reg_producers[dreg]);
-    auto end = std::end(reg_producers[dreg]);
-    auto elem = std::find_if(begin, end, [id = instr.instr_id](ooo_model_instr& x) { return x.instr_id == id; });
-    assert(elem != end);
-    reg_producers[dreg].erase(elem);
+    if (reg_producers[dreg] == &instr)
+      reg_producers[dreg] = nullptr;
   }
 
   instr.executed = COMPLETED;
@@ -559,7 +723,7 @@ void O3_CPU::do_complete_execution(ooo_model_instr& instr)
   }
 
   if (instr.branch_mispredicted)
-    fetch_resume_cycle = current_cycle + BRANCH_MISPREDICT_PENALTY;
+    threads[instr.thread].fetch_resume_cycle = current_cycle + BRANCH_MISPREDICT_PENALTY;
 }
 
 long O3_CPU::complete_inflight_instruction()
@@ -609,7 +773,8 @@ long O3_CPU::handle_memory_return()
   for (auto l1d_bw = L1D_BANDWIDTH; l1d_bw > 0 && l1d_it != std::end(L1D_bus.lower_level->returned); --l1d_bw, ++l1d_it) {
     for (auto& lq_entry : LQ) {
       if (lq_entry.has_value() && lq_entry->fetch_issued && lq_entry->virtual_address >> LOG2_BLOCK_SIZE == l1d_it->v_address >> LOG2_BLOCK_SIZE) {
-        lq_entry->finish(std::begin(ROB), std::end(ROB));
+        auto rob_entry = lq_entry->finish(std::begin(ROB), std::end(ROB));
+        rob_entry->mem_miss_depth = std::max(rob_entry->mem_miss_depth, l1d_it->miss_depth);
         lq_entry.reset();
         ++progress;
       }
@@ -628,6 +793,9 @@ long O3_CPU::retire_rob()
     std::for_each(retire_begin, retire_end, [](const auto& x) { fmt::print("[ROB] retire_rob instr_id: {} is retired\n", x.instr_id); });
   }
   auto retire_count = std::distance(retire_begin, retire_end);
+  if (retire_count > 0)
+    do_attribute_memory_stall(*retire_begin);
+  std::for_each(retire_begin, retire_end, [this](const auto& x) { ++this->threads[x.thread].num_retired; });
   num_retired += retire_count;
   current_instr_count[cpu] = num_retired;
   ROB.erase(retire_begin, retire_end);
@@ -635,6 +803,51 @@ long O3_CPU::retire_rob()
   return retire_count;
 }
 
+void O3_CPU::account_cycle(long retired)
+{
+  if (retired > 0) {
+    ++sim_stats.retiring_cycles;
+  } else if (!std::empty(ROB)) {
+    // The head of the ROB is blocking retirement
+    const auto& head = ROB.front();
+    if (head.executed == INFLIGHT && head.completed_mem_ops < head.num_mem_ops())
+      ++head_memory_stall_cycles; // classified by level once the loads return
+    else
+      ++sim_stats.backend_core_cycles;
+  } else if (std::any_of(std::begin(threads), std::end(threads), [cycle = current_cycle](const auto& x) { return cycle < x.fetch_resume_cycle; })) {
+    ++sim_stats.bad_speculation_cycles; // fetch is stopped behind a mispredicted branch
+  } else if (!std::empty(IFETCH_BUFFER) && IFETCH_BUFFER.front().fetched != COMPLETED) {
+    ++sim_stats.frontend_l1i_cycles;
+  } else {
+    ++sim_stats.frontend_other_cycles;
+  }
+}
+
+void O3_CPU::do_attribute_memory_stall(const ooo_model_instr& instr)
+{
+  auto level = std::min<std::size_t>(instr.mem_miss_depth, std::size(sim_stats.backend_memory_cycles) - 1);
+  sim_stats.backend_memory_cycles[level] += head_memory_stall_cycles;
+  head_memory_stall_cycles = 0;
+}
+
+void O3_CPU::save_checkpoint(std::ostream& os)
+{
+  DIB.save(os);
+  champsim::checkpoint::write_section(os, "branch_predictor", [this](auto& s) { this->impl_branch_predictor_save_state(s); });
+  champsim::checkpoint::write_section(os, "btb", [this](auto& s) { this->impl_btb_save_state(s); });
+}
+
+void O3_CPU::restore_checkpoint(std::istream& is)
+{
+  DIB.restore(is);
+
+  // Modules without the hooks keep their initial state
+  auto bpred_state = champsim::checkpoint::read_section(is, "branch_predictor");
+  impl_branch_predictor_restore_state(bpred_state);
+  auto btb_state = champsim::checkpoint::read_section(is, "btb");
+  impl_btb_restore_state(btb_state);
+}
+
 // LCOV_EXCL_START Exclude the following function from LCOV
 void O3_CPU::print_deadlock()
 {
@@ -644,6 +857,7 @@ void O3_CPU::print_deadlock()
     return std::tuple{entry.instr_id, +entry.fetched, +entry.scheduled, +entry.executed, +entry.num_reg_dependent, entry.num_mem_ops() - entry.completed_mem_ops, entry.event_cycle};
   };
   std::string_view instr_fmt{"instr_id: {} fetched: {} scheduled: {} executed: {} num_reg_dependent: {} num_mem_ops: {} event: {}"};
+  champsim::range_print_deadlock(FTQ, "cpu" + std::to_string(cpu) + "_FTQ", instr_fmt, instr_pack);
   champsim::range_print_deadlock(IFETCH_BUFFER, "cpu" + std::to_string(cpu) + "_IFETCH", instr_fmt, instr_pack);
   champsim::range_print_deadlock(DECODE_BUFFER, "cpu" + std::to_string(cpu) + "_DECODE", instr_fmt, instr_pack);
   champsim::range_print_deadlock(DISPATCH_BUFFER, "cpu" + std::to_string(cpu) + "_DISPATCH", instr_fmt, instr_pack);
@@ -676,7 +890,7 @@ LSQ_ENTRY::LSQ_ENTRY(uint64_t id, uint64_t addr, uint64_t local_ip, std::array<u
 {
 }
 
-void LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const
+std::deque<ooo_model_instr>::iterator LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<ooo_model_instr>::iterator end) const
 {
   auto rob_entry = std::partition_point(begin, end, [id = this->instr_id](auto x) { return x.instr_id < id; });
   assert(rob_entry != end);
@@ -689,6 +903,8 @@ void LSQ_ENTRY::finish(std::deque<ooo_model_instr>::iterator begin, std::deque<o
     fmt::print("[LSQ] {} instr_id: {} full_address: {:#x} remain_mem_ops: {} event_cycle: {}\n", __func__, instr_id, virtual_address,
                rob_entry->num_mem_ops() - rob_entry->completed_mem_ops, event_cycle);
   }
+
+  return rob_entry;
 }
 
 bool CacheBus::issue_read(request_type data_packet)
@@ -711,3 +927,14 @@ bool CacheBus::issue_write(request_type data_packet)
 
   return lower_level->add_wq(data_packet);
 }
+
+bool CacheBus::issue_prefetch(request_type data_packet)
+{
+  data_packet.address = data_packet.v_address;
+  data_packet.is_translated = false;
+  data_packet.cpu = cpu;
+  data_packet.type = access_type::PREFETCH;
+  data_packet.response_requested = false;
+
+  return lower_level->add_pq(data_packet);
+}
@@ -0,0 +1,47 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "phase_info.h"
+
+#include <algorithm>
+
+std::optional<champsim::throughput_stats> champsim::throughput(const phase_stats& stats)
+{
+  if (std::empty(stats.roi_cpu_stats) || std::size(stats.isolated_ipc) != std::size(stats.roi_cpu_stats))
+    return std::nullopt;
+
+  // The slowdown of each core is its IPC alone over its IPC in the shared system
+  std::vector<double> slowdowns;
+  for (std::size_t i = 0; i < std::size(stats.roi_cpu_stats); ++i) {
+    const auto& cpu = stats.roi_cpu_stats[i];
+    auto shared_ipc = static_cast<double>(cpu.instrs()) / static_cast<double>(cpu.cycles());
+    if (!(shared_ipc > 0) || !(stats.isolated_ipc[i] > 0))
+      return std::nullopt;
+    slowdowns.push_back(stats.isolated_ipc[i] / shared_ipc);
+  }
+
+  throughput_stats result;
+  for (auto slowdown : slowdowns) {
+    result.weighted_speedup += 1 / slowdown;
+    result.harmonic_speedup += slowdown;
+  }
+  result.harmonic_speedup = static_cast<double>(std::size(slowdowns)) / result.harmonic_speedup;
+
+  auto [min, max] = std::minmax_element(std::begin(slowdowns), std::end(slowdowns));
+  result.maximum_slowdown = *max;
+  result.unfairness = *max / *min;
+  return result;
+}
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <sstream>
 #include <utility>
@@ -22,6 +24,7 @@
 #include "stats_printer.h"
 #include <fmt/core.h>
 #include <fmt/ostream.h>
+#include <fmt/ranges.h>
 
 void champsim::plain_printer::print(O3_CPU::stats_type stats)
 {
@@ -37,6 +40,11 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
 
   fmt::print(stream, "\n{} cumulative IPC: {:.4g} instructions: {} cycles: {}\n", stats.name, std::ceil(stats.instrs()) / std::ceil(stats.cycles()),
              stats.instrs(), stats.cycles());
+  if (std::size(stats.thread_begin_instrs) > 1) {
+    for (std::size_t thread = 0; thread < std::size(stats.thread_begin_instrs); ++thread)
+      fmt::print(stream, "{} thread {} IPC: {:.4g} instructions: {}\n", stats.name, thread, std::ceil(stats.thread_instrs(thread)) / std::ceil(stats.cycles()),
+                 stats.thread_instrs(thread));
+  }
   fmt::print(stream, "{} Branch Prediction Accuracy: {:.4g}% MPKI: {:.4g} Average ROB Occupancy at Mispredict: {:.4g}\n", stats.name,
              (100.0 * std::ceil(total_branch - total_mispredictions)) / total_branch, (1000.0 * total_mispredictions) / std::ceil(stats.instrs()),
              std::ceil(stats.total_rob_occupancy_at_branch_mispredict) / total_mispredictions);
@@ -48,6 +56,16 @@ void champsim::plain_printer::print(O3_CPU::stats_type stats)
   fmt::print(stream, "Branch type MPKI\n");
   for (auto [str, idx] : types)
     fmt::print(stream, "{}: {:.3}\n", str, mpkis[idx]);
+
+  auto memory_cycles = std::accumulate(std::begin(stats.backend_memory_cycles), std::end(stats.backend_memory_cycles), uint64_t{0});
+  auto pct = [cycles = std::ceil(stats.cycles())](auto x) { return 100.0 * std::ceil(x) / cycles; };
+  fmt::print(stream, "{} Top-down cycles: retiring: {:.4g}% frontend: {:.4g}% bad speculation: {:.4g}% backend memory: {:.4g}% backend core: {:.4g}%\n",
+             stats.name, pct(stats.retiring_cycles), pct(stats.frontend_l1i_cycles + stats.frontend_other_cycles), pct(stats.bad_speculation_cycles),
+             pct(memory_cycles), pct(stats.backend_core_cycles));
+  fmt::print(stream, "{} Frontend L1I: {} other: {} Backend memory L1D: {} L2C: {} LLC: {} DRAM: {}\n", stats.name, stats.frontend_l1i_cycles,
+             stats.frontend_other_cycles, stats.backend_memory_cycles[0], stats.backend_memory_cycles[1], stats.backend_memory_cycles[2],
+             stats.backend_memory_cycles[3]);
+  print(stats.name, stats.modules);
   fmt::print(stream, "\n");
 }
 
@@ -73,9 +91,86 @@ void champsim::plain_printer::print(CACHE::stats_type stats)
 
     fmt::print(stream, "{} PREFETCH REQUESTED: {:10} ISSUED: {:10} USEFUL: {:10} USELESS: {:10}\n", stats.name, stats.pf_requested, stats.pf_issued,
                stats.pf_useful, stats.pf_useless);
+    fmt::print(stream, "{} PREFETCH TIMELY: {:10} LATE: {:10} EARLY: {:10} POLLUTION: {:10}\n", stats.name, stats.pf_timely, stats.pf_late, stats.pf_early,
+               stats.pf_pollution);
+    fmt::print(stream, "{} PREFETCH USE DISTANCE: {}\n", stats.name, fmt::join(stats.pf_use_distance, " "));
 
     fmt::print(stream, "{} AVERAGE MISS LATENCY: {:.4g} cycles\n", stats.name, stats.avg_miss_latency);
   }
+
+  if (!std::empty(stats.occupancy)) {
+    for (std::size_t cpu = 0; cpu < NUM_CPUS; ++cpu) {
+      auto owned = [cpu](const auto& sample) { return sample[cpu]; };
+      std::vector<uint64_t> samples;
+      std::transform(std::begin(stats.occupancy), std::end(stats.occupancy), std::back_inserter(samples), owned);
+      auto mean = std::ceil(std::accumulate(std::begin(samples), std::end(samples), uint64_t{0})) / std::ceil(std::size(samples));
+      fmt::print(stream, "{} CPU {} OCCUPANCY AVERAGE: {:.1f} blocks MIN: {} MAX: {} SAMPLES: {}\n", stats.name, cpu, mean,
+                 *std::min_element(std::begin(samples), std::end(samples)), *std::max_element(std::begin(samples), std::end(samples)), std::size(samples));
+    }
+  }
+
+  print(stats.name, stats.latency, cache_hop_names);
+  print(stats.name, stats.modules);
+}
+
+template <typename H, std::size_t N>
+void champsim::plain_printer::print(std::string_view owner, const latency_histograms<H>& stats, const std::array<std::string_view, N>& hop_names)
+{
+  for (std::size_t type = 0; type < stats.num_types; ++type) {
+    for (std::size_t hop = 0; hop < stats.num_hops; ++hop) {
+      auto count = stats.count(type, hop);
+      if (count > 0) {
+        fmt::print(stream, "{} {:<12s} {:<8s} LATENCY COUNT: {:10d} AVERAGE: {:.4g} cycles HISTOGRAM: {}\n", owner, access_type_names.at(type), hop_names.at(hop),
+                   count, std::ceil(stats.total_cycles[type][hop]) / std::ceil(count), fmt::join(stats.buckets[type][hop], " "));
+      }
+    }
+  }
+}
+
+void champsim::plain_printer::print(std::string_view owner, const module_stats& stats)
+{
+  for (const auto& [name, value] : stats.counters)
+    fmt::print(stream, "{} {}: {}\n", owner, name, value);
+  for (const auto& [name, buckets] : stats.histograms)
+    fmt::print(stream, "{} {}: {}\n", owner, name, fmt::join(buckets, " "));
+}
+
+void champsim::plain_printer::print(const replay_stats& stats)
+{
+  auto total_accesses = stats.warmup_accesses;
+  uint64_t total_hits = 0;
+  for (std::size_t type = 0; type < std::size(stats.hits); ++type) {
+    total_hits += std::accumulate(std::begin(stats.hits[type]), std::end(stats.hits[type]), uint64_t{0});
+    total_accesses += std::accumulate(std::begin(stats.hits[type]), std::end(stats.hits[type]), uint64_t{0});
+    total_accesses += std::accumulate(std::begin(stats.misses[type]), std::end(stats.misses[type]), uint64_t{0});
+  }
+  auto measured = std::ceil(total_accesses - stats.warmup_accesses);
+
+  fmt::print(stream, "{} replayed {} accesses ({} in the warmup) in {:.3g} s: {:.4g} million accesses per second\n", stats.name, total_accesses,
+             stats.warmup_accesses, stats.seconds, std::ceil(total_accesses) / stats.seconds / 1e6);
+  fmt::print(stream, "{} HIT RATE: {:.4g} CAPTURED HIT RATE: {:.4g}\n", stats.name, std::ceil(total_hits) / measured, std::ceil(stats.captured_hits) / measured);
+
+  constexpr std::array<std::pair<std::string_view, std::size_t>, 5> types{
+      {std::pair{"LOAD", champsim::to_underlying(access_type::LOAD)}, std::pair{"RFO", champsim::to_underlying(access_type::RFO)},
+       std::pair{"PREFETCH", champsim::to_underlying(access_type::PREFETCH)}, std::pair{"WRITE", champsim::to_underlying(access_type::WRITE)},
+       std::pair{"TRANSLATION", champsim::to_underlying(access_type::TRANSLATION)}}};
+
+  for (std::size_t cpu = 0; cpu < NUM_CPUS; ++cpu) {
+    uint64_t TOTAL_HIT = 0, TOTAL_MISS = 0;
+    for (const auto& type : types) {
+      TOTAL_HIT += stats.hits.at(type.second).at(cpu);
+      TOTAL_MISS += stats.misses.at(type.second).at(cpu);
+    }
+
+    fmt::print(stream, "{} TOTAL        ACCESS: {:10d} HIT: {:10d} MISS: {:10d}\n", stats.name, TOTAL_HIT + TOTAL_MISS, TOTAL_HIT, TOTAL_MISS);
+    for (const auto& type : types) {
+      fmt::print(stream, "{} {:<12s} ACCESS: {:10d} HIT: {:10d} MISS: {:10d}\n", stats.name, type.first,
+                 stats.hits[type.second][cpu] + stats.misses[type.second][cpu], stats.hits[type.second][cpu], stats.misses[type.second][cpu]);
+    }
+
+    auto instructions = cpu < std::size(stats.instructions) ? stats.instructions[cpu] : 0;
+    fmt::print(stream, "{} CPU {} instructions: {} MPKI: {:.4g}\n", stats.name, cpu, instructions, 1000.0 * std::ceil(TOTAL_MISS) / std::ceil(instructions));
+  }
 }
 
 void champsim::plain_printer::print(DRAM_CHANNEL::stats_type stats)
@@ -87,6 +182,12 @@ void champsim::plain_printer::print(DRAM_CHANNEL::stats_type stats)
     fmt::print(stream, " AVG DBUS CONGESTED CYCLE: -\n");
   fmt::print(stream, "WQ ROW_BUFFER_HIT: {:10}\n  ROW_BUFFER_MISS: {:10}\n  FULL: {:10}\n", stats.name, stats.WQ_ROW_BUFFER_HIT, stats.WQ_ROW_BUFFER_MISS,
              stats.WQ_FULL);
+  if (stats.cycles > 0) {
+    auto activations = std::accumulate(std::begin(stats.bank_activations), std::end(stats.bank_activations), uint64_t{0});
+    fmt::print(stream, "{} DBUS UTILIZATION: {:.4g} BANDWIDTH: {:.4g} GB/s ACTIVATIONS: {} SWITCHES TO WRITE: {} TO READ: {}\n", stats.name,
+               stats.dbus_utilization(), stats.bandwidth_gbps(), activations, stats.switches_to_write, stats.switches_to_read);
+  }
+  print(stats.name, stats.latency, dram_hop_names);
 }
 
 void champsim::plain_printer::print(champsim::phase_stats& stats)
@@ -112,6 +213,11 @@ void champsim::plain_printer::print(champsim::phase_stats& stats)
   for (const auto& stat : stats.roi_cpu_stats)
     print(stat);
 
+  if (auto tp = champsim::throughput(stats); tp.has_value()) {
+    fmt::print(stream, "\nWeighted speedup: {:.4g} Harmonic speedup: {:.4g} Maximum slowdown: {:.4g} Unfairness: {:.4g}\n", tp->weighted_speedup,
+               tp->harmonic_speedup, tp->maximum_slowdown, tp->unfairness);
+  }
+
   for (const auto& stat : stats.roi_cache_stats)
     print(stat);
 
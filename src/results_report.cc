@@ -0,0 +1,272 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "results_report.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <fmt/core.h>
+#include <fmt/ostream.h>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+using namespace std::literals::string_view_literals;
+constexpr std::array access_types{"LOAD"sv, "RFO"sv, "PREFETCH"sv, "WRITE"sv, "TRANSLATION"sv};
+
+// The level of a cache is its name without the core that it is private to
+std::string level_of(std::string_view name)
+{
+  if (name.substr(0, 3) == "cpu") {
+    auto underscore = name.find('_');
+    auto digits = name.substr(3, underscore - 3);
+    if (underscore != std::string_view::npos && !std::empty(digits) && std::all_of(std::begin(digits), std::end(digits), [](char c) { return std::isdigit(c); }))
+      return std::string{name.substr(underscore + 1)};
+  }
+  return std::string{name};
+}
+
+uint64_t sum_misses(const nlohmann::json& stats, std::string_view type)
+{
+  if (!stats.contains(type) || !stats.at(type).contains("miss"))
+    return 0;
+  auto misses = stats.at(type).at("miss").get<std::vector<uint64_t>>();
+  return std::accumulate(std::begin(misses), std::end(misses), uint64_t{0});
+}
+
+std::set<std::string> levels_of(const std::vector<champsim::report::run>& runs)
+{
+  std::set<std::string> levels;
+  for (const auto& r : runs)
+    for (const auto& [level, count] : r.misses)
+      levels.insert(level);
+  return levels;
+}
+
+// The IPC of each run of the baseline, by trace
+std::map<std::string, double> baseline_ipc(const std::vector<champsim::report::run>& runs, std::string_view baseline)
+{
+  std::map<std::string, double> result;
+  for (const auto& r : runs)
+    if (r.config == baseline)
+      result.emplace(r.trace, r.ipc());
+  return result;
+}
+
+std::optional<double> speedup(const champsim::report::run& r, const std::map<std::string, double>& base)
+{
+  auto found = base.find(r.trace);
+  if (found == std::end(base) || found->second <= 0)
+    return std::nullopt;
+  return r.ipc() / found->second;
+}
+
+std::string csv_value(std::optional<double> value) { return value.has_value() ? fmt::format("{:.6f}", value.value()) : ""; }
+} // namespace
+
+uint64_t champsim::report::run::total_instructions() const { return std::accumulate(std::begin(instructions), std::end(instructions), uint64_t{0}); }
+
+double champsim::report::run::ipc() const
+{
+  double result = 0;
+  for (std::size_t i = 0; i < std::size(instructions); ++i)
+    if (cycles.at(i) > 0)
+      result += static_cast<double>(instructions.at(i)) / static_cast<double>(cycles.at(i));
+  return result;
+}
+
+double champsim::report::run::mpki(uint64_t count) const
+{
+  auto instrs = total_instructions();
+  return instrs > 0 ? 1000.0 * static_cast<double>(count) / static_cast<double>(instrs) : 0;
+}
+
+auto champsim::report::read_run(std::istream& is, std::string config, std::string trace) -> run
+{
+  auto phases = nlohmann::json::parse(is);
+  if (!phases.is_array() || std::empty(phases))
+    throw std::runtime_error("no phases");
+
+  const auto& roi = phases.back().at("roi");
+
+  run result;
+  result.config = std::move(config);
+  result.category = category_of(std::filesystem::path{trace}.filename().string());
+  result.trace = std::move(trace);
+  result.trace_names = phases.back().value("traces", std::vector<std::string>{});
+  for (const auto& core : roi.at("cores")) {
+    result.instructions.push_back(core.at("instructions").get<uint64_t>());
+    result.cycles.push_back(core.at("cycles").get<uint64_t>());
+  }
+
+  for (const auto& [name, stats] : roi.items()) {
+    if (name == "cores" || name == "DRAM" || !stats.is_object() || !stats.contains("LOAD"))
+      continue;
+    auto level = level_of(name);
+    for (auto type : access_types)
+      result.misses[level] += sum_misses(stats, type);
+    result.load_misses[level] += sum_misses(stats, "LOAD");
+  }
+
+  return result;
+}
+
+auto champsim::report::read_runs(const std::vector<std::filesystem::path>& dirs, unsigned jobs) -> std::vector<run>
+{
+  struct input {
+    std::filesystem::path file;
+    std::string config;
+    std::string trace;
+  };
+
+  std::vector<input> inputs;
+  for (const auto& dir : dirs) {
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator{dir})
+      if (entry.is_regular_file() && entry.path().extension() == ".json")
+        files.push_back(entry.path());
+    std::sort(std::begin(files), std::end(files));
+
+    auto normal = dir.lexically_normal();
+    if (!normal.has_filename())
+      normal = normal.parent_path();
+    auto config = normal.filename().string();
+    for (const auto& file : files)
+      inputs.push_back({file, config, std::filesystem::relative(file, dir).replace_extension().generic_string()});
+  }
+
+  // Each thread takes the next file, and puts its run in the place of the file
+  std::vector<std::optional<run>> parsed(std::size(inputs));
+  std::atomic<std::size_t> next{0};
+  auto worker = [&] {
+    for (auto i = next++; i < std::size(inputs); i = next++) {
+      std::ifstream file{inputs[i].file};
+      try {
+        parsed[i] = read_run(file, inputs[i].config, inputs[i].trace);
+      } catch (const std::exception& e) {
+        fmt::print(stderr, "Skipping {}: {}\n", inputs[i].file.string(), e.what());
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < std::max(jobs, 1u); ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto& t : threads)
+    t.join();
+
+  std::vector<run> result;
+  for (auto& r : parsed)
+    if (r.has_value())
+      result.push_back(std::move(r.value()));
+  return result;
+}
+
+std::string champsim::report::category_of(std::string_view trace)
+{
+  auto underscore = trace.rfind('_');
+  if (underscore == std::string_view::npos || underscore + 1 == std::size(trace))
+    return std::string{trace};
+  auto suffix = trace.substr(underscore + 1);
+  if (!std::all_of(std::begin(suffix), std::end(suffix), [](char c) { return std::isdigit(c); }))
+    return std::string{trace};
+  return std::string{trace.substr(0, underscore)};
+}
+
+double champsim::report::geomean(const std::vector<double>& values)
+{
+  if (std::empty(values))
+    return 0;
+  auto log_sum = std::accumulate(std::begin(values), std::end(values), 0.0, [](double acc, double x) { return acc + std::log(x); });
+  return std::exp(log_sum / static_cast<double>(std::size(values)));
+}
+
+void champsim::report::write_runs_csv(std::ostream& os, const std::vector<run>& runs, std::string_view baseline)
+{
+  auto levels = levels_of(runs);
+  auto base = baseline_ipc(runs, baseline);
+
+  fmt::print(os, "config,trace,category,cores,instructions,cycles,IPC,speedup");
+  for (const auto& level : levels)
+    fmt::print(os, ",{} MPKI,{} LOAD MPKI", level, level);
+  fmt::print(os, "\n");
+
+  for (const auto& r : runs) {
+    auto max_cycles = std::empty(r.cycles) ? uint64_t{0} : *std::max_element(std::begin(r.cycles), std::end(r.cycles));
+    fmt::print(os, "{},{},{},{},{},{},{:.6f},{}", r.config, r.trace, r.category, std::size(r.instructions), r.total_instructions(), max_cycles, r.ipc(),
+               csv_value(speedup(r, base)));
+    for (const auto& level : levels) {
+      auto misses = r.misses.find(level);
+      auto load_misses = r.load_misses.find(level);
+      fmt::print(os, ",{},{}", misses == std::end(r.misses) ? "" : csv_value(r.mpki(misses->second)),
+                 load_misses == std::end(r.load_misses) ? "" : csv_value(r.mpki(load_misses->second)));
+    }
+    fmt::print(os, "\n");
+  }
+}
+
+void champsim::report::write_categories_csv(std::ostream& os, const std::vector<run>& runs, std::string_view baseline)
+{
+  auto base = baseline_ipc(runs, baseline);
+
+  // Keep the configurations in the order they were given, and the categories in order within each
+  std::vector<std::string> configs;
+  for (const auto& r : runs)
+    if (std::find(std::begin(configs), std::end(configs), r.config) == std::end(configs))
+      configs.push_back(r.config);
+
+  struct group {
+    std::vector<double> ipcs{};
+    std::vector<double> speedups{};
+
+    void add(const run& r, const std::map<std::string, double>& base_ipc)
+    {
+      ipcs.push_back(r.ipc());
+      if (auto s = speedup(r, base_ipc); s.has_value())
+        speedups.push_back(s.value());
+    }
+  };
+
+  auto print_group = [&os](std::string_view config, std::string_view category, const group& g) {
+    fmt::print(os, "{},{},{},{:.6f},{}\n", config, category, std::size(g.ipcs), geomean(g.ipcs), std::empty(g.speedups) ? "" : csv_value(geomean(g.speedups)));
+  };
+
+  fmt::print(os, "config,category,runs,geomean IPC,geomean speedup\n");
+  for (const auto& config : configs) {
+    std::map<std::string, group> by_category;
+    group all;
+    for (const auto& r : runs) {
+      if (r.config == config) {
+        by_category[r.category].add(r, base);
+        all.add(r, base);
+      }
+    }
+
+    for (const auto& [category, g] : by_category)
+      print_group(config, category, g);
+    print_group(config, "all", all);
+  }
+}
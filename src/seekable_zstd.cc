@@ -0,0 +1,225 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "seekable_zstd.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <zstd.h>
+
+#include <fmt/core.h>
+
+#include "decode_threads.h"
+
+namespace
+{
+constexpr uint32_t skippable_magic = 0x184D2A5E;
+constexpr uint32_t seekable_magic = 0x8F92EAB1;
+constexpr std::size_t footer_size = 9;
+constexpr std::size_t entry_size = 8;
+constexpr std::size_t skippable_header_size = 8;
+
+void put_u32(std::ostream& os, uint32_t value)
+{
+  std::array<char, 4> bytes;
+  for (auto& byte : bytes) {
+    byte = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+  os.write(std::data(bytes), std::size(bytes));
+}
+
+uint32_t get_u32(const unsigned char* bytes) { return uint32_t{bytes[0]} | (uint32_t{bytes[1]} << 8) | (uint32_t{bytes[2]} << 16) | (uint32_t{bytes[3]} << 24); }
+
+std::vector<char> decompress_frame(std::vector<char> compressed, std::size_t decompressed_size)
+{
+  std::vector<char> retval(decompressed_size);
+  auto result = ZSTD_decompress(std::data(retval), std::size(retval), std::data(compressed), std::size(compressed));
+  if (ZSTD_isError(result))
+    throw std::runtime_error{fmt::format("Zstandard frame could not be decompressed: {}", ZSTD_getErrorName(result))};
+  if (result != decompressed_size)
+    throw std::runtime_error{"Zstandard frame does not match the seek table"};
+  return retval;
+}
+} // namespace
+
+std::vector<champsim::zstd_frame> champsim::read_zstd_seek_table(std::istream& is)
+{
+  std::array<unsigned char, footer_size> footer;
+  is.seekg(-static_cast<std::streamoff>(footer_size), std::ios::end);
+  is.read(reinterpret_cast<char*>(std::data(footer)), std::size(footer));
+  if (!is || get_u32(std::data(footer) + 5) != seekable_magic)
+    throw std::runtime_error{"The file is not in the Zstandard seekable format"};
+
+  auto num_frames = get_u32(std::data(footer));
+  auto descriptor = footer[4];
+  if ((descriptor & 0x7c) != 0)
+    throw std::runtime_error{"The Zstandard seek table has reserved bits set"};
+  std::size_t this_entry_size = entry_size + ((descriptor & 0x80) ? 4 : 0); // entries may carry checksums, which are not used
+
+  auto table_size = skippable_header_size + num_frames * this_entry_size + footer_size;
+  std::vector<unsigned char> table(table_size);
+  is.seekg(-static_cast<std::streamoff>(table_size), std::ios::end);
+  is.read(reinterpret_cast<char*>(std::data(table)), static_cast<std::streamsize>(std::size(table)));
+  if (!is || get_u32(std::data(table)) != skippable_magic || get_u32(std::data(table) + 4) != table_size - skippable_header_size)
+    throw std::runtime_error{"The Zstandard seek table is malformed"};
+
+  std::vector<zstd_frame> frames;
+  uint64_t compressed_offset = 0;
+  uint64_t decompressed_offset = 0;
+  for (std::size_t i = 0; i < num_frames; ++i) {
+    auto entry = std::data(table) + skippable_header_size + i * this_entry_size;
+    auto& frame = frames.emplace_back(zstd_frame{compressed_offset, decompressed_offset, get_u32(entry), get_u32(entry + 4)});
+    compressed_offset += frame.compressed_size;
+    decompressed_offset += frame.decompressed_size;
+  }
+
+  is.clear();
+  is.seekg(0);
+  return frames;
+}
+
+champsim::seekable_zstd_writer::seekable_zstd_writer(std::ostream& os, std::size_t frame_size, int compression_level) : out(os), level(compression_level)
+{
+  if (frame_size == 0 || frame_size > std::numeric_limits<uint32_t>::max())
+    throw std::invalid_argument{"The frame size must be positive and fit in 32 bits"};
+  buffer.reserve(frame_size);
+}
+
+void champsim::seekable_zstd_writer::write(const char* s, std::size_t count)
+{
+  while (count > 0) {
+    auto n = std::min(count, buffer.capacity() - std::size(buffer));
+    buffer.insert(std::end(buffer), s, s + n);
+    s += n;
+    count -= n;
+
+    if (std::size(buffer) == buffer.capacity())
+      write_frame();
+  }
+}
+
+void champsim::seekable_zstd_writer::write_frame()
+{
+  if (std::empty(buffer))
+    return;
+
+  std::vector<char> compressed(ZSTD_compressBound(std::size(buffer)));
+  auto result = ZSTD_compress(std::data(compressed), std::size(compressed), std::data(buffer), std::size(buffer), level);
+  if (ZSTD_isError(result))
+    throw std::runtime_error{fmt::format("Zstandard frame could not be compressed: {}", ZSTD_getErrorName(result))};
+
+  out.write(std::data(compressed), static_cast<std::streamsize>(result));
+  entries.emplace_back(static_cast<uint32_t>(result), static_cast<uint32_t>(std::size(buffer)));
+  buffer.clear();
+}
+
+void champsim::seekable_zstd_writer::close()
+{
+  write_frame();
+
+  put_u32(out, skippable_magic);
+  put_u32(out, static_cast<uint32_t>(std::size(entries) * entry_size + footer_size));
+  for (auto [compressed_size, decompressed_size] : entries) {
+    put_u32(out, compressed_size);
+    put_u32(out, decompressed_size);
+  }
+  put_u32(out, static_cast<uint32_t>(std::size(entries)));
+  out.put(0); // no checksums
+  put_u32(out, seekable_magic);
+}
+
+champsim::seekable_zstd_istream::seekable_zstd_istream(std::string fname) : seekable_zstd_istream(fname, decode_threads.load()) {}
+
+champsim::seekable_zstd_istream::seekable_zstd_istream(std::string fname, std::size_t frames_ahead)
+    : file(fname, std::ios::binary), frames(read_zstd_seek_table(file)), lookahead(std::max<std::size_t>(frames_ahead, 1))
+{
+  start_frames();
+}
+
+void champsim::seekable_zstd_istream::start_frames()
+{
+  for (; std::size(pending) < lookahead && next_frame < std::size(frames); ++next_frame) {
+    const auto& frame = frames[next_frame];
+    std::vector<char> compressed(frame.compressed_size);
+    file.seekg(static_cast<std::streamoff>(frame.compressed_offset));
+    file.read(std::data(compressed), static_cast<std::streamsize>(std::size(compressed)));
+    if (!file)
+      throw std::runtime_error{"The Zstandard file ended before the frames in its seek table"};
+    pending.push_back(std::async(std::launch::async, decompress_frame, std::move(compressed), std::size_t{frame.decompressed_size}));
+  }
+}
+
+auto champsim::seekable_zstd_istream::read(char* s, std::streamsize count) -> seekable_zstd_istream&
+{
+  gcount_ = 0;
+  while (gcount_ < count) {
+    if (current_pos == std::size(current)) {
+      if (std::empty(pending)) {
+        eof_ = true;
+        break;
+      }
+
+      current = pending.front().get();
+      current_pos = 0;
+      pending.pop_front();
+      start_frames();
+    }
+
+    auto n = std::min(static_cast<std::size_t>(count - gcount_), std::size(current) - current_pos);
+    std::memcpy(s + gcount_, std::data(current) + current_pos, n);
+    current_pos += n;
+    gcount_ += static_cast<std::streamsize>(n);
+  }
+
+  return *this;
+}
+
+uint64_t champsim::seekable_zstd_istream::size() const
+{
+  if (std::empty(frames))
+    return 0;
+  return frames.back().decompressed_offset + frames.back().decompressed_size;
+}
+
+void champsim::seekable_zstd_istream::seek(uint64_t offset)
+{
+  pending.clear();
+  current.clear();
+  current_pos = 0;
+  eof_ = false;
+
+  // Past the end, there is nothing left to read
+  next_frame = std::size(frames);
+  if (offset >= size()) {
+    eof_ = true;
+    return;
+  }
+
+  // Start from the frame that holds the offset, and skip to the offset within it
+  auto frame = std::upper_bound(std::begin(frames), std::end(frames), offset, [](uint64_t off, const zstd_frame& f) { return off < f.decompressed_offset; });
+  next_frame = static_cast<std::size_t>(std::distance(std::begin(frames), frame)) - 1;
+  auto frame_offset = offset - frames[next_frame].decompressed_offset;
+
+  start_frames();
+  current = pending.front().get();
+  current_pos = static_cast<std::size_t>(frame_offset);
+  pending.pop_front();
+  start_frames();
+}
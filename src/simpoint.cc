@@ -0,0 +1,355 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simpoint.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <istream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "tracereader.h"
+#include <fmt/core.h>
+#include <fmt/ostream.h>
+
+namespace
+{
+constexpr std::size_t projected_dimensions = 15;
+constexpr int max_kmeans_iterations = 100;
+
+// A fixed pseudo-random value in [-1, 1] for each pair of basic block and dimension
+double projection(uint64_t block, std::size_t dimension)
+{
+  uint64_t x = block + 0x9e3779b97f4a7c15ull * (dimension + 1);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  x = x ^ (x >> 31);
+  return 2.0 * static_cast<double>(x >> 11) / static_cast<double>(1ull << 53) - 1.0;
+}
+
+double squared_distance(const std::vector<double>& lhs, const std::vector<double>& rhs)
+{
+  return std::inner_product(std::begin(lhs), std::end(lhs), std::begin(rhs), 0.0, std::plus<>{}, [](auto x, auto y) { return (x - y) * (x - y); });
+}
+
+std::size_t nearest(const std::vector<double>& point, const std::vector<std::vector<double>>& centroids)
+{
+  auto closer = [&point](const auto& lhs, const auto& rhs) { return squared_distance(point, lhs) < squared_distance(point, rhs); };
+  return static_cast<std::size_t>(std::distance(std::begin(centroids), std::min_element(std::begin(centroids), std::end(centroids), closer)));
+}
+
+template <typename T, typename F>
+double weighted_sum(const std::vector<T>& items, const std::vector<double>& weights, F&& get)
+{
+  double sum = 0;
+  for (std::size_t i = 0; i < std::size(items); ++i)
+    sum += weights.at(i) * static_cast<double>(get(items[i]));
+  return sum;
+}
+
+template <typename R, typename T, typename F>
+R weighted_count(const std::vector<T>& items, const std::vector<double>& weights, F&& get)
+{
+  return static_cast<R>(std::llround(weighted_sum(items, weights, std::forward<F>(get))));
+}
+
+// The statistics registered by the modules are the same in every phase, since they are registered once
+template <typename T>
+champsim::module_stats combine_modules(const std::vector<T>& stats, const std::vector<double>& weights)
+{
+  auto result = stats.front().modules;
+  for (std::size_t i = 0; i < std::size(result.counters); ++i)
+    result.counters[i].second = weighted_count<uint64_t>(stats, weights, [i](const auto& x) { return x.modules.counters.at(i).second; });
+  for (std::size_t i = 0; i < std::size(result.histograms); ++i) {
+    auto& buckets = result.histograms[i].second;
+    for (std::size_t b = 0; b < std::size(buckets); ++b)
+      buckets[b] = weighted_count<uint64_t>(stats, weights, [i, b](const auto& x) { return x.modules.histograms.at(i).second.at(b); });
+  }
+  return result;
+}
+
+template <typename T, typename H>
+champsim::latency_histograms<H> combine_latency(const std::vector<T>& stats, const std::vector<double>& weights)
+{
+  champsim::latency_histograms<H> result;
+  for (std::size_t type = 0; type < result.num_types; ++type) {
+    for (std::size_t hop = 0; hop < result.num_hops; ++hop) {
+      for (std::size_t i = 0; i < result.num_buckets; ++i)
+        result.buckets[type][hop][i] = weighted_count<uint64_t>(stats, weights, [type, hop, i](const auto& x) { return x.latency.buckets[type][hop][i]; });
+      result.total_cycles[type][hop] = weighted_count<uint64_t>(stats, weights, [type, hop](const auto& x) { return x.latency.total_cycles[type][hop]; });
+    }
+  }
+  return result;
+}
+} // namespace
+
+std::vector<champsim::simpoint> champsim::read_simpoints(std::istream& is)
+{
+  std::vector<simpoint> points;
+  for (std::string line; std::getline(is, line);) {
+    auto content = line.substr(0, line.find('#'));
+    if (content.find_first_not_of(" \t\r") == std::string::npos)
+      continue;
+
+    std::istringstream line_stream{content};
+    simpoint point{};
+    if (!(line_stream >> point.start >> point.weight))
+      throw std::runtime_error("Malformed SimPoint: " + line);
+    if (point.weight < 0)
+      throw std::runtime_error("SimPoint weights may not be negative: " + line);
+    points.push_back(point);
+  }
+
+  auto total = std::accumulate(std::begin(points), std::end(points), 0.0, [](auto acc, const auto& x) { return acc + x.weight; });
+  if (std::empty(points) || total <= 0)
+    throw std::runtime_error("No weighted SimPoints were given");
+
+  for (auto& point : points)
+    point.weight /= total;
+  std::sort(std::begin(points), std::end(points), [](const auto& lhs, const auto& rhs) { return lhs.start < rhs.start; });
+  return points;
+}
+
+void champsim::write_simpoints(std::ostream& os, const std::vector<simpoint>& points)
+{
+  for (const auto& point : points)
+    fmt::print(os, "{} {}\n", point.start, point.weight);
+}
+
+std::vector<std::vector<double>> champsim::collect_bbvs(tracereader& trace, uint64_t interval_length)
+{
+  std::vector<std::vector<double>> bbvs;
+  std::unordered_map<uint64_t, uint64_t> block_instrs; // instructions executed by each basic block in this interval
+  uint64_t block_start = 0;
+  bool begins_block = true;
+  uint64_t interval_instrs = 0;
+
+  while (!trace.eof()) {
+    auto instr = trace();
+    if (begins_block)
+      block_start = instr.ip;
+    ++block_instrs[block_start];
+    begins_block = instr.is_branch;
+
+    if (++interval_instrs == interval_length) {
+      std::vector<double> bbv(projected_dimensions, 0.0);
+      for (auto [block, count] : block_instrs) {
+        auto frequency = static_cast<double>(count) / static_cast<double>(interval_length);
+        for (std::size_t dim = 0; dim < projected_dimensions; ++dim)
+          bbv[dim] += frequency * ::projection(block, dim);
+      }
+
+      bbvs.push_back(std::move(bbv));
+      block_instrs.clear();
+      interval_instrs = 0;
+    }
+  }
+
+  return bbvs;
+}
+
+std::vector<champsim::simpoint> champsim::choose_simpoints(const std::vector<std::vector<double>>& bbvs, std::size_t clusters, uint64_t interval_length)
+{
+  if (std::empty(bbvs))
+    throw std::runtime_error("The trace is shorter than one SimPoint interval");
+  clusters = std::min(clusters, std::size(bbvs));
+
+  // Seed the clusters deterministically, each with the interval farthest from the seeds so far
+  std::vector<std::vector<double>> centroids{bbvs.front()};
+  while (std::size(centroids) < clusters) {
+    auto farther = [&centroids](const auto& lhs, const auto& rhs) {
+      return squared_distance(lhs, centroids[nearest(lhs, centroids)]) < squared_distance(rhs, centroids[nearest(rhs, centroids)]);
+    };
+    centroids.push_back(*std::max_element(std::begin(bbvs), std::end(bbvs), farther));
+  }
+
+  std::vector<std::size_t> assignment(std::size(bbvs), clusters);
+  for (int iteration = 0; iteration < max_kmeans_iterations; ++iteration) {
+    std::vector<std::size_t> next_assignment;
+    std::transform(std::begin(bbvs), std::end(bbvs), std::back_inserter(next_assignment), [&centroids](const auto& x) { return nearest(x, centroids); });
+    if (next_assignment == assignment)
+      break;
+    assignment = next_assignment;
+
+    // An empty cluster keeps its previous centroid
+    for (std::size_t c = 0; c < clusters; ++c) {
+      std::vector<double> sum(std::size(centroids[c]), 0.0);
+      std::size_t members = 0;
+      for (std::size_t i = 0; i < std::size(bbvs); ++i) {
+        if (assignment[i] == c) {
+          std::transform(std::begin(sum), std::end(sum), std::begin(bbvs[i]), std::begin(sum), std::plus<>{});
+          ++members;
+        }
+      }
+      if (members > 0)
+        std::transform(std::begin(sum), std::end(sum), std::begin(centroids[c]), [members](auto x) { return x / static_cast<double>(members); });
+    }
+  }
+
+  std::vector<simpoint> points;
+  for (std::size_t c = 0; c < clusters; ++c) {
+    std::size_t members = 0;
+    std::size_t representative = 0;
+    double representative_distance = std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < std::size(bbvs); ++i) {
+      if (assignment[i] == c) {
+        ++members;
+        if (auto dist = squared_distance(bbvs[i], centroids[c]); dist < representative_distance) {
+          representative = i;
+          representative_distance = dist;
+        }
+      }
+    }
+
+    if (members > 0)
+      points.push_back({representative * interval_length, static_cast<double>(members) / static_cast<double>(std::size(bbvs))});
+  }
+
+  std::sort(std::begin(points), std::end(points), [](const auto& lhs, const auto& rhs) { return lhs.start < rhs.start; });
+  return points;
+}
+
+namespace
+{
+O3_CPU::stats_type combine(const std::vector<O3_CPU::stats_type>& stats, const std::vector<double>& weights)
+{
+  auto sum = [&](auto get) { return weighted_count<uint64_t>(stats, weights, get); };
+  auto sum_ll = [&](auto get) { return weighted_count<long long>(stats, weights, get); };
+
+  O3_CPU::stats_type result;
+  result.name = stats.front().name;
+  result.end_instrs = sum([](const auto& x) { return x.instrs(); });
+  result.end_cycles = sum([](const auto& x) { return x.cycles(); });
+  result.total_rob_occupancy_at_branch_mispredict = sum([](const auto& x) { return x.total_rob_occupancy_at_branch_mispredict; });
+
+  for (std::size_t i = 0; i < std::size(result.total_branch_types); ++i) {
+    result.total_branch_types[i] = sum_ll([i](const auto& x) { return x.total_branch_types[i]; });
+    result.branch_type_misses[i] = sum_ll([i](const auto& x) { return x.branch_type_misses[i]; });
+  }
+
+  result.retiring_cycles = sum([](const auto& x) { return x.retiring_cycles; });
+  result.frontend_l1i_cycles = sum([](const auto& x) { return x.frontend_l1i_cycles; });
+  result.frontend_other_cycles = sum([](const auto& x) { return x.frontend_other_cycles; });
+  result.bad_speculation_cycles = sum([](const auto& x) { return x.bad_speculation_cycles; });
+  result.backend_core_cycles = sum([](const auto& x) { return x.backend_core_cycles; });
+  for (std::size_t i = 0; i < std::size(result.backend_memory_cycles); ++i)
+    result.backend_memory_cycles[i] = sum([i](const auto& x) { return x.backend_memory_cycles[i]; });
+
+  result.thread_begin_instrs.assign(std::size(stats.front().thread_begin_instrs), 0);
+  for (std::size_t thread = 0; thread < std::size(result.thread_begin_instrs); ++thread)
+    result.thread_end_instrs.push_back(sum([thread](const auto& x) { return x.thread_instrs(thread); }));
+
+  result.modules = combine_modules(stats, weights);
+  return result;
+}
+
+CACHE::stats_type combine(const std::vector<CACHE::stats_type>& stats, const std::vector<double>& weights)
+{
+  auto sum = [&](auto get) { return weighted_count<uint64_t>(stats, weights, get); };
+
+  CACHE::stats_type result;
+  result.name = stats.front().name;
+  result.pf_requested = sum([](const auto& x) { return x.pf_requested; });
+  result.pf_issued = sum([](const auto& x) { return x.pf_issued; });
+  result.pf_useful = sum([](const auto& x) { return x.pf_useful; });
+  result.pf_useless = sum([](const auto& x) { return x.pf_useless; });
+  result.pf_fill = sum([](const auto& x) { return x.pf_fill; });
+  result.pf_timely = sum([](const auto& x) { return x.pf_timely; });
+  result.pf_late = sum([](const auto& x) { return x.pf_late; });
+  result.pf_early = sum([](const auto& x) { return x.pf_early; });
+  result.pf_pollution = sum([](const auto& x) { return x.pf_pollution; });
+  for (std::size_t i = 0; i < std::size(result.pf_use_distance); ++i)
+    result.pf_use_distance[i] = sum([i](const auto& x) { return x.pf_use_distance[i]; });
+
+  for (std::size_t type = 0; type < std::size(result.hits); ++type) {
+    for (std::size_t cpu = 0; cpu < std::size(result.hits[type]); ++cpu) {
+      result.hits[type][cpu] = sum([type, cpu](const auto& x) { return x.hits[type][cpu]; });
+      result.misses[type][cpu] = sum([type, cpu](const auto& x) { return x.misses[type][cpu]; });
+    }
+  }
+
+  result.total_miss_latency = sum([](const auto& x) { return x.total_miss_latency; });
+  result.avg_miss_latency = weighted_sum(stats, weights, [](const auto& x) { return x.avg_miss_latency; });
+  result.latency = combine_latency<CACHE::stats_type, cache_hop>(stats, weights);
+  result.modules = combine_modules(stats, weights);
+  return result;
+}
+
+DRAM_CHANNEL::stats_type combine(const std::vector<DRAM_CHANNEL::stats_type>& stats, const std::vector<double>& weights)
+{
+  auto sum = [&](auto get) { return weighted_count<uint64_t>(stats, weights, get); };
+  auto sum_u = [&](auto get) { return static_cast<unsigned>(sum(get)); };
+
+  DRAM_CHANNEL::stats_type result;
+  result.name = stats.front().name;
+  result.dbus_cycle_congested = sum([](const auto& x) { return x.dbus_cycle_congested; });
+  result.dbus_count_congested = sum([](const auto& x) { return x.dbus_count_congested; });
+  result.WQ_ROW_BUFFER_HIT = sum_u([](const auto& x) { return x.WQ_ROW_BUFFER_HIT; });
+  result.WQ_ROW_BUFFER_MISS = sum_u([](const auto& x) { return x.WQ_ROW_BUFFER_MISS; });
+  result.RQ_ROW_BUFFER_HIT = sum_u([](const auto& x) { return x.RQ_ROW_BUFFER_HIT; });
+  result.RQ_ROW_BUFFER_MISS = sum_u([](const auto& x) { return x.RQ_ROW_BUFFER_MISS; });
+  result.WQ_FULL = sum_u([](const auto& x) { return x.WQ_FULL; });
+  result.cycles = sum([](const auto& x) { return x.cycles; });
+  result.dbus_cycle_busy = sum([](const auto& x) { return x.dbus_cycle_busy; });
+  result.switches_to_write = sum([](const auto& x) { return x.switches_to_write; });
+  result.switches_to_read = sum([](const auto& x) { return x.switches_to_read; });
+  for (std::size_t i = 0; i < std::size(result.bank_activations); ++i)
+    result.bank_activations[i] = sum([i](const auto& x) { return x.bank_activations[i]; });
+  for (std::size_t i = 0; i < std::size(result.rq_occupancy); ++i)
+    result.rq_occupancy[i] = sum([i](const auto& x) { return x.rq_occupancy[i]; });
+  for (std::size_t i = 0; i < std::size(result.wq_occupancy); ++i)
+    result.wq_occupancy[i] = sum([i](const auto& x) { return x.wq_occupancy[i]; });
+  result.latency = combine_latency<DRAM_CHANNEL::stats_type, dram_hop>(stats, weights);
+  return result;
+}
+
+// Combine the i-th element of a member across all of the phases
+template <typename T>
+std::vector<T> combine_each(const std::vector<champsim::phase_stats>& stats, const std::vector<double>& weights, std::vector<T> champsim::phase_stats::*member)
+{
+  std::vector<T> result;
+  for (std::size_t i = 0; i < std::size(stats.front().*member); ++i) {
+    std::vector<T> column;
+    std::transform(std::begin(stats), std::end(stats), std::back_inserter(column), [member, i](const auto& x) { return (x.*member).at(i); });
+    result.push_back(combine(column, weights));
+  }
+  return result;
+}
+} // namespace
+
+champsim::phase_stats champsim::weighted_stats(std::string name, const std::vector<phase_stats>& stats, const std::vector<simpoint>& points)
+{
+  assert(std::size(stats) == std::size(points));
+  auto total = std::accumulate(std::begin(points), std::end(points), 0.0, [](auto acc, const auto& x) { return acc + x.weight; });
+  std::vector<double> weights;
+  std::transform(std::begin(points), std::end(points), std::back_inserter(weights), [total](const auto& x) { return x.weight / total; });
+
+  phase_stats result;
+  result.name = name;
+  result.trace_names = stats.front().trace_names;
+  result.sim_cpu_stats = ::combine_each(stats, weights, &phase_stats::sim_cpu_stats);
+  result.roi_cpu_stats = ::combine_each(stats, weights, &phase_stats::roi_cpu_stats);
+  result.sim_cache_stats = ::combine_each(stats, weights, &phase_stats::sim_cache_stats);
+  result.roi_cache_stats = ::combine_each(stats, weights, &phase_stats::roi_cache_stats);
+  result.sim_dram_stats = ::combine_each(stats, weights, &phase_stats::sim_dram_stats);
+  result.roi_dram_stats = ::combine_each(stats, weights, &phase_stats::roi_dram_stats);
+  return result;
+}
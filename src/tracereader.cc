@@ -19,12 +19,22 @@
 #include <fstream>
 #include <string>
 
+#include "async_reader.h"
+#include "decoded_trace.h"
 #include "inf_stream.h"
 #include "repeatable.h"
+#include "seekable_zstd.h"
 
 namespace champsim
 {
-uint64_t tracereader::instr_unique_id = 0;
+std::atomic<uint64_t> tracereader::instr_unique_id = 0;
+
+uint64_t tracereader::skip(uint64_t count)
+{
+  auto skipped = pimpl_->skip(count);
+  position_ += skipped;
+  return skipped;
+}
 
 ooo_model_instr apply_branch_target(ooo_model_instr branch, const ooo_model_instr& target)
 {
@@ -32,37 +42,60 @@ ooo_model_instr apply_branch_target(ooo_model_instr branch, const ooo_model_inst
   return branch;
 }
 
-template <template <class, class> typename R, typename T>
-champsim::tracereader get_tracereader_for_type(std::string fname, uint8_t cpu)
+// Any arguments after the name and the core are given to the reader before them
+template <template <class, class> typename R, typename T, typename... Extra>
+champsim::tracereader get_tracereader_for_type(std::string fname, uint8_t cpu, Extra... extra)
 {
   bool is_gzip_compressed = (fname.substr(std::size(fname) - 2) == "gz");
   bool is_lzma_compressed = (fname.substr(std::size(fname) - 2) == "xz");
   bool is_bzip2_compressed = (fname.substr(std::size(fname) - 3) == "bz2");
+  bool is_zstd_compressed = (fname.substr(std::size(fname) - 3) == "zst");
 
   if (is_gzip_compressed)
-    return champsim::tracereader{R<T, champsim::inf_istream<champsim::decomp_tags::gzip_tag_t<>>>(cpu, fname)};
+    return champsim::tracereader{champsim::async_reader{R<T, champsim::inf_istream<champsim::decomp_tags::gzip_tag_t<>>>(extra..., cpu, fname)}};
   else if (is_lzma_compressed)
-    return champsim::tracereader{R<T, champsim::inf_istream<champsim::decomp_tags::lzma_tag_t<>>>(cpu, fname)};
+    return champsim::tracereader{champsim::async_reader{R<T, champsim::inf_istream<champsim::decomp_tags::lzma_tag_t<>>>(extra..., cpu, fname)}};
   else if (is_bzip2_compressed)
-    return champsim::tracereader{R<T, champsim::inf_istream<champsim::decomp_tags::bzip2_tag_t>>(cpu, fname)};
+    return champsim::tracereader{champsim::async_reader{R<T, champsim::inf_istream<champsim::decomp_tags::bzip2_tag_t>>(extra..., cpu, fname)}};
+  else if (is_zstd_compressed)
+    return champsim::tracereader{champsim::async_reader{R<T, champsim::seekable_zstd_istream>(extra..., cpu, fname)}};
   else
-    return champsim::tracereader{R<T, std::ifstream>(cpu, fname)};
+    return champsim::tracereader{champsim::async_reader{R<T, std::ifstream>(extra..., cpu, fname)}};
 }
 } // namespace champsim
 
 template <typename T, typename S>
 using repeatable_reader_t = champsim::repeatable<champsim::bulk_tracereader<T, S>, uint8_t, std::string>;
 
-champsim::tracereader get_tracereader(std::string fname, uint8_t cpu, bool is_cloudsuite, bool repeat)
+template <typename T, typename S>
+using in_memory_reader_t = champsim::in_memory_repeatable<champsim::bulk_tracereader<T, S>, uint8_t, std::string>;
+
+template <typename T>
+champsim::tracereader get_repeating_tracereader(std::string fname, uint8_t cpu, std::size_t memory_bytes)
+{
+  if (memory_bytes > 0)
+    return champsim::get_tracereader_for_type<in_memory_reader_t, T>(fname, cpu, memory_bytes);
+  return champsim::get_tracereader_for_type<repeatable_reader_t, T>(fname, cpu);
+}
+
+champsim::tracereader get_tracereader(std::string fname, uint8_t cpu, bool is_cloudsuite, bool repeat, std::size_t repeat_memory_bytes)
 {
+  // Pre-decoded traces are read directly from a memory mapping, so they need neither a decoding thread nor the trace format
+  if (std::size(fname) >= 8 && fname.substr(std::size(fname) - 8) == ".decoded") {
+    if (repeat)
+      return champsim::tracereader{champsim::repeatable<champsim::decoded_tracereader, uint8_t, std::string>(cpu, fname)};
+    else
+      return champsim::tracereader{champsim::decoded_tracereader(cpu, fname)};
+  }
+
   if (is_cloudsuite) {
     if (repeat)
-      return champsim::get_tracereader_for_type<repeatable_reader_t, cloudsuite_instr>(fname, cpu);
+      return get_repeating_tracereader<cloudsuite_instr>(fname, cpu, repeat_memory_bytes);
     else
       return champsim::get_tracereader_for_type<champsim::bulk_tracereader, cloudsuite_instr>(fname, cpu);
   } else {
     if (repeat)
-      return champsim::get_tracereader_for_type<repeatable_reader_t, input_instr>(fname, cpu);
+      return get_repeating_tracereader<input_instr>(fname, cpu, repeat_memory_bytes);
     else
       return champsim::get_tracereader_for_type<champsim::bulk_tracereader, input_instr>(fname, cpu);
   }
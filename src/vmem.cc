@@ -20,6 +20,7 @@
 
 #include "champsim.h"
 #include "champsim_constants.h"
+#include "checkpoint.h"
 #include "dram_controller.h"
 #include <fmt/core.h>
 
@@ -98,3 +99,56 @@ std::pair<uint64_t, uint64_t> VirtualMemory::get_pte_pa(uint32_t cpu_num, uint64
 
   return {paddr, fault ? minor_fault_penalty : 0};
 }
+
+void VirtualMemory::save_checkpoint(std::ostream& os) const
+{
+  champsim::checkpoint::write(os, next_ppage);
+  champsim::checkpoint::write(os, next_pte_page);
+
+  champsim::checkpoint::write(os, std::size(vpage_to_ppage_map));
+  for (auto [key, ppage] : vpage_to_ppage_map) {
+    champsim::checkpoint::write(os, key.first);
+    champsim::checkpoint::write(os, key.second);
+    champsim::checkpoint::write(os, ppage);
+  }
+
+  champsim::checkpoint::write(os, std::size(page_table));
+  for (auto [key, ppage] : page_table) {
+    champsim::checkpoint::write(os, std::get<0>(key));
+    champsim::checkpoint::write(os, std::get<1>(key));
+    champsim::checkpoint::write(os, std::get<2>(key));
+    champsim::checkpoint::write(os, ppage);
+  }
+}
+
+void VirtualMemory::restore_checkpoint(std::istream& is)
+{
+  champsim::checkpoint::read(is, next_ppage);
+  champsim::checkpoint::read(is, next_pte_page);
+
+  std::size_t num_pages = 0;
+  champsim::checkpoint::read(is, num_pages);
+  vpage_to_ppage_map.clear();
+  for (std::size_t i = 0; i < num_pages; ++i) {
+    uint32_t cpu_num = 0;
+    uint64_t vpage = 0, ppage = 0;
+    champsim::checkpoint::read(is, cpu_num);
+    champsim::checkpoint::read(is, vpage);
+    champsim::checkpoint::read(is, ppage);
+    vpage_to_ppage_map.emplace_hint(std::end(vpage_to_ppage_map), std::pair{cpu_num, vpage}, ppage);
+  }
+
+  std::size_t num_ptes = 0;
+  champsim::checkpoint::read(is, num_ptes);
+  page_table.clear();
+  for (std::size_t i = 0; i < num_ptes; ++i) {
+    uint32_t cpu_num = 0;
+    uint64_t vaddr = 0, ppage = 0;
+    uint32_t level = 0;
+    champsim::checkpoint::read(is, cpu_num);
+    champsim::checkpoint::read(is, vaddr);
+    champsim::checkpoint::read(is, level);
+    champsim::checkpoint::read(is, ppage);
+    page_table.emplace_hint(std::end(page_table), std::tuple{cpu_num, vaddr, level}, ppage);
+  }
+}
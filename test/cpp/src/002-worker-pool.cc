@@ -0,0 +1,47 @@
+#include <catch.hpp>
+#include "lockstep.h"
+
+#include <numeric>
+
+TEST_CASE("A worker pool runs a task once on each worker") {
+  constexpr std::size_t num_workers = 4;
+  champsim::worker_pool uut{num_workers};
+  REQUIRE(uut.size() == num_workers);
+
+  std::vector<int> runs(num_workers, 0);
+  auto task = [&runs](std::size_t worker) { ++runs.at(worker); };
+  uut.run(task);
+
+  REQUIRE(std::all_of(std::begin(runs), std::end(runs), [](auto x) { return x == 1; }));
+}
+
+TEST_CASE("A worker pool finishes each task before the next begins") {
+  constexpr std::size_t num_workers = 3;
+  constexpr int num_tasks = 100;
+  champsim::worker_pool uut{num_workers};
+
+  std::vector<int> counts(num_workers, 0);
+  std::vector<int> next_counts(num_workers, 0);
+  for (int i = 0; i < num_tasks; ++i) {
+    auto task = [&counts, &next_counts, i](std::size_t worker) {
+      // Each worker sees every worker's count from the previous task
+      auto total = std::accumulate(std::begin(counts), std::end(counts), 0);
+      next_counts.at(worker) = counts.at(worker) + ((total == static_cast<int>(num_workers) * i) ? 1 : 0);
+    };
+    uut.run(task);
+    counts = next_counts;
+  }
+
+  REQUIRE(std::all_of(std::begin(counts), std::end(counts), [](auto x) { return x == num_tasks; }));
+}
+
+TEST_CASE("A worker pool with one worker runs on the calling thread") {
+  champsim::worker_pool uut{1};
+  REQUIRE(uut.size() == 1);
+
+  std::thread::id ran_on{};
+  auto task = [&ran_on](std::size_t) { ran_on = std::this_thread::get_id(); };
+  uut.run(task);
+
+  REQUIRE(ran_on == std::this_thread::get_id());
+}
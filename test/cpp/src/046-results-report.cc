@@ -0,0 +1,63 @@
+#include <catch.hpp>
+#include "results_report.h"
+
+#include <sstream>
+
+namespace
+{
+// The parts of the JSON output that the report reads, for two cores
+constexpr auto two_core_output = R"([
+  {"name": "Warmup", "roi": {"cores": [{"instructions": 1, "cycles": 1}, {"instructions": 1, "cycles": 1}]}},
+  {"name": "Simulation", "traces": ["traces/compute_int_7.champsimtrace.xz", "traces/srv_3.champsimtrace.xz"], "roi": {
+    "cores": [{"instructions": 1000, "cycles": 500}, {"instructions": 3000, "cycles": 3000}],
+    "cpu0_L1D": {"LOAD": {"hit": [10, 0], "miss": [4, 0]}, "RFO": {"hit": [0, 0], "miss": [2, 0]}, "miss latency": 10},
+    "cpu1_L1D": {"LOAD": {"hit": [0, 10], "miss": [0, 6]}, "RFO": {"hit": [0, 0], "miss": [0, 0]}, "miss latency": 10},
+    "LLC": {"LOAD": {"hit": [1, 1], "miss": [2, 2]}, "WRITE": {"hit": [0, 0], "miss": [4, 0]}},
+    "DRAM": [{"RQ ROW_BUFFER_HIT": 1}]
+  }}
+])";
+} // namespace
+
+TEST_CASE("A run is read from the last phase of the JSON output") {
+  std::istringstream is{two_core_output};
+  auto uut = champsim::report::read_run(is, "lru", "public/compute_int/compute_int_7");
+
+  CHECK(uut.category == "compute_int");
+  CHECK(uut.trace_names == std::vector<std::string>{"traces/compute_int_7.champsimtrace.xz", "traces/srv_3.champsimtrace.xz"});
+  CHECK(uut.instructions == std::vector<uint64_t>{1000, 3000});
+  CHECK(uut.total_instructions() == 4000);
+  CHECK(uut.ipc() == Approx(3.0));
+  CHECK(uut.misses.at("L1D") == 12);
+  CHECK(uut.load_misses.at("L1D") == 10);
+  CHECK(uut.misses.at("LLC") == 8);
+  CHECK(uut.misses.count("DRAM") == 0);
+  CHECK(uut.mpki(uut.misses.at("LLC")) == Approx(2.0));
+}
+
+TEST_CASE("Output that is not a list of phases is rejected") {
+  std::istringstream is{R"({"name": "Simulation"})"};
+  CHECK_THROWS(champsim::report::read_run(is, "lru", "trace"));
+}
+
+TEST_CASE("The category of a trace drops its trailing number") {
+  CHECK(champsim::report::category_of("compute_int_7") == "compute_int");
+  CHECK(champsim::report::category_of("srv_12") == "srv");
+  CHECK(champsim::report::category_of("crypto") == "crypto");
+  CHECK(champsim::report::category_of("mcf_s") == "mcf_s");
+}
+
+TEST_CASE("The speedup is taken against the run of the same trace in the baseline") {
+  champsim::report::run base{"lru", "a_1", "a", {100}, {100}, {}, {}};
+  champsim::report::run other_trace{"lru", "a_2", "a", {100}, {50}, {}, {}};
+  champsim::report::run faster{"ship", "a_1", "a", {100}, {50}, {}, {}};
+  champsim::report::run slower{"ship", "a_2", "a", {100}, {200}, {}, {}};
+
+  std::ostringstream runs_csv, categories_csv;
+  champsim::report::write_runs_csv(runs_csv, {base, other_trace, faster, slower}, "lru");
+  champsim::report::write_categories_csv(categories_csv, {base, other_trace, faster, slower}, "lru");
+
+  CHECK(runs_csv.str().find("ship,a_1,a,1,100,50,2.000000,2.000000\n") != std::string::npos);
+  CHECK(runs_csv.str().find("ship,a_2,a,1,100,200,0.500000,0.250000\n") != std::string::npos);
+  CHECK(categories_csv.str().find("ship,a,2,1.000000,0.707107\n") != std::string::npos);
+  CHECK(categories_csv.str().find("ship,all,2,1.000000,0.707107\n") != std::string::npos);
+}
@@ -0,0 +1,50 @@
+#include <catch.hpp>
+
+#include "phase_info.h"
+
+namespace
+{
+cpu_stats core(uint64_t instrs, uint64_t cycles)
+{
+  cpu_stats result;
+  result.end_instrs = instrs;
+  result.end_cycles = cycles;
+  return result;
+}
+} // namespace
+
+TEST_CASE("Throughput is not reported without the IPC of every core alone") {
+  champsim::phase_stats stats;
+  stats.roi_cpu_stats = {core(100, 100), core(100, 200)};
+
+  CHECK_FALSE(champsim::throughput(stats).has_value());
+
+  stats.isolated_ipc = {1.0};
+  CHECK_FALSE(champsim::throughput(stats).has_value());
+}
+
+TEST_CASE("Throughput compares the IPC of each core against its IPC alone") {
+  champsim::phase_stats stats;
+  stats.roi_cpu_stats = {core(100, 200), core(100, 400)};
+  stats.isolated_ipc = {1.0, 1.0};
+
+  auto result = champsim::throughput(stats);
+  REQUIRE(result.has_value());
+  CHECK(result->weighted_speedup == Approx(0.75));
+  CHECK(result->harmonic_speedup == Approx(2.0 / 6.0));
+  CHECK(result->maximum_slowdown == Approx(4.0));
+  CHECK(result->unfairness == Approx(2.0));
+}
+
+TEST_CASE("Cores that are not slowed down are perfectly fair") {
+  champsim::phase_stats stats;
+  stats.roi_cpu_stats = {core(300, 100), core(50, 100)};
+  stats.isolated_ipc = {3.0, 0.5};
+
+  auto result = champsim::throughput(stats);
+  REQUIRE(result.has_value());
+  CHECK(result->weighted_speedup == Approx(2.0));
+  CHECK(result->harmonic_speedup == Approx(1.0));
+  CHECK(result->maximum_slowdown == Approx(1.0));
+  CHECK(result->unfairness == Approx(1.0));
+}
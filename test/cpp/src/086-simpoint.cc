@@ -0,0 +1,117 @@
+#include <catch.hpp>
+#include "instr.h"
+#include "simpoint.h"
+#include "tracereader.h"
+
+#include <sstream>
+
+namespace
+{
+struct loop_trace {
+  std::vector<uint64_t> ips;
+  std::size_t length;
+  std::size_t count = 0;
+
+  ooo_model_instr operator()()
+  {
+    auto ip = ips.at(count++ % std::size(ips));
+    auto instr = champsim::test::instruction_with_ip(ip);
+    instr.is_branch = (ip == ips.back());
+    return instr;
+  }
+
+  bool eof() const { return count >= length; }
+};
+} // namespace
+
+TEST_CASE("A SimPoint file is read as sorted intervals with normalized weights") {
+  std::istringstream file{"# start weight\n200 3\n\n0 1 # the first interval\n"};
+  auto points = champsim::read_simpoints(file);
+
+  REQUIRE(std::size(points) == 2);
+  CHECK(points.at(0).start == 0);
+  CHECK(points.at(0).weight == Approx(0.25));
+  CHECK(points.at(1).start == 200);
+  CHECK(points.at(1).weight == Approx(0.75));
+}
+
+TEST_CASE("A malformed SimPoint file is rejected") {
+  std::istringstream file{"0 1\nnot a simpoint\n"};
+  REQUIRE_THROWS(champsim::read_simpoints(file));
+}
+
+TEST_CASE("Written SimPoints can be read back") {
+  std::vector<champsim::simpoint> points{{100, 0.5}, {300, 0.5}};
+  std::stringstream file;
+  champsim::write_simpoints(file, points);
+  auto read_points = champsim::read_simpoints(file);
+
+  REQUIRE(std::size(read_points) == 2);
+  CHECK(read_points.at(1).start == 300);
+  CHECK(read_points.at(1).weight == Approx(0.5));
+}
+
+TEST_CASE("A basic block vector is collected for each complete interval") {
+  champsim::tracereader trace{loop_trace{{0x1000, 0x1004, 0x1008}, 1000}};
+  auto bbvs = champsim::collect_bbvs(trace, 300);
+
+  REQUIRE(std::size(bbvs) == 3);
+  CHECK(bbvs.at(0) == bbvs.at(1));
+  CHECK(bbvs.at(1) == bbvs.at(2));
+}
+
+TEST_CASE("Intervals that run different code have different basic block vectors") {
+  champsim::tracereader first{loop_trace{{0x1000, 0x1004}, 100}};
+  champsim::tracereader second{loop_trace{{0x2000, 0x2004}, 100}};
+  REQUIRE(champsim::collect_bbvs(first, 100) != champsim::collect_bbvs(second, 100));
+}
+
+TEST_CASE("Each cluster of basic block vectors is represented by one interval, weighted by its size") {
+  std::vector<std::vector<double>> bbvs{{1.0, 0.0}, {0.0, 1.0}, {0.99, 0.0}, {1.01, 0.0}, {0.0, 1.02}};
+  auto points = champsim::choose_simpoints(bbvs, 2, 1000);
+
+  REQUIRE(std::size(points) == 2);
+  CHECK(points.at(0).start == 0);
+  CHECK(points.at(0).weight == Approx(0.6));
+  CHECK(points.at(1).start == 1000);
+  CHECK(points.at(1).weight == Approx(0.4));
+}
+
+TEST_CASE("There are no more SimPoints than intervals") {
+  std::vector<std::vector<double>> bbvs{{1.0, 0.0}, {0.0, 1.0}};
+  auto points = champsim::choose_simpoints(bbvs, 5, 1000);
+
+  REQUIRE(std::size(points) == 2);
+  CHECK(points.at(0).weight == Approx(0.5));
+}
+
+TEST_CASE("The statistics of the intervals are combined by their weights") {
+  auto make_stats = [](uint64_t instrs, uint64_t cycles, uint64_t hits) {
+    champsim::phase_stats stats;
+    O3_CPU::stats_type cpu_stats;
+    cpu_stats.name = "CPU 0";
+    cpu_stats.begin_instrs = 500;
+    cpu_stats.end_instrs = 500 + instrs;
+    cpu_stats.begin_cycles = 100;
+    cpu_stats.end_cycles = 100 + cycles;
+    stats.sim_cpu_stats.push_back(cpu_stats);
+    stats.roi_cpu_stats.push_back(cpu_stats);
+
+    CACHE::stats_type cache_stats;
+    cache_stats.name = "LLC";
+    cache_stats.hits.at(0).at(0) = hits;
+    stats.sim_cache_stats.push_back(cache_stats);
+    stats.roi_cache_stats.push_back(cache_stats);
+    return stats;
+  };
+
+  std::vector<champsim::phase_stats> stats{make_stats(1000, 2000, 10), make_stats(1000, 4000, 30)};
+  auto combined = champsim::weighted_stats("Weighted", stats, {{0, 0.75}, {5000, 0.25}});
+
+  CHECK(combined.name == "Weighted");
+  REQUIRE(std::size(combined.roi_cpu_stats) == 1);
+  CHECK(combined.roi_cpu_stats.front().instrs() == 1000);
+  CHECK(combined.roi_cpu_stats.front().cycles() == 2500);
+  REQUIRE(std::size(combined.roi_cache_stats) == 1);
+  CHECK(combined.roi_cache_stats.front().hits.at(0).at(0) == 15);
+}
@@ -0,0 +1,84 @@
+#include <catch.hpp>
+#include "batch.h"
+#include "instr.h"
+#include "tracereader.h"
+
+#include <thread>
+
+namespace
+{
+struct counting_trace {
+  uint64_t first_ip;
+  std::size_t length;
+  std::size_t count = 0;
+
+  ooo_model_instr operator()() { return champsim::test::instruction_with_ip(first_ip + count++); }
+  bool eof() const { return count >= length; }
+};
+
+std::vector<uint64_t> read_ips(champsim::tracereader& trace)
+{
+  std::vector<uint64_t> ips;
+  while (!trace.eof())
+    ips.push_back(trace().ip);
+  return ips;
+}
+
+std::vector<champsim::tracereader> make_sources(std::size_t count, std::size_t length)
+{
+  std::vector<champsim::tracereader> sources;
+  for (std::size_t i = 0; i < count; ++i)
+    sources.emplace_back(counting_trace{0x100000 * (i + 1), length});
+  return sources;
+}
+} // namespace
+
+TEST_CASE("Each consumer of a fanned-out trace reads the whole trace") {
+  constexpr std::size_t length = 3 * champsim::trace_fanout::chunk_size + 5;
+  champsim::trace_fanout uut{make_sources(1, length), 2};
+  auto first = uut.reader(0, 0);
+  auto second = uut.reader(0, 1);
+
+  auto first_ips = read_ips(first);
+  auto second_ips = read_ips(second);
+
+  REQUIRE(std::size(first_ips) == length);
+  CHECK(first_ips.front() == 0x100000);
+  CHECK(first_ips.back() == 0x100000 + length - 1);
+  CHECK(first_ips == second_ips);
+}
+
+TEST_CASE("A finished consumer does not hold back the others") {
+  constexpr std::size_t length = 4 * champsim::trace_fanout::chunk_size;
+  champsim::trace_fanout uut{make_sources(1, length), 2, 1};
+  auto reader = uut.reader(0, 1);
+  uut.finish(0);
+
+  REQUIRE(std::size(read_ips(reader)) == length);
+}
+
+TEST_CASE("Consumers that read the traces in opposite orders do not wait for each other forever") {
+  constexpr std::size_t length = 4 * champsim::trace_fanout::chunk_size;
+  champsim::trace_fanout uut{make_sources(2, length), 2, 1};
+
+  std::vector<std::vector<champsim::tracereader>> readers(2);
+  for (std::size_t consumer = 0; consumer < 2; ++consumer) {
+    readers[consumer].push_back(uut.reader(consumer, consumer));
+    readers[consumer].push_back(uut.reader(1 - consumer, consumer));
+  }
+
+  std::vector<std::size_t> counts(2, 0);
+  std::vector<std::thread> threads;
+  for (std::size_t consumer = 0; consumer < 2; ++consumer) {
+    threads.emplace_back([&, consumer] {
+      for (auto& reader : readers[consumer])
+        counts[consumer] += std::size(read_ips(reader));
+      uut.finish(consumer);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  CHECK(counts[0] == 2 * length);
+  CHECK(counts[1] == 2 * length);
+}
@@ -0,0 +1,67 @@
+#include <catch.hpp>
+#include "async_reader.h"
+#include "instr.h"
+#include "tracereader.h"
+
+#include <stdexcept>
+
+namespace
+{
+struct counting_trace {
+  std::size_t length;
+  std::size_t count = 0;
+
+  ooo_model_instr operator()() { return champsim::test::instruction_with_ip(0x1000 + count++); }
+  bool eof() const { return count >= length; }
+};
+
+struct endless_trace {
+  std::size_t count = 0;
+
+  ooo_model_instr operator()() { return champsim::test::instruction_with_ip(count++); }
+  bool eof() const { return false; }
+};
+
+struct failing_trace {
+  std::size_t count = 0;
+
+  ooo_model_instr operator()()
+  {
+    if (count == 3)
+      throw std::runtime_error{"corrupt trace"};
+    return champsim::test::instruction_with_ip(count++);
+  }
+  bool eof() const { return false; }
+};
+} // namespace
+
+TEST_CASE("An asynchronous reader produces the instructions of its source in order") {
+  champsim::tracereader uut{champsim::async_reader{counting_trace{100}, 8}};
+
+  std::vector<uint64_t> ips;
+  while (!uut.eof())
+    ips.push_back(uut().ip);
+
+  REQUIRE(std::size(ips) == 100);
+  for (std::size_t i = 0; i < std::size(ips); ++i)
+    CHECK(ips[i] == 0x1000 + i);
+}
+
+TEST_CASE("An asynchronous reader of an empty source is at its end") {
+  champsim::async_reader uut{counting_trace{0}};
+  REQUIRE(uut.eof());
+}
+
+TEST_CASE("An asynchronous reader can be destroyed while its producer waits for space") {
+  champsim::async_reader uut{endless_trace{}, 4};
+  REQUIRE(uut().ip == 0);
+}
+
+TEST_CASE("An error in the source is raised when the reader reaches it") {
+  champsim::async_reader uut{failing_trace{}};
+  for (int i = 0; i < 3; ++i) {
+    REQUIRE_FALSE(uut.eof());
+    uut();
+  }
+  REQUIRE_THROWS_AS(uut.eof(), std::runtime_error);
+}
@@ -0,0 +1,85 @@
+#include <catch.hpp>
+#include "seekable_zstd.h"
+#include "temp_file.h"
+
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+std::vector<char> test_data(std::size_t size)
+{
+  std::vector<char> data(size);
+  for (std::size_t i = 0; i < size; ++i)
+    data[i] = static_cast<char>((i * 7) % 251);
+  return data;
+}
+
+std::string write_test_file(const champsim::test::temp_file& temp, const std::vector<char>& data, std::size_t frame_size)
+{
+  auto fname = temp.string();
+  std::ofstream file{fname, std::ios::binary};
+  champsim::seekable_zstd_writer writer{file, frame_size};
+  writer.write(std::data(data), std::size(data));
+  writer.close();
+  return fname;
+}
+
+std::vector<char> read_all(champsim::seekable_zstd_istream& stream)
+{
+  std::vector<char> result;
+  std::array<char, 64> buffer;
+  do {
+    stream.read(std::data(buffer), std::size(buffer));
+    result.insert(std::end(result), std::begin(buffer), std::next(std::begin(buffer), stream.gcount()));
+  } while (!stream.eof());
+  return result;
+}
+} // namespace
+
+TEST_CASE("A seekable Zstandard file has one frame in its seek table for each frame of data") {
+  auto data = test_data(1000);
+  champsim::test::temp_file temp{".zst"};
+  std::ifstream file{write_test_file(temp, data, 100), std::ios::binary};
+  auto frames = champsim::read_zstd_seek_table(file);
+
+  REQUIRE(std::size(frames) == 10);
+  CHECK(frames.at(3).decompressed_offset == 300);
+  CHECK(frames.at(3).decompressed_size == 100);
+  CHECK(frames.at(3).compressed_offset == frames.at(2).compressed_offset + frames.at(2).compressed_size);
+}
+
+TEST_CASE("A seekable Zstandard file reads back its data") {
+  auto data = test_data(1000);
+  champsim::test::temp_file temp{".zst"};
+  champsim::seekable_zstd_istream uut{write_test_file(temp, data, 96), 3};
+
+  CHECK(uut.size() == 1000);
+  CHECK(read_all(uut) == data);
+}
+
+TEST_CASE("A seekable Zstandard file can be read from an offset within a frame") {
+  auto data = test_data(1000);
+  champsim::test::temp_file temp{".zst"};
+  champsim::seekable_zstd_istream uut{write_test_file(temp, data, 100), 2};
+  uut.seek(450);
+
+  REQUIRE(read_all(uut) == std::vector<char>(std::next(std::begin(data), 450), std::end(data)));
+}
+
+TEST_CASE("A seekable Zstandard file is at its end after seeking past it") {
+  auto data = test_data(1000);
+  champsim::test::temp_file temp{".zst"};
+  champsim::seekable_zstd_istream uut{write_test_file(temp, data, 100), 2};
+  uut.seek(5000);
+
+  REQUIRE(std::empty(read_all(uut)));
+  REQUIRE(uut.eof());
+}
+
+TEST_CASE("A file without a seek table is rejected") {
+  std::istringstream file{"not a seekable Zstandard file"};
+  REQUIRE_THROWS_AS(champsim::read_zstd_seek_table(file), std::runtime_error);
+}
@@ -0,0 +1,88 @@
+#include <catch.hpp>
+#include "async_reader.h"
+#include "repeatable.h"
+#include "seekable_zstd.h"
+#include "trace_instruction.h"
+#include "tracereader.h"
+#include "temp_file.h"
+
+#include <fstream>
+
+namespace
+{
+constexpr std::size_t trace_length = 5000;
+
+std::string write_test_trace(const champsim::test::temp_file& temp)
+{
+  auto fname = temp.string();
+  std::ofstream file{fname, std::ios::binary};
+  champsim::seekable_zstd_writer writer{file, 64 * sizeof(input_instr)};
+  for (std::size_t i = 0; i < trace_length; ++i) {
+    input_instr record{};
+    record.ip = 0x1000 + 4 * i;
+    record.is_branch = (i % 7 == 6);
+    record.branch_taken = record.is_branch;
+    writer.write(reinterpret_cast<const char*>(&record), sizeof(record));
+  }
+  writer.close();
+  return fname;
+}
+
+using seekable_reader = champsim::bulk_tracereader<input_instr, champsim::seekable_zstd_istream>;
+
+std::vector<ooo_model_instr> read_all(champsim::tracereader& trace)
+{
+  std::vector<ooo_model_instr> result;
+  while (!trace.eof())
+    result.push_back(trace());
+  return result;
+}
+} // namespace
+
+TEST_CASE("Skipping a seekable trace gives the same instructions as reading through it") {
+  champsim::test::temp_file temp{".champsimtrace.zst"};
+  auto fname = write_test_trace(temp);
+  auto skip_count = GENERATE(as<uint64_t>{}, 1, 100, 130, 4000);
+
+  champsim::tracereader reference{seekable_reader{0, fname}};
+  auto expected = read_all(reference);
+  REQUIRE(std::size(expected) == trace_length - 1);
+
+  champsim::tracereader uut{seekable_reader{0, fname}};
+  uut(); // Start from a partly read buffer
+  REQUIRE(uut.skip(skip_count) == skip_count);
+  CHECK(uut.position() == skip_count + 1);
+
+  auto actual = read_all(uut);
+  REQUIRE(std::size(actual) == std::size(expected) - skip_count - 1);
+  for (std::size_t i = 0; i < std::size(actual); ++i) {
+    CHECK(actual[i].ip == expected[i + skip_count + 1].ip);
+    CHECK(actual[i].branch_target == expected[i + skip_count + 1].branch_target);
+  }
+}
+
+TEST_CASE("Skipping past the end of a seekable trace reaches its end") {
+  champsim::test::temp_file temp{".champsimtrace.zst"};
+  champsim::tracereader uut{seekable_reader{0, write_test_trace(temp)}};
+  REQUIRE(uut.skip(2 * trace_length) == trace_length - 1);
+  REQUIRE(uut.eof());
+}
+
+TEST_CASE("An asynchronous reader skips the instructions it has produced, then seeks") {
+  champsim::test::temp_file temp{".champsimtrace.zst"};
+  auto fname = write_test_trace(temp);
+  champsim::tracereader uut{champsim::async_reader{seekable_reader{0, fname}, 16}};
+  uut();
+
+  REQUIRE(uut.skip(1000) == 1000);
+  REQUIRE(uut().ip == 0x1000 + 4 * 1001);
+}
+
+TEST_CASE("A repeated trace skips through as many repetitions as needed") {
+  champsim::test::temp_file temp{".champsimtrace.zst"};
+  auto fname = write_test_trace(temp);
+  champsim::tracereader uut{champsim::repeatable<seekable_reader, uint8_t, std::string>{0, fname}};
+
+  REQUIRE(uut.skip(2 * (trace_length - 1) + 10) == 2 * (trace_length - 1) + 10);
+  REQUIRE(uut().ip == 0x1000 + 4 * 10);
+}
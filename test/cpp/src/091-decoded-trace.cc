@@ -0,0 +1,81 @@
+#include <catch.hpp>
+#include "decoded_trace.h"
+#include "instr.h"
+#include "tracereader.h"
+#include "temp_file.h"
+
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+std::vector<ooo_model_instr> test_instructions(std::size_t count)
+{
+  std::vector<ooo_model_instr> instrs;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto instr = champsim::test::instruction_with_ip(0x1000 + 4 * i);
+    instr.source_memory.push_back(0xdead0000 + 64 * i);
+    instr.destination_registers.push_back(static_cast<uint8_t>(i % 32 + 1));
+    if (i % 5 == 0) {
+      instr.is_branch = true;
+      instr.branch_taken = true;
+      instr.branch_type = BRANCH_CONDITIONAL;
+      instr.branch_target = 0x2000 + i;
+    }
+    instrs.push_back(instr);
+  }
+  return instrs;
+}
+
+std::string write_test_file(const champsim::test::temp_file& temp, const std::vector<ooo_model_instr>& instrs)
+{
+  auto fname = temp.string();
+  std::ofstream file{fname, std::ios::binary};
+  champsim::decoded_trace_writer writer{file, false};
+  for (const auto& instr : instrs)
+    writer.write(instr);
+  writer.close();
+  return fname;
+}
+} // namespace
+
+TEST_CASE("A pre-decoded trace reads back the instructions that were written") {
+  auto instrs = test_instructions(100);
+  champsim::test::temp_file temp{".decoded"};
+  champsim::decoded_tracereader reader{2, write_test_file(temp, instrs)};
+
+  for (const auto& expected : instrs) {
+    REQUIRE_FALSE(reader.eof());
+    auto instr = reader();
+    CHECK(instr.ip == expected.ip);
+    CHECK(instr.is_branch == expected.is_branch);
+    CHECK(instr.branch_taken == expected.branch_taken);
+    CHECK(instr.branch_type == expected.branch_type);
+    CHECK(instr.branch_target == expected.branch_target);
+    CHECK(instr.source_memory == expected.source_memory);
+    CHECK(instr.destination_registers == expected.destination_registers);
+    CHECK(instr.asid[0] == 2);
+  }
+  CHECK(reader.eof());
+}
+
+TEST_CASE("A pre-decoded trace skips to an instruction without reading the ones before it") {
+  auto instrs = test_instructions(100);
+  champsim::test::temp_file temp{".decoded"};
+  champsim::tracereader reader{champsim::decoded_tracereader{0, write_test_file(temp, instrs)}};
+
+  CHECK(reader.skip(42) == 42);
+  CHECK(reader().ip == instrs.at(42).ip);
+  CHECK(reader.skip(1000) == 57);
+  CHECK(reader.eof());
+}
+
+TEST_CASE("A file that is not a pre-decoded trace is rejected") {
+  champsim::test::temp_file temp{".decoded"};
+  auto fname = temp.string();
+  {
+    std::ofstream file{fname, std::ios::binary};
+    file << "This is not a pre-decoded trace, but it is long enough to hold a header.";
+  }
+  REQUIRE_THROWS_AS((champsim::decoded_tracereader{0, fname}), std::runtime_error);
+}
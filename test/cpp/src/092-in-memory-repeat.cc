@@ -0,0 +1,71 @@
+#include <catch.hpp>
+#include "instr.h"
+#include "repeatable.h"
+
+namespace
+{
+std::size_t opens = 0;
+
+struct counted_trace {
+  std::size_t length;
+  std::size_t count = 0;
+
+  explicit counted_trace(std::size_t len) : length(len) { ++opens; }
+
+  ooo_model_instr operator()() { return champsim::test::instruction_with_ip(0x1000 + 4 * count++); }
+  bool eof() const { return count >= length; }
+};
+
+struct seekable_trace : counted_trace {
+  using counted_trace::counted_trace;
+
+  uint64_t skip(uint64_t skip_count)
+  {
+    auto skipped = std::min<uint64_t>(skip_count, length - count);
+    count += skipped;
+    return skipped;
+  }
+};
+} // namespace
+
+TEST_CASE("A trace that fits in memory is replayed without reopening it") {
+  opens = 0;
+  champsim::in_memory_repeatable<counted_trace, std::size_t> reader{10 * sizeof(decoded_instr), 10};
+
+  for (int pass = 0; pass < 3; ++pass) {
+    for (uint64_t i = 0; i < 10; ++i)
+      REQUIRE(reader().ip == 0x1000 + 4 * i);
+  }
+  CHECK(opens == 1);
+}
+
+TEST_CASE("A trace that does not fit in memory is reopened") {
+  opens = 0;
+  champsim::in_memory_repeatable<counted_trace, std::size_t> reader{5 * sizeof(decoded_instr), 10};
+
+  for (int pass = 0; pass < 3; ++pass) {
+    for (uint64_t i = 0; i < 10; ++i)
+      REQUIRE(reader().ip == 0x1000 + 4 * i);
+  }
+  CHECK(opens == 3);
+}
+
+TEST_CASE("A trace in memory skips around its end") {
+  champsim::in_memory_repeatable<counted_trace, std::size_t> reader{10 * sizeof(decoded_instr), 10};
+
+  CHECK(reader.skip(4) == 4);
+  CHECK(reader().ip == 0x1000 + 4 * 4);
+  CHECK(reader.skip(12) == 12);
+  CHECK(reader().ip == 0x1000 + 4 * 7);
+}
+
+TEST_CASE("A skip too large for memory seeks instead") {
+  opens = 0;
+  champsim::in_memory_repeatable<seekable_trace, std::size_t> reader{5 * sizeof(decoded_instr), 10};
+
+  CHECK(reader.skip(8) == 8);
+  CHECK(reader().ip == 0x1000 + 4 * 8);
+  CHECK(reader().ip == 0x1000 + 4 * 9);
+  CHECK(reader().ip == 0x1000);
+  CHECK(opens == 2);
+}
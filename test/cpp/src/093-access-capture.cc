@@ -0,0 +1,116 @@
+#include <catch.hpp>
+#include "access_capture.h"
+#include "cache.h"
+#include "defaults.hpp"
+#include "repl_interface.h"
+#include "temp_file.h"
+
+#include <map>
+#include <vector>
+
+namespace test
+{
+  extern std::map<CACHE*, std::vector<repl_update_interface>> replacement_update_state_collector;
+}
+
+namespace
+{
+champsim::cache_access make_access(uint64_t address, uint64_t cycle, uint8_t flags = 0)
+{
+  champsim::cache_access access{};
+  access.address = address;
+  access.ip = 0x400000;
+  access.cycle = cycle;
+  access.type = static_cast<uint8_t>(champsim::to_underlying(access_type::LOAD));
+  access.flags = flags;
+  return access;
+}
+
+std::string write_capture(const champsim::test::temp_file& temp, const std::vector<champsim::cache_access>& accesses, std::vector<uint64_t> instructions)
+{
+  auto fname = temp.string();
+  champsim::access_capture_writer writer{fname};
+  for (const auto& access : accesses)
+    writer.write(access);
+  writer.close(instructions);
+  return fname;
+}
+} // namespace
+
+TEST_CASE("Captured accesses are read back, followed by the instruction counts") {
+  std::vector<champsim::cache_access> accesses;
+  for (uint64_t i = 0; i < 10000; ++i)
+    accesses.push_back(make_access(i << 6, i, (i % 3 == 0) ? champsim::cache_access::hit_flag : 0));
+
+  champsim::test::temp_file temp{".zst"};
+  champsim::access_capture_reader reader{write_capture(temp, accesses, {1234})};
+
+  champsim::cache_access access;
+  for (const auto& expected : accesses) {
+    REQUIRE(reader.read(access));
+    CHECK(access.address == expected.address);
+    CHECK(access.cycle == expected.cycle);
+    CHECK(access.flags == expected.flags);
+  }
+
+  REQUIRE(reader.read(access));
+  CHECK(access.type == champsim::cache_access::instructions_marker);
+  CHECK(access.address == 1234);
+  CHECK_FALSE(reader.read(access));
+}
+
+TEST_CASE("Replayed accesses update the tags and the replacement policy") {
+  CACHE uut{CACHE::Builder{champsim::defaults::default_llc}
+    .name("093-uut")
+    .sets(1)
+    .ways(2)
+    .offset_bits(6)
+    .replacement<CACHE::rtestDcppDmodulesDreplacementDlru_collect>()
+  };
+  uut.initialize();
+
+  // The third access hits, and the fourth evicts the least recently used line, so that the fifth misses
+  champsim::test::temp_file temp{".zst"};
+  auto fname = write_capture(temp, {make_access(0x1000, 1, champsim::cache_access::warmup_flag), make_access(0x2000, 2), make_access(0x1000, 3),
+                                    make_access(0x3000, 4), make_access(0x2000, 5)},
+                             {500});
+  champsim::access_capture_reader reader{fname};
+  test::replacement_update_state_collector[&uut].clear();
+  auto stats = champsim::replay_accesses(uut, reader);
+
+  CHECK(stats.warmup_accesses == 1);
+  CHECK(stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 1);
+  CHECK(stats.misses.at(champsim::to_underlying(access_type::LOAD)).at(0) == 3);
+  REQUIRE(std::size(stats.instructions) == 1);
+  CHECK(stats.instructions.front() == 500);
+
+  auto& updates = test::replacement_update_state_collector[&uut];
+  REQUIRE(std::size(updates) == 5);
+  CHECK(updates.at(2).hit);
+  CHECK(updates.at(3).victim_addr == 0x2000);
+}
+
+TEST_CASE("Warming a cache replays only the accesses captured during the warmup") {
+  CACHE uut{CACHE::Builder{champsim::defaults::default_llc}
+    .name("093-uut-warm")
+    .sets(1)
+    .ways(4)
+    .offset_bits(6)
+    .replacement<CACHE::rtestDcppDmodulesDreplacementDlru_collect>()
+  };
+  uut.initialize();
+  uut.current_cycle = 77;
+  uut.warmup = false;
+
+  champsim::test::temp_file temp{".zst"};
+  auto fname = write_capture(temp, {make_access(0x1000, 1, champsim::cache_access::warmup_flag), make_access(0x2000, 2, champsim::cache_access::warmup_flag),
+                                    make_access(0x3000, 3), make_access(0x4000, 4, champsim::cache_access::warmup_flag)},
+                             {500});
+  champsim::access_capture_reader reader{fname};
+  test::replacement_update_state_collector[&uut].clear();
+
+  CHECK(champsim::warm_with_accesses(uut, reader) == 2);
+  CHECK(std::size(test::replacement_update_state_collector[&uut]) == 2);
+  CHECK(uut.current_cycle == 77);
+  CHECK_FALSE(uut.warmup);
+}
@@ -0,0 +1,99 @@
+#include <catch.hpp>
+#include "clock_schedule.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace
+{
+struct logging_operable : champsim::operable {
+  int id;
+  std::vector<std::pair<int, uint64_t>>* log;
+
+  logging_operable(double scale, int id_, std::vector<std::pair<int, uint64_t>>* log_) : champsim::operable(scale), id(id_), log(log_) {}
+
+  long operate() override
+  {
+    log->emplace_back(id, current_cycle);
+    return 1;
+  }
+};
+
+// The loop that the schedule replaces
+std::vector<std::pair<int, uint64_t>> sorted_log(const std::vector<double>& scales, uint64_t cycles)
+{
+  std::vector<std::pair<int, uint64_t>> log;
+  std::vector<std::unique_ptr<logging_operable>> elements;
+  for (std::size_t i = 0; i < std::size(scales); ++i)
+    elements.push_back(std::make_unique<logging_operable>(scales[i], static_cast<int>(i), &log));
+  std::vector<std::reference_wrapper<champsim::operable>> operables;
+  for (auto& elem : elements)
+    operables.push_back(*elem);
+
+  for (uint64_t cycle = 0; cycle < cycles; ++cycle) {
+    for (champsim::operable& op : operables)
+      op._operate();
+    std::sort(std::begin(operables), std::end(operables),
+              [](const champsim::operable& lhs, const champsim::operable& rhs) { return lhs.leap_operation < rhs.leap_operation; });
+  }
+  return log;
+}
+
+std::pair<std::vector<std::pair<int, uint64_t>>, bool> scheduled_log(const std::vector<double>& scales, uint64_t cycles,
+                                                                      std::size_t max_period = champsim::clock_schedule::default_max_period)
+{
+  std::vector<std::pair<int, uint64_t>> log;
+  std::vector<std::unique_ptr<logging_operable>> elements;
+  for (std::size_t i = 0; i < std::size(scales); ++i)
+    elements.push_back(std::make_unique<logging_operable>(scales[i], static_cast<int>(i), &log));
+  std::vector<std::reference_wrapper<champsim::operable>> operables;
+  for (auto& elem : elements)
+    operables.push_back(*elem);
+
+  champsim::clock_schedule schedule{operables, max_period};
+  for (uint64_t cycle = 0; cycle < cycles; ++cycle)
+    schedule.operate();
+  return {log, schedule.periodic()};
+}
+
+// As the lockstep executor does, collect the elements first and operate them at the end of the cycle
+std::vector<std::pair<int, uint64_t>> deferred_log(const std::vector<double>& scales, uint64_t cycles, std::size_t max_period)
+{
+  std::vector<std::pair<int, uint64_t>> log;
+  std::vector<std::unique_ptr<logging_operable>> elements;
+  for (std::size_t i = 0; i < std::size(scales); ++i)
+    elements.push_back(std::make_unique<logging_operable>(scales[i], static_cast<int>(i), &log));
+  std::vector<std::reference_wrapper<champsim::operable>> operables;
+  for (auto& elem : elements)
+    operables.push_back(*elem);
+
+  champsim::clock_schedule schedule{operables, max_period};
+  for (uint64_t cycle = 0; cycle < cycles; ++cycle) {
+    std::vector<champsim::operable*> pending;
+    schedule.advance([&pending](champsim::operable& op) { pending.push_back(&op); });
+    for (auto op : pending)
+      op->_operate();
+  }
+  return log;
+}
+} // namespace
+
+TEST_CASE("The clock schedule operates the elements in the same order as sorting them each cycle") {
+  auto scales = GENERATE(std::vector<double>{1, 1, 1, 1}, std::vector<double>{1, 1.25, 1, 2}, std::vector<double>{1.5, 1, 1.25, 4, 1},
+                         std::vector<double>(20, 1.0), std::vector<double>{1, 4.0 / 3.0, 1});
+
+  auto [log, periodic] = scheduled_log(scales, 1000);
+  CHECK(log == sorted_log(scales, 1000));
+  if (std::all_of(std::begin(scales), std::end(scales), [](double x) { return x == 1 || x == 1.25 || x == 1.5 || x == 2 || x == 4; }))
+    CHECK(periodic);
+}
+
+TEST_CASE("The clock schedule keeps the order of the serial loop when the elements are operated after advancing") {
+  auto scales = GENERATE(std::vector<double>{1, 1.25, 1, 2}, std::vector<double>{1.6, 1, 1.6, 1}, std::vector<double>{1, 4.0 / 3.0, 1});
+  auto max_period = GENERATE(std::size_t{0}, champsim::clock_schedule::default_max_period);
+
+  CHECK(deferred_log(scales, 1000, max_period) == sorted_log(scales, 1000));
+  CHECK(scheduled_log(scales, 1000, max_period).first == sorted_log(scales, 1000));
+}
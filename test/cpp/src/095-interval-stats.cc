@@ -0,0 +1,92 @@
+#include <catch.hpp>
+#include "interval_stats.h"
+#include "temp_file.h"
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+champsim::interval_stats make_stats(uint64_t instrs, uint64_t cycles, uint64_t hits, uint64_t misses, uint64_t miss_latency)
+{
+  champsim::interval_stats stats;
+
+  O3_CPU::stats_type cpu_stats;
+  cpu_stats.name = "CPU 0";
+  cpu_stats.begin_instrs = 100;
+  cpu_stats.end_instrs = 100 + instrs;
+  cpu_stats.begin_cycles = 50;
+  cpu_stats.end_cycles = 50 + cycles;
+  cpu_stats.branch_type_misses.at(BRANCH_CONDITIONAL) = static_cast<long long>(instrs / 100);
+  stats.cpu_stats.push_back(cpu_stats);
+
+  CACHE::stats_type cache_stats;
+  cache_stats.name = "LLC";
+  cache_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) = hits;
+  cache_stats.misses.at(champsim::to_underlying(access_type::LOAD)).at(0) = misses;
+  cache_stats.total_miss_latency = miss_latency;
+  stats.cache_stats.push_back(cache_stats);
+
+  champsim::channel::stats_type queue_stats;
+  queue_stats.RQ_ACCESS = hits + misses;
+  stats.cache_queue_stats.push_back(queue_stats);
+
+  DRAM_CHANNEL::stats_type dram_stats;
+  dram_stats.RQ_ROW_BUFFER_MISS = static_cast<unsigned>(misses);
+  stats.dram_stats.push_back(dram_stats);
+
+  return stats;
+}
+} // namespace
+
+TEST_CASE("The statistics of an interval are the differences between two snapshots") {
+  auto stats = champsim::difference(make_stats(3000, 4000, 70, 30, 3000), make_stats(1000, 1500, 20, 10, 1000));
+
+  REQUIRE(std::size(stats.cpu_stats) == 1);
+  CHECK(stats.cpu_stats.front().instrs() == 2000);
+  CHECK(stats.cpu_stats.front().cycles() == 2500);
+  CHECK(stats.cpu_stats.front().branch_type_misses.at(BRANCH_CONDITIONAL) == 20);
+  CHECK(stats.instrs() == 2000);
+
+  REQUIRE(std::size(stats.cache_stats) == 1);
+  CHECK(stats.cache_stats.front().name == "LLC");
+  CHECK(stats.cache_stats.front().hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 50);
+  CHECK(stats.cache_stats.front().misses.at(champsim::to_underlying(access_type::LOAD)).at(0) == 20);
+  CHECK(stats.cache_stats.front().avg_miss_latency == Approx(100));
+
+  REQUIRE(std::size(stats.cache_queue_stats) == 1);
+  CHECK(stats.cache_queue_stats.front().RQ_ACCESS == 70);
+
+  REQUIRE(std::size(stats.dram_stats) == 1);
+  CHECK(stats.dram_stats.front().RQ_ROW_BUFFER_MISS == 20);
+}
+
+TEST_CASE("Each interval is written as one line of JSON") {
+  champsim::test::temp_file temp{".jsonl"};
+  auto fname = temp.string();
+  {
+    champsim::interval_stats_writer writer{fname, 1000};
+    for (uint64_t i = 0; i < 3; ++i) {
+      auto stats = make_stats(1000, 2000, 10 * i, 5, 500);
+      stats.phase = "Simulation";
+      stats.index = i;
+      writer.write(stats);
+    }
+  }
+
+  std::ifstream file{fname};
+  std::string line;
+  uint64_t index = 0;
+  while (std::getline(file, line)) {
+    auto record = nlohmann::json::parse(line);
+    CHECK(record.at("phase") == "Simulation");
+    CHECK(record.at("interval") == index);
+    CHECK(record.at("instructions") == 1000);
+    CHECK(record.at("cores").at(0).at("cycles") == 2000);
+    CHECK(record.at("caches").at("LLC").at("LOAD").at("hit").at(0) == 10 * index);
+    CHECK(record.at("caches").at("LLC").at("queues").at("RQ").at("access") == 10 * index + 5);
+    CHECK(record.at("DRAM").at(0).at("RQ ROW_BUFFER_MISS") == 5);
+    ++index;
+  }
+  CHECK(index == 3);
+}
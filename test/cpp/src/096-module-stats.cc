@@ -0,0 +1,74 @@
+#include <catch.hpp>
+#include "cache.h"
+#include "defaults.hpp"
+#include "module_stats.h"
+#include "repl_interface.h"
+
+TEST_CASE("Registered statistics are reported in the order they were registered") {
+  uint64_t first = 3, second = 5;
+  uint64_t buckets[3] = {1, 2, 3};
+
+  champsim::module_stats_registry registry;
+  registry.add_counter("first", first);
+  registry.add_counter("second", second);
+  registry.add_histogram("buckets", buckets);
+
+  auto values = registry.values();
+  REQUIRE(std::size(values.counters) == 2);
+  CHECK(values.counters.at(0) == std::pair<std::string, uint64_t>{"first", 3});
+  CHECK(values.counters.at(1) == std::pair<std::string, uint64_t>{"second", 5});
+  REQUIRE(std::size(values.histograms) == 1);
+  CHECK(values.histograms.at(0).first == "buckets");
+  CHECK(values.histograms.at(0).second == std::vector<uint64_t>{1, 2, 3});
+}
+
+TEST_CASE("Resetting the registry zeroes the values in the module") {
+  uint64_t counter = 3;
+  std::array<uint64_t, 2> buckets = {4, 5};
+
+  champsim::module_stats_registry registry;
+  registry.add_counter("counter", counter);
+  registry.add_histogram("buckets", buckets);
+  registry.reset();
+
+  CHECK(counter == 0);
+  CHECK(buckets == std::array<uint64_t, 2>{0, 0});
+}
+
+TEST_CASE("The difference between two sets of values is taken element by element") {
+  uint64_t counter = 3;
+  uint64_t buckets[2] = {4, 5};
+
+  champsim::module_stats_registry registry;
+  registry.add_counter("counter", counter);
+  registry.add_histogram("buckets", buckets);
+
+  auto before = registry.values();
+  counter += 10;
+  buckets[1] += 7;
+  auto diff = champsim::difference(registry.values(), before);
+
+  CHECK(diff.counters.at(0).second == 10);
+  CHECK(diff.histograms.at(0).second == std::vector<uint64_t>{0, 7});
+}
+
+TEST_CASE("A cache reports the statistics registered with it for each phase") {
+  CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+    .name("096-uut")
+    .replacement<CACHE::rtestDcppDmodulesDreplacementDlru_collect>()
+  };
+
+  uint64_t counter = 0;
+  uut.stats_registry.add_counter("counter", counter);
+
+  counter = 7; // counted in the warmup
+  uut.begin_phase();
+  CHECK(counter == 0);
+
+  counter = 11;
+  uut.end_phase(0);
+
+  REQUIRE(std::size(uut.roi_stats.modules.counters) == 1);
+  CHECK(uut.roi_stats.modules.counters.at(0).second == 11);
+  CHECK(uut.sim_stats.modules.counters.at(0).second == 11);
+}
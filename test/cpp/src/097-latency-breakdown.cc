@@ -0,0 +1,72 @@
+#include <catch.hpp>
+#include "cache.h"
+#include "latency_histograms.h"
+#include "request_timeline.h"
+
+TEST_CASE("A request timeline measures the cycles between the events it has reached") {
+  champsim::basic_request_timeline<true> timeline;
+  timeline.mark(champsim::request_event::ENQUEUE, 100);
+  timeline.mark(champsim::request_event::TAG_CHECK, 104);
+
+  CHECK(timeline.between(champsim::request_event::ENQUEUE, champsim::request_event::TAG_CHECK) == 4);
+  CHECK_FALSE(timeline.between(champsim::request_event::TAG_CHECK, champsim::request_event::ISSUE).has_value());
+}
+
+TEST_CASE("Marking an event first does not move it") {
+  champsim::basic_request_timeline<true> timeline;
+  timeline.mark_first(champsim::request_event::TAG_ATTEMPT, 10);
+  timeline.mark_first(champsim::request_event::TAG_ATTEMPT, 20);
+  timeline.mark(champsim::request_event::ISSUE, 25);
+
+  CHECK(timeline.between(champsim::request_event::TAG_ATTEMPT, champsim::request_event::ISSUE) == 15);
+}
+
+TEST_CASE("A timeline that is compiled out records nothing") {
+  champsim::basic_request_timeline<false> timeline;
+  timeline.mark(champsim::request_event::ENQUEUE, 100);
+  timeline.mark(champsim::request_event::TAG_CHECK, 104);
+
+  CHECK_FALSE(timeline.has(champsim::request_event::ENQUEUE));
+  CHECK_FALSE(timeline.between(champsim::request_event::ENQUEUE, champsim::request_event::TAG_CHECK).has_value());
+}
+
+TEST_CASE("Latencies are counted in power-of-two buckets") {
+  using histograms_type = champsim::latency_histograms<cache_hop, true>;
+  CHECK(histograms_type::bucket(0) == 0);
+  CHECK(histograms_type::bucket(1) == 1);
+  CHECK(histograms_type::bucket(3) == 2);
+  CHECK(histograms_type::bucket(4) == 3);
+  CHECK(histograms_type::bucket(1ull << 40) == histograms_type::num_buckets - 1);
+
+  histograms_type stats;
+  stats.record(access_type::LOAD, cache_hop::LOWER, 5);
+  stats.record(access_type::LOAD, cache_hop::LOWER, 7);
+  stats.record(access_type::LOAD, cache_hop::LOWER, std::nullopt);
+
+  auto type = champsim::to_underlying(access_type::LOAD);
+  auto hop = champsim::to_underlying(cache_hop::LOWER);
+  CHECK(stats.count(type, hop) == 2);
+  CHECK(stats.buckets[type][hop][3] == 2);
+  CHECK(stats.total_cycles[type][hop] == 12);
+  CHECK_FALSE(stats.empty());
+}
+
+TEST_CASE("The latencies between two sets of histograms are those recorded in between") {
+  champsim::latency_histograms<cache_hop, true> before;
+  before.record(access_type::RFO, cache_hop::TAG, 2);
+
+  auto now = before;
+  now.record(access_type::RFO, cache_hop::TAG, 9);
+
+  auto result = champsim::difference(now, before);
+  auto type = champsim::to_underlying(access_type::RFO);
+  auto hop = champsim::to_underlying(cache_hop::TAG);
+  CHECK(result.count(type, hop) == 1);
+  CHECK(result.total_cycles[type][hop] == 9);
+}
+
+TEST_CASE("Histograms that are compiled out are empty") {
+  champsim::latency_histograms<cache_hop, false> stats;
+  stats.record(access_type::LOAD, cache_hop::TOTAL, 5);
+  CHECK(stats.empty());
+}
@@ -0,0 +1,52 @@
+#include <catch.hpp>
+#include "host_profile.h"
+
+#include <algorithm>
+
+namespace
+{
+struct mock_operable : champsim::operable {
+  using operable::operable;
+  long operate() final { return 1; }
+};
+} // namespace
+
+TEST_CASE("The host profiler samples one cycle in each period") {
+  constexpr uint64_t period = 8;
+  champsim::host_profiler uut{period};
+
+  std::vector<bool> sampled;
+  for (uint64_t i = 0; i < 4 * period; ++i)
+    sampled.push_back(uut.sample());
+
+  CHECK(std::count(std::begin(sampled), std::end(sampled), true) == 4);
+  for (uint64_t i = 0; i < std::size(sampled); ++i)
+    CHECK(sampled.at(i) == ((i + 1) % period == 0));
+}
+
+TEST_CASE("The host profiler does not break down the time if no cycle was sampled") {
+  champsim::host_profiler uut{8};
+  for (int i = 0; i < 7; ++i)
+    uut.sample();
+
+  CHECK(std::empty(uut.breakdown()));
+}
+
+TEST_CASE("The host profiler reports each timed element, then the traces and the rest of the loop") {
+  mock_operable first{1}, second{1};
+  champsim::host_profiler uut{1};
+
+  REQUIRE(uut.sample());
+  CHECK(uut.time(second, [&] { return second._operate(); }) == 1);
+  CHECK(uut.time(first, [&] { return first._operate(); }) == 1);
+  CHECK(uut.time_traces([] { return true; }));
+  CHECK(second.current_cycle == 1);
+
+  auto entries = uut.breakdown();
+  REQUIRE(std::size(entries) == 4);
+  CHECK(entries.at(0).name == "element 0");
+  CHECK(entries.at(1).name == "element 1");
+  CHECK(entries.at(2).name == "trace reading");
+  CHECK(entries.at(3).name == "rest of loop");
+  CHECK(std::all_of(std::begin(entries), std::end(entries), [](const auto& e) { return e.time.count() >= 0; }));
+}
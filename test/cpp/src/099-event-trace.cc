@@ -0,0 +1,154 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "event_trace.h"
+
+#include <sstream>
+
+namespace
+{
+struct mock_operable : champsim::operable {
+  using operable::operable;
+  long operate() final { return 1; }
+};
+
+struct mock_packet {
+  uint64_t address;
+  uint64_t instr_id;
+  access_type type;
+};
+
+std::vector<champsim::packet_event> kinds(const std::vector<champsim::trace_event>& events)
+{
+  std::vector<champsim::packet_event> result;
+  for (const auto& event : events)
+    result.push_back(event.what);
+  return result;
+}
+} // namespace
+
+TEST_CASE("The event tracer keeps the most recent events") {
+  mock_operable clock{1};
+  champsim::event_tracer uut{{}, 3};
+  champsim::event_source source{&uut, uut.add_component("clock", clock)};
+
+  for (uint64_t i = 0; i < 5; ++i) {
+    source.record(champsim::packet_event::HIT, mock_packet{0x1000, i, access_type::LOAD});
+    clock._operate();
+  }
+
+  auto events = uut.events();
+  REQUIRE(std::size(events) == 3);
+  CHECK(events.at(0).instr_id == 2);
+  CHECK(events.at(1).instr_id == 3);
+  CHECK(events.at(2).instr_id == 4);
+  CHECK(events.at(2).cycle == 4);
+  CHECK(uut.dropped() == 2);
+}
+
+TEST_CASE("The event tracer times the events of each component in cycles of the fastest clock") {
+  mock_operable slow{2};
+  champsim::event_tracer uut{{}};
+  champsim::event_source source{&uut, uut.add_component("slow", slow)};
+
+  for (int i = 0; i < 10; ++i)
+    slow._operate();
+  source.record(champsim::packet_event::FILL, mock_packet{0x1000, 0, access_type::LOAD});
+
+  REQUIRE(std::size(uut.events()) == 1);
+  CHECK(uut.events().front().cycle == 5);
+  CHECK(uut.events().front().time == 10);
+}
+
+TEST_CASE("The event tracer records only the events that pass its filter") {
+  mock_operable clock{1};
+  champsim::event_tracer::filter_type filter;
+  filter.addresses = {0x1000, 0x2000};
+  filter.instr_ids = {10, 20};
+  champsim::event_tracer uut{filter};
+  champsim::event_source source{&uut, uut.add_component("clock", clock)};
+
+  source.record(champsim::packet_event::HIT, mock_packet{0x1800, 15, access_type::LOAD});
+  source.record(champsim::packet_event::HIT, mock_packet{0x2000, 15, access_type::LOAD});
+  source.record(champsim::packet_event::HIT, mock_packet{0x1800, 20, access_type::LOAD});
+  source.record(champsim::packet_event::EVICT, mock_packet{0x8000, 15, access_type::LOAD}, 3, 0x1040);
+
+  CHECK(kinds(uut.events()) == std::vector{champsim::packet_event::HIT, champsim::packet_event::EVICT});
+}
+
+TEST_CASE("A source without a tracer records nothing") {
+  champsim::event_source source{};
+  source.record(champsim::packet_event::HIT, mock_packet{0x1000, 0, access_type::LOAD});
+  SUCCEED();
+}
+
+TEST_CASE("Ranges are parsed from decimal or hexadecimal numbers") {
+  CHECK(champsim::parse_range("0x1000:0x2000") == std::pair<uint64_t, uint64_t>{0x1000, 0x2000});
+  CHECK(champsim::parse_range("5:10") == std::pair<uint64_t, uint64_t>{5, 10});
+  CHECK_FALSE(champsim::parse_range("10").has_value());
+  CHECK_FALSE(champsim::parse_range("10:5").has_value());
+  CHECK_FALSE(champsim::parse_range("x:5").has_value());
+  CHECK_FALSE(champsim::parse_range("5:10z").has_value());
+}
+
+TEST_CASE("The trace names each component as a track") {
+  mock_operable clock{1};
+  champsim::event_tracer uut{{}};
+  champsim::event_source source{&uut, uut.add_component("099-track", clock)};
+  source.record(champsim::packet_event::EVICT, mock_packet{0x1000, 7, access_type::WRITE}, 2, 0xbeef);
+
+  std::ostringstream os;
+  uut.write_json(os);
+  auto text = os.str();
+  CHECK(text.find(R"({"name":"thread_name","ph":"M","pid":0,"tid":0,"args":{"name":"099-track"}})") != std::string::npos);
+  CHECK(text.find(R"("name":"evict","cat":"WRITE")") != std::string::npos);
+  CHECK(text.find(R"("way":2,"victim":"0xbeef")") != std::string::npos);
+}
+
+SCENARIO("A cache records the events of a miss") {
+  GIVEN("An empty cache attached to a tracer") {
+    constexpr uint64_t hit_latency = 2;
+    constexpr uint64_t miss_latency = 3;
+    do_nothing_MRC mock_ll{miss_latency};
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("099-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .fill_latency(1)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    champsim::event_tracer tracer{{}};
+    uut.event_trace = {&tracer, tracer.add_component(uut.NAME, uut)};
+    mock_ul.queues.event_trace = uut.event_trace;
+
+    WHEN("A load is issued and returned") {
+      decltype(mock_ul)::request_type test;
+      test.address = 0xdeadbeef;
+      test.cpu = 0;
+      test.instr_id = 99;
+      test.type = access_type::LOAD;
+      REQUIRE(mock_ul.issue(test));
+
+      for (int i = 0; i < 20; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The tracer records its path through the cache") {
+        using champsim::packet_event;
+        CHECK(kinds(tracer.events()) == std::vector{packet_event::ADD_RQ, packet_event::TAG_CHECK, packet_event::MISS, packet_event::FILL});
+        for (const auto& event : tracer.events())
+          CHECK(event.instr_id == 99);
+      }
+    }
+  }
+}
@@ -0,0 +1,112 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+
+#include "cache.h"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("Without a fetch-target queue, the core does not prefetch instructions") {
+  GIVEN("A core with instructions waiting to be fetched") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+      .ftq_size(0)
+    };
+    uut.initialize();
+
+    for (uint64_t i = 0; i < 4; ++i) {
+      uut.threads.front().input_queue.push_back(champsim::test::instruction_with_ip(0x1000 + (i << LOG2_BLOCK_SIZE)));
+      uut.threads.front().input_queue.back().instr_id = i;
+    }
+
+    WHEN("The core operates") {
+      for (int i = 0; i < 5; ++i)
+        uut._operate();
+
+      THEN("No prefetches are issued") {
+        REQUIRE(std::empty(mock_L1I.queues.PQ));
+        REQUIRE(std::empty(uut.FTQ));
+      }
+    }
+  }
+}
+
+SCENARIO("The branch predictor runs ahead of fetch into the fetch-target queue") {
+  GIVEN("A core with a full instruction buffer and instructions in many cache blocks") {
+    constexpr std::size_t ftq_size = 4;
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+      .ifetch_buffer_size(0)
+      .l1i_bandwidth(1)
+      .ftq_size(ftq_size)
+    };
+    uut.initialize();
+
+    for (uint64_t i = 0; i < 6; ++i) {
+      uut.threads.front().input_queue.push_back(champsim::test::instruction_with_ip(0x1000 + (i << LOG2_BLOCK_SIZE)));
+      uut.threads.front().input_queue.back().instr_id = i;
+    }
+
+    WHEN("The core operates") {
+      for (std::size_t i = 0; i < 2 * ftq_size; ++i)
+        uut._operate();
+
+      THEN("The fetch-target queue fills to its depth") {
+        REQUIRE(std::size(uut.FTQ_BLOCKS) == ftq_size);
+        REQUIRE(std::size(uut.FTQ) == ftq_size);
+        REQUIRE(std::size(uut.threads.front().input_queue) == 2);
+      }
+
+      THEN("Each queued block is prefetched into the L1I") {
+        REQUIRE(std::size(mock_L1I.queues.PQ) == ftq_size);
+        for (std::size_t i = 0; i < ftq_size; ++i) {
+          REQUIRE(mock_L1I.queues.PQ.at(i).v_address == (0x1000 + (i << LOG2_BLOCK_SIZE)));
+          REQUIRE(mock_L1I.queues.PQ.at(i).type == access_type::PREFETCH);
+          REQUIRE_FALSE(mock_L1I.queues.PQ.at(i).response_requested);
+        }
+      }
+    }
+  }
+
+  GIVEN("A core with a mispredicted branch in its input") {
+    do_nothing_MRC mock_L1I, mock_L1D, mock_ll;
+    CACHE l1i{CACHE::Builder{champsim::defaults::default_l1i}
+      .name("160-l1i")
+      .lower_level(&mock_ll.queues)
+    };
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .l1i(&l1i)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+      .ifetch_buffer_size(0)
+      .ftq_size(8)
+    };
+    uut.initialize();
+    uut.warmup = false;
+
+    uut.threads.front().input_queue.push_back(champsim::test::instruction_with_ip(0x1000));
+    uut.threads.front().input_queue.back().instr_id = 0;
+    uut.threads.front().input_queue.back().is_branch = true;
+    uut.threads.front().input_queue.back().branch_type = BRANCH_DIRECT_JUMP;
+    uut.threads.front().input_queue.back().branch_taken = true;
+    uut.threads.front().input_queue.back().branch_target = 0x8000;
+
+    uut.threads.front().input_queue.push_back(champsim::test::instruction_with_ip(0x8000));
+    uut.threads.front().input_queue.back().instr_id = 1;
+
+    WHEN("The core operates") {
+      for (int i = 0; i < 5; ++i)
+        uut._operate();
+
+      THEN("The run-ahead stops at the mispredicted branch") {
+        REQUIRE(std::size(uut.FTQ) == 1);
+        REQUIRE(uut.FTQ.front().branch_mispredicted);
+        REQUIRE(std::size(uut.threads.front().input_queue) == 1);
+      }
+    }
+  }
+}
@@ -0,0 +1,104 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+
+#include "ooo_cpu.h"
+#include "instr.h"
+
+namespace
+{
+void fill_threads(O3_CPU& uut)
+{
+  for (std::size_t thread = 0; thread < std::size(uut.threads); ++thread) {
+    for (uint64_t i = 0; i < 4; ++i) {
+      auto instr = champsim::test::instruction_with_ip(0x1000 + i);
+      instr.instr_id = i;
+      uut.add_input(thread, instr);
+    }
+  }
+}
+}
+
+SCENARIO("A round-robin SMT core alternates fetch between its threads") {
+  GIVEN("A core with two threads, each with instructions waiting") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+      .threads(2)
+      .fetch_policy(O3_CPU::fetch_policy_type::ROUND_ROBIN)
+    };
+    uut.initialize();
+    fill_threads(uut);
+
+    WHEN("The core operates for two cycles") {
+      uut.initialize_instruction();
+      auto first_cycle = uut.IFETCH_BUFFER;
+      uut.IFETCH_BUFFER.clear();
+      uut.initialize_instruction();
+
+      THEN("Each cycle fetches from a different thread") {
+        REQUIRE_FALSE(std::empty(first_cycle));
+        REQUIRE_FALSE(std::empty(uut.IFETCH_BUFFER));
+        REQUIRE(std::all_of(std::begin(first_cycle), std::end(first_cycle), [t = first_cycle.front().thread](const auto& x) { return x.thread == t; }));
+        REQUIRE(std::all_of(std::begin(uut.IFETCH_BUFFER), std::end(uut.IFETCH_BUFFER), [t = first_cycle.front().thread](const auto& x) { return x.thread != t; }));
+      }
+
+      THEN("Instruction ids increase across the threads") {
+        REQUIRE(first_cycle.back().instr_id < uut.IFETCH_BUFFER.front().instr_id);
+      }
+    }
+  }
+}
+
+SCENARIO("An ICOUNT SMT core fetches from the thread with the fewest instructions in flight") {
+  GIVEN("A core with two threads, one of which has many instructions in flight") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+      .threads(2)
+      .fetch_policy(O3_CPU::fetch_policy_type::ICOUNT)
+    };
+    uut.initialize();
+    fill_threads(uut);
+    uut.threads[1].icount = 100;
+
+    WHEN("The core operates") {
+      uut.initialize_instruction();
+
+      THEN("The other thread is fetched") {
+        REQUIRE_FALSE(std::empty(uut.IFETCH_BUFFER));
+        REQUIRE(std::all_of(std::begin(uut.IFETCH_BUFFER), std::end(uut.IFETCH_BUFFER), [](const auto& x) { return x.thread == 0; }));
+        REQUIRE(uut.threads[0].icount == std::size(uut.IFETCH_BUFFER));
+      }
+    }
+  }
+}
+
+SCENARIO("SMT threads have disjoint virtual address spaces") {
+  GIVEN("A core with two threads running the same instructions") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+      .threads(2)
+    };
+
+    auto instr = champsim::test::instruction_with_ip(0x1000);
+    instr.source_memory.push_back(0xdeadbeef);
+    uut.add_input(0, instr);
+    uut.add_input(1, instr);
+
+    THEN("The first thread's addresses are unchanged") {
+      REQUIRE(uut.threads[0].input_queue.front().ip == 0x1000);
+      REQUIRE(uut.threads[0].input_queue.front().source_memory.front() == 0xdeadbeef);
+    }
+
+    THEN("The second thread's addresses differ") {
+      REQUIRE(uut.threads[1].input_queue.front().thread == 1);
+      REQUIRE(uut.threads[1].input_queue.front().ip != 0x1000);
+      REQUIRE(uut.threads[1].input_queue.front().source_memory.front() != 0xdeadbeef);
+    }
+  }
+}
@@ -131,3 +131,52 @@ SCENARIO("The scheduler can detect RAW hazards") {
   }
 }
 
+SCENARIO("The scheduler tracks only the youngest producer of a register") {
+  GIVEN("A ROB with two producers of the same register and a consumer") {
+    constexpr unsigned schedule_width = 128;
+    constexpr unsigned schedule_latency = 1;
+
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .schedule_width(schedule_width)
+      .schedule_latency(schedule_latency)
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+
+    std::vector test_instructions( 3, champsim::test::instruction_with_registers(42) );
+    test_instructions.at(0).source_registers.clear();
+    test_instructions.at(1).source_registers.clear();
+    test_instructions.at(2).destination_registers.clear();
+
+    std::copy(std::begin(test_instructions), std::end(test_instructions), std::back_inserter(uut.ROB));
+    uint64_t id = 0;
+    for (auto &instr : uut.ROB) {
+      instr.instr_id = id++;
+      instr.event_cycle = uut.current_cycle;
+      uut.do_scheduling(instr);
+    }
+
+    THEN("The consumer depends only on the younger producer") {
+      REQUIRE(std::empty(uut.ROB.at(0).registers_instrs_depend_on_me));
+      REQUIRE(std::size(uut.ROB.at(1).registers_instrs_depend_on_me) == 1);
+      REQUIRE(uut.ROB.at(2).num_reg_dependent == 1);
+    }
+
+    WHEN("The younger producer completes before the older one") {
+      uut.do_complete_execution(uut.ROB.at(1));
+
+      auto reader = champsim::test::instruction_with_registers(42);
+      reader.destination_registers.clear();
+      reader.instr_id = id++;
+      uut.ROB.push_back(reader);
+      uut.do_scheduling(uut.ROB.back());
+
+      THEN("A later consumer does not wait on the older producer") {
+        REQUIRE(uut.ROB.at(2).num_reg_dependent == 0);
+        REQUIRE(uut.ROB.back().num_reg_dependent == 0);
+        REQUIRE(std::empty(uut.ROB.at(0).registers_instrs_depend_on_me));
+      }
+    }
+  }
+}
@@ -0,0 +1,64 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "ooo_cpu.h"
+#include "instr.h"
+
+SCENARIO("Every cycle is classified into exactly one top-down category") {
+  GIVEN("An empty core") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.begin_phase();
+
+    WHEN("The core operates with no instructions") {
+      constexpr uint64_t cycles = 10;
+      for (uint64_t i = 0; i < cycles; ++i)
+        for (auto op : std::array<champsim::operable*,3>{{&uut, &mock_L1I, &mock_L1D}})
+          op->_operate();
+
+      THEN("The cycles are frontend-bound") {
+        REQUIRE(uut.sim_stats.frontend_other_cycles == cycles);
+        REQUIRE(uut.sim_stats.retiring_cycles == 0);
+      }
+    }
+  }
+
+  GIVEN("A ROB with completed instructions and one waiting on memory") {
+    do_nothing_MRC mock_L1I, mock_L1D;
+    O3_CPU uut{O3_CPU::Builder{champsim::defaults::default_core}
+      .fetch_queues(&mock_L1I.queues)
+      .data_queues(&mock_L1D.queues)
+    };
+    uut.begin_phase();
+
+    uint64_t id = 0;
+    for (auto i = 0; i < 3; ++i) {
+      uut.ROB.push_back(champsim::test::instruction_with_ip(1));
+      uut.ROB.back().instr_id = id++;
+      uut.ROB.back().executed = COMPLETED;
+    }
+
+    uut.ROB.push_back(champsim::test::instruction_with_ip(2));
+    uut.ROB.back().instr_id = id++;
+    uut.ROB.back().scheduled = COMPLETED;
+    uut.ROB.back().executed = INFLIGHT;
+    uut.ROB.back().source_memory.push_back(0xdeadbeef);
+
+    WHEN("The core operates") {
+      constexpr uint64_t cycles = 5;
+      for (uint64_t i = 0; i < cycles; ++i)
+        uut.account_cycle(uut.retire_rob());
+      uut.end_phase(0);
+
+      THEN("The retiring and memory-stall cycles account for every cycle") {
+        auto memory = std::accumulate(std::begin(uut.sim_stats.backend_memory_cycles), std::end(uut.sim_stats.backend_memory_cycles), uint64_t{0});
+        REQUIRE(uut.sim_stats.retiring_cycles == 1);
+        REQUIRE(memory == cycles - 1);
+        REQUIRE(uut.sim_stats.backend_core_cycles == 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,67 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+#include <sstream>
+
+SCENARIO("A cache's contents can be saved and restored") {
+  GIVEN("A cache with some valid blocks") {
+    do_nothing_MRC mock_ll;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("408-uut")
+      .sets(4)
+      .ways(2)
+      .lower_level(&mock_ll.queues)
+    };
+    uut.initialize();
+
+    uut.block.at(1).valid = true;
+    uut.block.at(1).dirty = true;
+    uut.block.at(1).address = 0xdeadbeef;
+    uut.block.at(6).valid = true;
+    uut.block.at(6).prefetch = true;
+    uut.block.at(6).address = 0xcafebabe;
+    uut.prefetch_fill_cycle.at(6) = 1234;
+
+    std::stringstream checkpoint;
+    uut.save_checkpoint(checkpoint);
+
+    WHEN("The contents are restored into a cache of the same geometry") {
+      CACHE restored{CACHE::Builder{champsim::defaults::default_l2c}
+        .name("408-restored")
+        .sets(4)
+        .ways(2)
+        .lower_level(&mock_ll.queues)
+      };
+      restored.initialize();
+      restored.restore_checkpoint(checkpoint);
+
+      THEN("The blocks match") {
+        REQUIRE(std::size(restored.block) == std::size(uut.block));
+        for (std::size_t i = 0; i < std::size(uut.block); ++i) {
+          CHECK(restored.block.at(i).valid == uut.block.at(i).valid);
+          CHECK(restored.block.at(i).dirty == uut.block.at(i).dirty);
+          CHECK(restored.block.at(i).prefetch == uut.block.at(i).prefetch);
+          CHECK(restored.block.at(i).address == uut.block.at(i).address);
+          CHECK(restored.prefetch_fill_cycle.at(i) == uut.prefetch_fill_cycle.at(i));
+        }
+      }
+    }
+
+    WHEN("The contents are restored into a cache with a different geometry") {
+      CACHE restored{CACHE::Builder{champsim::defaults::default_l2c}
+        .name("408-restored")
+        .sets(8)
+        .ways(2)
+        .lower_level(&mock_ll.queues)
+      };
+      restored.initialize();
+
+      THEN("The restore fails") {
+        REQUIRE_THROWS(restored.restore_checkpoint(checkpoint));
+      }
+    }
+  }
+}
@@ -0,0 +1,69 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+SCENARIO("A cache counts the blocks filled by each core") {
+  GIVEN("An empty cache that samples its occupancy every cycle") {
+    constexpr uint64_t hit_latency = 2;
+    constexpr uint64_t fill_latency = 2;
+    do_nothing_MRC mock_ll;
+    to_wq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+      .name("409-uut")
+      .sets(1)
+      .ways(2)
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .fill_latency(fill_latency)
+    };
+    uut.occupancy_sample_period = 1;
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    THEN("No blocks are owned") {
+      REQUIRE(uut.get_blocks_owned().at(0) == 0);
+    }
+
+    WHEN("Three blocks are written") {
+      for (uint64_t address : {0xdeadbeef, 0xcafebabe, 0xfeedface}) {
+        decltype(mock_ul)::request_type test;
+        test.address = address;
+        test.cpu = 0;
+        test.type = access_type::WRITE;
+        REQUIRE(mock_ul.issue(test));
+
+        for (uint64_t i = 0; i < 2*(hit_latency+fill_latency); ++i)
+          for (auto elem : elements)
+            elem->_operate();
+      }
+
+      THEN("The core owns only as many blocks as fit in the cache") {
+        REQUIRE(uut.get_blocks_owned().at(0) == 2);
+      }
+
+      THEN("The samples follow the blocks as they are filled") {
+        REQUIRE_FALSE(std::empty(uut.sim_stats.occupancy));
+        CHECK(uut.sim_stats.occupancy.front().at(0) == 0);
+        CHECK(uut.sim_stats.occupancy.back().at(0) == 2);
+        CHECK(uut.sim_stats.occupancy_sample_period == 1);
+      }
+
+      AND_WHEN("A block is invalidated") {
+        uut.invalidate_entry(0xfeedface);
+
+        THEN("The core owns one fewer block") {
+          REQUIRE(uut.get_blocks_owned().at(0) == 1);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,141 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+#include "defaults.hpp"
+
+#include <numeric>
+
+namespace
+{
+struct timeliness_testbed {
+  release_MRC mock_ll;
+  to_rq_MRP mock_ul;
+  CACHE uut{CACHE::Builder{champsim::defaults::default_l2c}
+    .name("427-uut")
+    .sets(1)
+    .ways(1)
+    .upper_levels({&mock_ul.queues})
+    .lower_level(&mock_ll.queues)
+    .hit_latency(2)
+    .fill_latency(2)
+  };
+  uint64_t instr_id = 0;
+
+  std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+  timeliness_testbed()
+  {
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+  }
+
+  void run(int cycles)
+  {
+    for (auto i = 0; i < cycles; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+  }
+
+  void load(uint64_t address)
+  {
+    decltype(mock_ul)::request_type pkt;
+    pkt.address = address;
+    pkt.cpu = 0;
+    pkt.type = access_type::LOAD;
+    pkt.instr_id = instr_id++;
+    mock_ul.issue(pkt);
+    run(10);
+  }
+
+  void prefetch(uint64_t address)
+  {
+    uut.prefetch_line(address, true, 0);
+    run(10);
+  }
+
+  void release()
+  {
+    mock_ll.release_all();
+    run(10);
+  }
+};
+} // namespace
+
+SCENARIO("A demand miss that merges with a prefetch in flight makes the prefetch late") {
+  GIVEN("A cache with a prefetch in flight") {
+    timeliness_testbed testbed;
+    testbed.prefetch(0xdeadbeef);
+
+    WHEN("A load to the same block misses") {
+      testbed.load(0xdeadbeef);
+      testbed.release();
+
+      THEN("The prefetch is late, not timely") {
+        CHECK(testbed.uut.sim_stats.pf_late == 1);
+        CHECK(testbed.uut.sim_stats.pf_timely == 0);
+        CHECK(testbed.uut.sim_stats.pf_useful == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("A demand hit on a prefetched block makes the prefetch timely") {
+  GIVEN("A cache with a prefetched block") {
+    timeliness_testbed testbed;
+    testbed.prefetch(0xdeadbeef);
+    testbed.release();
+
+    WHEN("A load to the same block hits") {
+      testbed.load(0xdeadbeef);
+
+      THEN("The prefetch is timely, and its distance to the use is recorded") {
+        CHECK(testbed.uut.sim_stats.pf_timely == 1);
+        CHECK(testbed.uut.sim_stats.pf_late == 0);
+        CHECK(std::accumulate(std::begin(testbed.uut.sim_stats.pf_use_distance), std::end(testbed.uut.sim_stats.pf_use_distance), uint64_t{0}) == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("A demand miss on a block evicted by a prefetch is counted as pollution") {
+  GIVEN("A cache whose only block was loaded by a demand miss") {
+    timeliness_testbed testbed;
+    testbed.load(0xdeadbeef);
+    testbed.release();
+
+    WHEN("A prefetch evicts the block, and the block is loaded again") {
+      testbed.prefetch(0xcafebabe);
+      testbed.release();
+      testbed.load(0xdeadbeef);
+
+      THEN("The miss is counted as pollution") {
+        CHECK(testbed.uut.sim_stats.pf_pollution == 1);
+        CHECK(testbed.uut.sim_stats.pf_early == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A demand miss on a prefetched block that was evicted unused makes the prefetch early") {
+  GIVEN("A cache whose only block was prefetched") {
+    timeliness_testbed testbed;
+    testbed.prefetch(0xdeadbeef);
+    testbed.release();
+
+    WHEN("A load evicts the block, and the prefetched block is loaded") {
+      testbed.load(0xcafebabe);
+      testbed.release();
+      testbed.load(0xdeadbeef);
+
+      THEN("The prefetch is early") {
+        CHECK(testbed.uut.sim_stats.pf_useless == 1);
+        CHECK(testbed.uut.sim_stats.pf_early == 1);
+        CHECK(testbed.uut.sim_stats.pf_pollution == 0);
+      }
+    }
+  }
+}
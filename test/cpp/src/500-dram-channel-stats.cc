@@ -0,0 +1,82 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+
+#include "champsim_constants.h"
+#include "dram_controller.h"
+
+#include <array>
+#include <numeric>
+
+SCENARIO("The memory controller counts the use of its banks and data bus") {
+  GIVEN("An idle memory controller") {
+    to_rq_MRP mock_rq;
+    to_wq_MRP mock_wq;
+    MEMORY_CONTROLLER uut{1, 3200, 12.5, 12.5, 12.5, 7.5, {&mock_rq.queues, &mock_wq.queues}};
+
+    std::array<champsim::operable*, 3> elements{{&mock_rq, &mock_wq, &uut}};
+
+    uut.warmup = false;
+    uut.begin_phase();
+
+    WHEN("Two reads to one row and one read to another bank are sent") {
+      // The bank is selected by the bits above the block offset, the column by the bits above the bank, and the row by the bits above those
+      for (uint64_t address : {0x10000, 0x10040, 0x10200}) {
+        decltype(mock_rq)::request_type test;
+        test.address = address;
+        test.cpu = 0;
+        REQUIRE(mock_rq.issue(test));
+      }
+
+      constexpr uint64_t cycles = 1000;
+      for (uint64_t i = 0; i < cycles; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      const auto& stats = uut.channels.at(0).sim_stats;
+
+      THEN("Each bank activates its row once") {
+        CHECK(stats.bank_activations.at(0) == 1);
+        CHECK(stats.bank_activations.at(1) == 1);
+        CHECK(std::accumulate(std::begin(stats.bank_activations), std::end(stats.bank_activations), uint64_t{0}) == 2);
+      }
+
+      THEN("The data bus carries each block for the burst length") {
+        REQUIRE(mock_rq.packets.back().return_time > 0);
+        CHECK(stats.cycles == cycles);
+        CHECK(stats.dbus_cycle_busy == 3 * BLOCK_SIZE / DRAM_CHANNEL_WIDTH);
+        CHECK(stats.dbus_utilization() == Approx(0.024));
+        CHECK(stats.bandwidth_gbps() == Approx(3.0 * BLOCK_SIZE * 3200 / cycles / 1000));
+      }
+
+      THEN("Every cycle is counted in the queue occupancy") {
+        CHECK(std::accumulate(std::begin(stats.rq_occupancy), std::end(stats.rq_occupancy), uint64_t{0}) == cycles);
+        CHECK(stats.rq_occupancy.at(0) < cycles);
+        CHECK(stats.wq_occupancy.at(0) == cycles);
+      }
+
+      THEN("The channel does not leave read mode") {
+        CHECK(stats.switches_to_write == 0);
+        CHECK(stats.switches_to_read == 0);
+      }
+    }
+
+    WHEN("A write is sent") {
+      decltype(mock_wq)::request_type test;
+      test.address = 0xdeadbeef;
+      test.cpu = 0;
+      test.type = access_type::WRITE;
+      REQUIRE(mock_wq.issue(test));
+
+      for (uint64_t i = 0; i < 1000; ++i)
+        for (auto elem : elements)
+          elem->_operate();
+
+      THEN("The channel switches to write mode and back") {
+        const auto& stats = uut.channels.at(0).sim_stats;
+        CHECK(stats.switches_to_write == 1);
+        CHECK(stats.switches_to_read == 1);
+        CHECK(stats.WQ_ROW_BUFFER_MISS == 1);
+      }
+    }
+  }
+}
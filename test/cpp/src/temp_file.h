@@ -0,0 +1,41 @@
+#ifndef TEST_TEMP_FILE_H
+#define TEST_TEMP_FILE_H
+
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <system_error>
+
+namespace champsim::test {
+/**
+ * A uniquely named file in the temporary directory, which is removed when this goes out of scope.
+ * The name ends with the given suffix, since the readers choose their format by it.
+ */
+class temp_file
+{
+  std::filesystem::path path_;
+
+  static std::string unique_stem()
+  {
+    static std::atomic<unsigned> count{0};
+    static const auto nonce = std::random_device{}();
+    return "champsim-test-" + std::to_string(nonce) + "-" + std::to_string(count++);
+  }
+
+public:
+  explicit temp_file(const std::string& suffix) : path_(std::filesystem::temp_directory_path() / (unique_stem() + suffix)) {}
+  ~temp_file()
+  {
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+  }
+
+  temp_file(const temp_file&) = delete;
+  temp_file& operator=(const temp_file&) = delete;
+
+  std::string string() const { return path_.string(); }
+};
+}
+
+#endif
@@ -13,3 +13,29 @@ class VectorStringgTest(unittest.TestCase):
     def test_list_with_two(self):
         self.assertEqual(config.instantiation_file.vector_string(['a','b']), '{a, b}');
 
+
+class ModulesWithSharedStateTest(unittest.TestCase):
+
+    def test_marked_modules_are_not_listed(self):
+        cores = [{'_branch_predictor_data': [{'name': 'bimodal', 'fname': 'branch/bimodal', '_per_instance_state': True}], '_btb_data': []}]
+        caches = [{'_prefetcher_data': [], '_replacement_data': [{'name': 'lru', 'fname': 'replacement/lru', '_per_instance_state': True}]}]
+        self.assertEqual(config.instantiation_file.modules_with_shared_state(cores, caches), [])
+
+    def test_unmarked_modules_are_listed_once(self):
+        eip = {'name': 'eip', 'fname': 'prefetcher/eip', '_per_instance_state': False}
+        cores = [{'_branch_predictor_data': [{'name': 'tage', 'fname': 'branch/tage_sc_l'}]}]
+        caches = [{'_prefetcher_data': [eip]}, {'_prefetcher_data': [eip]}]
+        self.assertEqual(config.instantiation_file.modules_with_shared_state(cores, caches), ['branch/tage_sc_l', 'prefetcher/eip'])
+
+class ModulesWithoutCheckpointHooksTest(unittest.TestCase):
+
+    def test_modules_with_hooks_are_not_listed(self):
+        cores = [{'_branch_predictor_data': [{'name': 'gshare', 'fname': 'branch/gshare', '_checkpoint_hooks': True}]}]
+        caches = [{'_prefetcher_data': [], '_replacement_data': [{'name': 'lru', 'fname': 'replacement/lru', '_checkpoint_hooks': True}]}]
+        self.assertEqual(config.instantiation_file.modules_without_checkpoint_hooks(cores, caches), [])
+
+    def test_modules_without_hooks_are_listed_once(self):
+        berti = {'name': 'berti', 'fname': 'prefetcher/berti', '_checkpoint_hooks': False}
+        cores = [{'_btb_data': [{'name': 'ittage', 'fname': 'btb/ittage'}]}]
+        caches = [{'_prefetcher_data': [berti]}, {'_prefetcher_data': [berti]}]
+        self.assertEqual(config.instantiation_file.modules_without_checkpoint_hooks(cores, caches), ['btb/ittage', 'prefetcher/berti'])
@@ -450,7 +450,7 @@ class NormalizeConfigTest(unittest.TestCase):
         self.assertEqual(vmem.get('__test__'), True)
 
     def test_core_params_are_moved_to_core_array(self):
-        core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'branch_predictor', 'btb', 'DIB')
+        core_keys_to_copy = ('frequency', 'ifetch_buffer_size', 'decode_buffer_size', 'dispatch_buffer_size', 'rob_size', 'lq_size', 'sq_size', 'fetch_width', 'decode_width', 'dispatch_width', 'execute_width', 'lq_width', 'sq_width', 'retire_width', 'mispredict_penalty', 'scheduler_size', 'decode_latency', 'dispatch_latency', 'schedule_latency', 'execute_latency', 'ftq_size', 'threads', 'fetch_policy', 'branch_predictor', 'btb', 'DIB')
         for k in core_keys_to_copy:
             with self.subTest(key=k):
                 cores, caches, ptws, pmem, vmem = config.parse.normalize_config({ k: '__test__' })
@@ -641,3 +641,25 @@ class CompileAllModulesTests(unittest.TestCase):
         result_all = config.parse.parse_normalized(*self.base_config, {}, PassthroughContext(), PassthroughContext(), PassthroughContext(), FoundMoreContext(), True)
         self.assertIn('extra', result_all[1])
 
+
+class VariantTests(unittest.TestCase):
+
+    def test_variants_change_their_own_elements(self):
+        _, elements, modules_to_compile, *_ = config.parse.parse_config({'variants': [{'name': 'base'}, {'name': 'other', 'LLC': {'replacement': 'srrip'}}]})
+        llc_replacement = lambda e: next(c['replacement'] for c in e['caches'] if c['name'] == 'LLC')
+        self.assertEqual([v['name'] for v in elements['variants']], ['base', 'other'])
+        self.assertEqual(llc_replacement(elements['variants'][0]['elements']), llc_replacement(elements))
+        self.assertEqual(llc_replacement(elements['variants'][1]['elements']), 'srrip')
+        self.assertIn('replacementDsrrip', modules_to_compile)
+
+    def test_variants_must_have_names(self):
+        with self.assertRaises(ValueError):
+            config.parse.parse_config({'variants': [{'LLC': {'replacement': 'srrip'}}]})
+
+    def test_variant_names_must_be_unique(self):
+        with self.assertRaises(ValueError):
+            config.parse.parse_config({'variants': [{'name': 'a'}, {'name': 'a'}]})
+
+    def test_variants_cannot_change_constants(self):
+        with self.assertRaises(ValueError):
+            config.parse.parse_config({'variants': [{'name': 'a', 'block_size': 128}]})
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+#
+#    Copyright 2023 The ChampSim Contributors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+'''
+Run the regression traces through each regression configuration, and compare every statistic in the JSON output against the golden files.
+
+Changes that should not affect the simulation, such as optimizations of the simulator, must pass without regenerating the golden files.
+Changes that are meant to affect it should regenerate them with --update, and the difference in the golden files shows what changed.
+
+A configuration may also list equivalent options, such as operating the cores on several host threads, that must not change any statistic.
+Its runs are repeated with each of them and compared against the run without them.
+'''
+
+import argparse
+import concurrent.futures
+import json
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+regression_root = os.path.dirname(os.path.abspath(__file__))
+champsim_root = os.path.dirname(os.path.dirname(regression_root))
+sys.path.append(champsim_root)
+
+import config.util
+
+warmup_instructions = 50000
+simulation_instructions = 150000
+
+# The keys of a regression configuration that are not part of the ChampSim configuration
+harness_keys = ('base', 'environment', 'equivalent_options')
+
+def read_configs(fname):
+    '''
+    Each configuration in the file is merged over its own base configuration, if it names one, or else over the base of the file.
+    The environment variables of a configuration, which some modules read their parameters from, are set while it runs.
+    '''
+    with open(fname) as rfp:
+        spec = json.load(rfp)
+
+    def read_base(base_name):
+        with open(os.path.join(champsim_root, base_name)) as rfp:
+            return json.load(rfp)
+
+    return [config.util.chain(c, read_base(c.get('base', spec['base']))) for c in spec['configs']]
+
+def trace_sets(traces, num_cores):
+    ''' Each trace runs once on the first core, with the traces that follow it on the others '''
+    return [tuple(traces[(i+k) % len(traces)] for k in range(num_cores)) for i in range(len(traces))]
+
+def build(configs, jobs):
+    with tempfile.NamedTemporaryFile('w', suffix='.json') as wfp:
+        json.dump([{k:v for k,v in c.items() if k not in harness_keys} for c in configs], wfp)
+        wfp.flush()
+        subprocess.run([os.path.join(champsim_root, 'config.sh'), wfp.name], cwd=champsim_root, check=True)
+    subprocess.run(['make', '-j', str(jobs), 'all_execs'], cwd=champsim_root, check=True)
+
+def normalize(stats):
+    ''' The traces are named without their directory, so that the output does not depend on where the repository is '''
+    for phase in stats:
+        phase['traces'] = [os.path.basename(t) for t in phase.get('traces', [])]
+    return stats
+
+def run(executable, traces, environment, options=()):
+    with tempfile.TemporaryDirectory() as tmpdir:
+        json_name = os.path.join(tmpdir, 'stats.json')
+        result = subprocess.run([executable, '--warmup-instructions', str(warmup_instructions), '--simulation-instructions', str(simulation_instructions),
+            '--hide-heartbeat', '--json', json_name, *options, *traces], env={**os.environ, **environment}, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+        if result.returncode != 0:
+            raise RuntimeError('{} exited with {}: {}'.format(os.path.basename(executable), result.returncode, result.stderr.strip()))
+        with open(json_name) as rfp:
+            return normalize(json.load(rfp))
+
+def same(lhs, rhs):
+    ''' Numbers must match exactly, and in type, so that 1 and 1.0 differ '''
+    if type(lhs) is not type(rhs):
+        return False
+    if isinstance(lhs, float) and math.isnan(lhs):
+        return math.isnan(rhs)
+    return lhs == rhs
+
+def differences(golden, actual, path=''):
+    ''' Yield the path, the golden value, and the actual value of each statistic that differs '''
+    if isinstance(golden, dict) and isinstance(actual, dict):
+        for key in sorted(golden.keys() | actual.keys()):
+            subpath = '{}.{}'.format(path, key) if path else key
+            if key not in actual:
+                yield subpath, golden[key], '(missing)'
+            elif key not in golden:
+                yield subpath, '(missing)', actual[key]
+            else:
+                yield from differences(golden[key], actual[key], subpath)
+    elif isinstance(golden, list) and isinstance(actual, list) and len(golden) == len(actual):
+        for i, (g, a) in enumerate(zip(golden, actual)):
+            yield from differences(g, a, '{}[{}]'.format(path, i))
+    elif not same(golden, actual):
+        yield path, golden, actual
+
+def golden_name(executable_name, traces):
+    return os.path.join(regression_root, 'golden', executable_name, '+'.join(os.path.basename(t).split('.')[0] for t in traces) + '.json')
+
+def show_differences(diffs, max_differences):
+    for path, g, a in diffs[:max_differences]:
+        print('   ', path, 'expected:', json.dumps(g), 'actual:', json.dumps(a))
+    if len(diffs) > max_differences:
+        print('    ... and {} more'.format(len(diffs) - max_differences))
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compare the statistics of short regression runs against golden files')
+    parser.add_argument('--build', action='store_true',
+            help='Configure and build the regression executables first. This replaces the current configuration.')
+    parser.add_argument('--update', action='store_true',
+            help='Write the statistics of the runs as the new golden files instead of comparing against them')
+    parser.add_argument('--configs', default=os.path.join(regression_root, 'configs.json'),
+            help='The regression configurations')
+    parser.add_argument('--traces', default=os.path.join(regression_root, 'traces'),
+            help='The directory holding the regression traces')
+    parser.add_argument('--bindir', default=os.path.join(champsim_root, 'bin'),
+            help='The directory holding the regression executables')
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count(),
+            help='The number of runs to simulate at once')
+    parser.add_argument('--max-differences', type=int, default=20,
+            help='The number of differences to show for each run')
+    args = parser.parse_args()
+
+    configs = read_configs(args.configs)
+    if args.build:
+        build(configs, args.jobs)
+
+    traces = sorted(os.path.join(args.traces, t) for t in os.listdir(args.traces) if '.champsimtrace' in t)
+    runs = [(c['executable_name'], c.get('environment', {}), t, c.get('equivalent_options', [])) for c in configs for t in trace_sets(traces, c.get('num_cores', 1))]
+
+    failed = 0
+    checked = 0
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as executor:
+        futures = [executor.submit(run, os.path.join(args.bindir, name), trace, environment) for name, environment, trace, _ in runs]
+        equivalent_futures = [[executor.submit(run, os.path.join(args.bindir, name), trace, environment, opts) for opts in equivalents] for name, environment, trace, equivalents in runs]
+        for (name, _, trace, equivalents), future, eq_futures in zip(runs, futures, equivalent_futures):
+            label = '{} {}'.format(name, '+'.join(os.path.basename(t) for t in trace))
+            checked += 1 + len(equivalents)
+            try:
+                actual = future.result()
+            except Exception as e:
+                print('ERROR', label, e)
+                failed += 1 + len(equivalents)
+                continue
+
+            for opts, eq_future in zip(equivalents, eq_futures):
+                eq_label = '{} {}'.format(label, ' '.join(opts))
+                try:
+                    diffs = list(differences(actual, eq_future.result()))
+                except Exception as e:
+                    print('ERROR', eq_label, e)
+                    failed += 1
+                    continue
+
+                if diffs:
+                    print('FAILED', eq_label, '{} statistics differ from the run without these options'.format(len(diffs)))
+                    show_differences(diffs, args.max_differences)
+                    failed += 1
+                else:
+                    print('PASSED', eq_label)
+
+            fname = golden_name(name, trace)
+            if args.update:
+                os.makedirs(os.path.dirname(fname), exist_ok=True)
+                with open(fname, 'w') as wfp:
+                    json.dump(actual, wfp, indent=1, sort_keys=True)
+                    wfp.write('\n')
+                print('UPDATED', label)
+                continue
+
+            if not os.path.exists(fname):
+                print('MISSING', label, 'has no golden file', os.path.relpath(fname, champsim_root))
+                failed += 1
+                continue
+
+            with open(fname) as rfp:
+                golden = json.load(rfp)
+
+            diffs = list(differences(golden, actual))
+            if diffs:
+                print('FAILED', label, '{} statistics differ from {}'.format(len(diffs), os.path.relpath(fname, champsim_root)))
+                show_differences(diffs, args.max_differences)
+                failed += 1
+            else:
+                print('PASSED', label)
+
+    if not args.update:
+        print('{} of {} runs match their expected statistics'.format(checked - failed, checked))
+    sys.exit(1 if failed > 0 else 0)
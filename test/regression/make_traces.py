@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+#
+#    Copyright 2023 The ChampSim Contributors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+'''
+Write the small synthetic traces used by the regression tests.
+
+The traces are generated without any randomness from the host, so that running this script again writes the same files.
+They are checked in, and only need to be written again if a workload is added or changed.
+'''
+
+import argparse
+import lzma
+import os
+import struct
+
+# The layout of input_instr in inc/trace_instruction.h
+instr_format = struct.Struct('<QBB2B4B2Q4Q')
+
+REG_STACK_POINTER = 6
+REG_FLAGS = 25
+REG_INSTRUCTION_POINTER = 26
+
+def instr(ip, dst_regs=(), src_regs=(), dst_mem=(), src_mem=(), is_branch=False, taken=False):
+    pad = lambda seq, n: (list(seq) + [0]*n)[:n]
+    return instr_format.pack(ip, int(is_branch), int(taken), *pad(dst_regs, 2), *pad(src_regs, 4), *pad(dst_mem, 2), *pad(src_mem, 4))
+
+def load(ip, addr, dst, src=()):
+    return instr(ip, dst_regs=(dst,), src_regs=src, src_mem=(addr,))
+
+def store(ip, addr, src):
+    return instr(ip, src_regs=(src,), dst_mem=(addr,))
+
+def alu(ip, dst, *src):
+    return instr(ip, dst_regs=(dst,), src_regs=src)
+
+def cond_branch(ip, taken):
+    return instr(ip, dst_regs=(REG_INSTRUCTION_POINTER,), src_regs=(REG_INSTRUCTION_POINTER, REG_FLAGS), is_branch=True, taken=taken)
+
+def indirect_call(ip, target_reg):
+    return instr(ip, dst_regs=(REG_INSTRUCTION_POINTER, REG_STACK_POINTER), src_regs=(REG_INSTRUCTION_POINTER, REG_STACK_POINTER, target_reg), is_branch=True, taken=True)
+
+def ret(ip):
+    return instr(ip, dst_regs=(REG_INSTRUCTION_POINTER, REG_STACK_POINTER), src_regs=(REG_STACK_POINTER,), is_branch=True, taken=True)
+
+class lcg:
+    ''' A linear congruential generator, so that the traces do not depend on the random module of the host '''
+    def __init__(self, seed):
+        self.state = seed
+
+    def __call__(self, bound):
+        self.state = (self.state * 6364136223846793005 + 1442695040888963407) % (1 << 64)
+        return (self.state >> 33) % bound
+
+def stream():
+    ''' c[i] = a[i] + b[i] over arrays larger than the last-level cache, which the prefetchers should cover '''
+    a, b, c = 0x10000000, 0x20000000, 0x30000000
+    length = 1 << 20
+    i = 0
+    while True:
+        for x in (load(0x400000, a + 8*i, 1), load(0x400004, b + 8*i, 2), alu(0x400008, 3, 1, 2), store(0x40000c, c + 8*i, 3),
+                  alu(0x400010, 4, 4), cond_branch(0x400014, (i+1) % length != 0)):
+            yield x
+        i = (i+1) % length
+
+def chase():
+    ''' A chain of dependent loads to scattered lines of a footprint larger than the last-level cache '''
+    base = 0x40000000
+    lines = 1 << 18
+    gen = lcg(1)
+    while True:
+        for x in (load(0x500000, base + 64*gen(lines), 1, (1,)), alu(0x500004, 2, 1), alu(0x500008, 3, 2, 3), cond_branch(0x50000c, True)):
+            yield x
+
+def mixed():
+    '''
+    Reuse a working set that fits in the last-level cache between scans of a larger region, which separates the replacement policies.
+    Each reuse calls one of many functions, whose code is larger than the first-level instruction cache.
+    '''
+    hot, scan = 0x60000000, 0x80000000
+    hot_lines, scan_lines = 1 << 15, 1 << 18
+    functions, function_size = 1024, 64
+    gen = lcg(2)
+    scan_pos = 0
+    n = 0
+    while True:
+        if n % 8 == 7:
+            for k in range(16):
+                yield load(0x600000, scan + 64*scan_pos, 4)
+                yield cond_branch(0x600004, k != 15)
+                scan_pos = (scan_pos + 1) % scan_lines
+        else:
+            func = 0x700000 + function_size * gen(functions)
+            yield alu(0x6fffec, 5, 5)
+            yield indirect_call(0x6ffff0, 5)
+            yield load(func, hot + 64*gen(hot_lines), 1)
+            yield load(func + 4, hot + 64*gen(hot_lines), 2)
+            yield alu(func + 8, 3, 1, 2)
+            yield store(func + 12, hot + 64*gen(hot_lines), 3)
+            yield ret(func + 16)
+        n += 1
+
+workloads = {'stream': stream, 'chase': chase, 'mixed': mixed}
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Write the synthetic traces of the regression tests')
+    parser.add_argument('--output', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), 'traces'),
+            help='The directory to write the traces to')
+    parser.add_argument('--instructions', type=int, default=250000,
+            help='The number of instructions in each trace')
+    args = parser.parse_args()
+
+    os.makedirs(args.output, exist_ok=True)
+    for name, workload in workloads.items():
+        fname = os.path.join(args.output, name + '.champsimtrace.xz')
+        with lzma.open(fname, 'wb', preset=9) as wfp:
+            for _, x in zip(range(args.instructions), workload()):
+                wfp.write(x)
+        print('Wrote', fname)
@@ -0,0 +1,68 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "results_report.h"
+#include <CLI/CLI.hpp>
+#include <fmt/core.h>
+
+int main(int argc, char** argv)
+{
+  CLI::App app{"Summarize the JSON output of many ChampSim runs as CSV"};
+
+  std::vector<std::string> dir_names;
+  std::string baseline;
+  std::string output_name;
+  std::string categories_name;
+  unsigned jobs = std::max(std::thread::hardware_concurrency(), 1u);
+
+  app.add_option("-b,--baseline", baseline, "The configuration that the speedups are measured against. By default, the first directory");
+  app.add_option("-o,--output", output_name, "The file to receive one row for each run. If no name is specified, stdout will be used");
+  app.add_option("--categories", categories_name, "The file to receive the geometric means of each category of traces in each configuration");
+  app.add_option("-j,--jobs", jobs, "The number of threads that read the files")->check(CLI::PositiveNumber);
+  app.add_option("dirs", dir_names, "The directories of each configuration, searched for JSON files")->required()->check(CLI::ExistingDirectory);
+
+  CLI11_PARSE(app, argc, argv);
+
+  std::vector<std::filesystem::path> dirs{std::begin(dir_names), std::end(dir_names)};
+  auto runs = champsim::report::read_runs(dirs, jobs);
+  if (std::empty(runs)) {
+    fmt::print(stderr, "No runs were found\n");
+    return 1;
+  }
+
+  if (std::empty(baseline))
+    baseline = runs.front().config;
+
+  if (std::empty(output_name)) {
+    champsim::report::write_runs_csv(std::cout, runs, baseline);
+  } else {
+    std::ofstream output{output_name};
+    champsim::report::write_runs_csv(output, runs, baseline);
+  }
+
+  if (!std::empty(categories_name)) {
+    std::ofstream categories{categories_name};
+    champsim::report::write_categories_csv(categories, runs, baseline);
+  }
+
+  return 0;
+}
@@ -0,0 +1,44 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../../inc/decoded_trace.h"
+#include "../../inc/tracereader.h"
+
+int main(int argc, char** argv)
+{
+  bool cloudsuite = (argc == 4 && std::strcmp(argv[1], "--cloudsuite") == 0);
+  if (argc != 3 && !cloudsuite) {
+    std::cerr << "Usage: " << argv[0] << " [--cloudsuite] INPUT_TRACE OUTPUT_TRACE.decoded\n";
+    return 1;
+  }
+
+  std::string input_name{argv[argc - 2]};
+  std::ofstream output{argv[argc - 1], std::ios::binary};
+
+  auto reader = get_tracereader(input_name, 0, cloudsuite, false);
+  champsim::decoded_trace_writer writer{output, cloudsuite};
+  while (!reader.eof())
+    writer.write(reader());
+  writer.close();
+
+  std::cout << "Wrote " << reader.position() << " instructions\n";
+  return 0;
+}
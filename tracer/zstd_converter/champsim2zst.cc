@@ -0,0 +1,68 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../../inc/inf_stream.h"
+#include "../../inc/seekable_zstd.h"
+
+namespace
+{
+template <typename Stream>
+void recompress(Stream&& in, std::ostream& out, std::size_t frame_size, int level)
+{
+  champsim::seekable_zstd_writer writer{out, frame_size, level};
+  std::array<char, 1 << 16> buffer;
+  do {
+    in.read(std::data(buffer), std::size(buffer));
+    writer.write(std::data(buffer), static_cast<std::size_t>(in.gcount()));
+  } while (!in.eof());
+  writer.close();
+}
+
+bool ends_with(const std::string& s, const std::string& suffix)
+{
+  return std::size(s) >= std::size(suffix) && s.compare(std::size(s) - std::size(suffix), std::size(suffix), suffix) == 0;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 3 || argc > 5) {
+    std::cerr << "Usage: " << argv[0] << " INPUT_TRACE OUTPUT_TRACE.zst [FRAME_SIZE [LEVEL]]\n";
+    return 1;
+  }
+
+  std::string input_name{argv[1]};
+  std::ofstream output{argv[2], std::ios::binary};
+  std::size_t frame_size = (argc > 3) ? std::strtoull(argv[3], nullptr, 0) : champsim::seekable_zstd_writer::default_frame_size;
+  int level = (argc > 4) ? std::atoi(argv[4]) : 9;
+
+  if (ends_with(input_name, ".xz"))
+    recompress(champsim::inf_istream<champsim::decomp_tags::lzma_tag_t<>>{input_name}, output, frame_size, level);
+  else if (ends_with(input_name, ".gz"))
+    recompress(champsim::inf_istream<champsim::decomp_tags::gzip_tag_t<>>{input_name}, output, frame_size, level);
+  else if (ends_with(input_name, ".bz2"))
+    recompress(champsim::inf_istream<champsim::decomp_tags::bzip2_tag_t>{input_name}, output, frame_size, level);
+  else
+    recompress(std::ifstream{input_name, std::ios::binary}, output, frame_size, level);
+
+  return 0;
+}